@@ -9,6 +9,9 @@
 #include <Arduino.h>
 #endif
 #include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <new>
 #ifndef ARDUINO
 #include <string>
 #endif
@@ -44,18 +47,274 @@
 #include "ir_Vestel.h"
 #include "ir_Whirlpool.h"
 
+#if IRAC_CACHE_SLOTS
+/// Make the A/C object `NAME` render its messages into the cache slot being
+/// filled, if there is one, rather than sending them. Otherwise, go back to
+/// sending them. e.g. A pooled object that rendered last time.
+#define IRAC_RENDER(NAME) NAME.renderTo(_render_to)
+#else  // IRAC_CACHE_SLOTS
+#define IRAC_RENDER(NAME) (void)NAME
+#endif  // IRAC_CACHE_SLOTS
+
+#if IRAC_POOL_SLOTS
+/// Delete an A/C object of a given class. For `ac_pool_slot_t.destroy`.
+/// @param[in] ac A Ptr to the object.
+template <typename AC>
+static void deleteAc(void *ac) { delete static_cast<AC *>(ac); }
+
+/// Declare `NAME` as a `TYPE` A/C object for `send`'s protocol & model, to use
+/// in `IRac::sendAc()`. It is the pool's object, reset to its default state,
+/// or a new one made with the remaining arguments & added to the pool.
+/// @note Makes the calling function return false if it's out of memory.
+#define IRAC_OBJECT(TYPE, NAME, ...) \
+  TYPE *NAME##_ptr = static_cast<TYPE *>(_poolGet(send.protocol, \
+                                                  send.model)); \
+  if (NAME##_ptr != NULL) { \
+    NAME##_ptr->stateReset(); \
+  } else { \
+    NAME##_ptr = new (std::nothrow) TYPE(__VA_ARGS__); \
+    if (!_poolAdd(send.protocol, send.model, NAME##_ptr, deleteAc<TYPE>)) \
+      return false; \
+  } \
+  TYPE &NAME = *NAME##_ptr; \
+  IRAC_RENDER(NAME)
+#else  // IRAC_POOL_SLOTS
+/// Declare `NAME` as a new `TYPE` A/C object made with the remaining
+/// arguments, to use in `IRac::sendAc()`.
+#define IRAC_OBJECT(TYPE, NAME, ...) TYPE NAME(__VA_ARGS__); IRAC_RENDER(NAME)
+#endif  // IRAC_POOL_SLOTS
+
 /// Class constructor
 /// @param[in] pin Gpio pin to use when transmitting IR messages.
 /// @param[in] inverted true, gpio output defaults to high. false, to low.
 /// @param[in] use_modulation true means use frequency modulation. false, don't.
-IRac::IRac(const uint16_t pin, const bool inverted, const bool use_modulation) {
+IRac::IRac(const uint16_t pin, const bool inverted, const bool use_modulation)
+#if IRAC_CACHE_SLOTS
+    : _irsend(pin, inverted, use_modulation)
+#endif  // IRAC_CACHE_SLOTS
+{
   _pin = pin;
   _inverted = inverted;
   _modulation = use_modulation;
   initState(&next);
   this->markAsSent();
+  _window = kIRacCoalesceWindowMs;
+  _pending = false;
+  _merged = 0;
+#if IRAC_POOL_SLOTS
+  for (uint8_t i = 0; i < IRAC_POOL_SLOTS; i++) _pool[i].ac = NULL;
+  clearPool();
+#endif  // IRAC_POOL_SLOTS
+#if IRAC_CACHE_SLOTS
+  _cache_buffer = NULL;  // Only allocated if the cache is used.
+  _use_cache = true;
+  _cache_bypass = false;
+  _render_to = NULL;
+  clearCache();
+#endif  // IRAC_CACHE_SLOTS
+}
+
+#if (IRAC_POOL_SLOTS || IRAC_CACHE_SLOTS)
+/// Class destructor
+IRac::~IRac(void) {
+#if IRAC_POOL_SLOTS
+  clearPool();
+#endif  // IRAC_POOL_SLOTS
+#if IRAC_CACHE_SLOTS
+  delete[] _cache_buffer;
+#endif  // IRAC_CACHE_SLOTS
+}
+#endif  // (IRAC_POOL_SLOTS || IRAC_CACHE_SLOTS)
+
+#if IRAC_POOL_SLOTS
+
+/// Delete all the A/C objects kept for reuse. They are made again as needed.
+void IRac::clearPool(void) {
+  for (uint8_t i = 0; i < IRAC_POOL_SLOTS; i++) {
+    if (_pool[i].ac != NULL) _pool[i].destroy(_pool[i].ac);
+    _pool[i].protocol = decode_type_t::UNKNOWN;
+    _pool[i].ac = NULL;
+  }
+  _pool_used = 0;
+}
+
+/// Find the A/C object kept for reuse for a protocol & model.
+/// @param[in] protocol The protocol of the object.
+/// @param[in] model The model of the object.
+/// @return A Ptr to the object, or NULL if there isn't one.
+void *IRac::_poolGet(const decode_type_t protocol, const int16_t model) {
+  for (uint8_t i = 0; i < IRAC_POOL_SLOTS; i++)
+    if (_pool[i].ac != NULL && _pool[i].protocol == protocol &&
+        _pool[i].model == model) {
+      _pool[i].used = ++_pool_used;
+      return _pool[i].ac;
+    }
+  return NULL;
+}
+
+/// Keep an A/C object for reuse, replacing the least recently used one if
+/// the pool is full.
+/// @param[in] protocol The protocol of the object.
+/// @param[in] model The model of the object.
+/// @param[in] ac A Ptr to the object. It is owned by the pool after this.
+/// @param[in] destroy How to delete the object.
+/// @return true if successful, false if `ac` is NULL. i.e. Out of memory.
+bool IRac::_poolAdd(const decode_type_t protocol, const int16_t model,
+                    void *ac, void (*destroy)(void *ac)) {
+  if (ac == NULL) return false;
+  uint8_t slot = 0;
+  for (uint8_t i = 0; i < IRAC_POOL_SLOTS; i++) {
+    if (_pool[i].ac == NULL) {  // A free slot.
+      slot = i;
+      break;
+    }
+    if (_pool[i].used < _pool[slot].used) slot = i;
+  }
+  if (_pool[slot].ac != NULL) _pool[slot].destroy(_pool[slot].ac);
+  _pool[slot].protocol = protocol;
+  _pool[slot].model = model;
+  _pool[slot].ac = ac;
+  _pool[slot].destroy = destroy;
+  _pool[slot].used = ++_pool_used;
+  return true;
+}
+#endif  // IRAC_POOL_SLOTS
+
+#if IRAC_CACHE_SLOTS
+/// Does `sendAc()` use the previous state for a protocol, other than via
+/// `handleToggles()`?
+/// @param[in] protocol The protocol to check.
+/// @return true if it does, false if not.
+static bool usesPrevState(const decode_type_t protocol) {
+  switch (protocol) {
+    case decode_type_t::HITACHI_AC1:
+    case decode_type_t::SAMSUNG_AC:
+    case decode_type_t::SHARP_AC:
+      return true;
+    default:
+      return false;
+  }
 }
 
+/// Set if `sendAc()` uses the cache of rendered messages. On by default.
+/// @param[in] enable true to use it, false to not.
+void IRac::setCache(const bool enable) { _use_cache = enable; }
+
+/// Get if `sendAc()` uses the cache of rendered messages.
+/// @return true if it does, false if not.
+bool IRac::getCache(void) { return _use_cache; }
+
+/// Forget all the cached messages, & reset the statistics.
+void IRac::clearCache(void) {
+  for (uint8_t i = 0; i < IRAC_CACHE_SLOTS; i++) _cache[i].used = 0;
+  _cache_used = 0;
+  _cache_hits = 0;
+  _cache_misses = 0;
+}
+
+/// Get the nr. of messages sent from the cache.
+/// @return The nr. of cache hits since it was last cleared.
+uint32_t IRac::getCacheHits(void) { return _cache_hits; }
+
+/// Get the nr. of messages that weren't in the cache. i.e. Had to be made.
+/// @return The nr. of cache misses since it was last cleared.
+uint32_t IRac::getCacheMisses(void) { return _cache_misses; }
+
+/// Find the cached message for an A/C state.
+/// @param[in] send The state to send. i.e. After `handleToggles()`.
+/// @param[in] prev A Ptr to the previous state. NULL if there isn't one.
+/// @return A Ptr to the cache slot, or NULL if it isn't cached.
+ac_cache_slot_t *IRac::_cacheGet(const stdAc::packed_state_t send,
+                                 const stdAc::state_t *prev) {
+  const bool has_prev = (prev != NULL) &&
+      usesPrevState((decode_type_t)(send.protocol - 1));
+  stdAc::packed_state_t packed_prev;
+  packed_prev.raw = 0;
+  if (has_prev) packed_prev = packState(*prev);
+  for (uint8_t i = 0; i < IRAC_CACHE_SLOTS; i++) {
+    ac_cache_slot_t *slot = &_cache[i];
+    if (!slot->used || slot->state.raw != send.raw ||
+        slot->has_prev != has_prev ||
+        (has_prev && cmpStates(slot->prev, packed_prev)))
+      continue;
+    slot->used = ++_cache_used;
+    return slot;
+  }
+  return NULL;
+}
+
+/// Get a cache slot for an A/C state, replacing the least recently used one
+/// if the cache is full.
+/// @param[in] send The state to send. i.e. After `handleToggles()`.
+/// @param[in] prev A Ptr to the previous state. NULL if there isn't one.
+/// @return A Ptr to the cache slot, or NULL if there is no memory for it.
+ac_cache_slot_t *IRac::_cacheAdd(const stdAc::packed_state_t send,
+                                 const stdAc::state_t *prev) {
+  if (_cache_buffer == NULL) {
+    _cache_buffer = new (std::nothrow) uint32_t[kIRacCacheBufSize *
+                                                IRAC_CACHE_SLOTS];
+    if (_cache_buffer == NULL) return NULL;
+  }
+  uint8_t index = 0;
+  for (uint8_t i = 1; i < IRAC_CACHE_SLOTS; i++)
+    if (_cache[i].used < _cache[index].used) index = i;
+  ac_cache_slot_t *slot = &_cache[index];
+  slot->state = send;
+  slot->has_prev = (prev != NULL) &&
+      usesPrevState((decode_type_t)(send.protocol - 1));
+  if (slot->has_prev) slot->prev = packState(*prev);
+  slot->message.buffer16 = NULL;
+  slot->message.buffer32 = _cache_buffer + index * kIRacCacheBufSize;
+  slot->message.size = kIRacCacheBufSize;
+  slot->message.length = 0;
+  slot->message.overflow = false;
+  slot->used = ++_cache_used;
+  return slot;
+}
+
+/// Send an A/C message from the cache, rendering it into the cache first if
+/// it isn't already there.
+/// @param[in] desired The state_t structure describing the desired new state.
+/// @param[in] prev A Ptr to the previous state. NULL if there isn't one.
+/// @param[in] send The state to send. i.e. `desired` after `handleToggles()`.
+/// @return True, if accepted/converted/attempted etc. False, if unsupported.
+bool IRac::_sendCached(const stdAc::state_t desired,
+                       const stdAc::state_t *prev, const stdAc::state_t send) {
+  const stdAc::packed_state_t key = packState(send);
+  const stdAc::state_t unpacked = unpackState(key);
+  // Only states that pack exactly are cached. e.g. Not 24.3 degrees.
+  const bool cacheable = !cmpStates(unpacked, send) &&
+                         unpacked.clock == send.clock;
+  ac_cache_slot_t *slot = cacheable ? _cacheGet(key, prev) : NULL;
+  if (slot != NULL) {
+    _cache_hits++;
+  } else {
+    _cache_misses++;
+    if (cacheable) slot = _cacheAdd(key, prev);
+    _cache_bypass = true;
+    bool success;
+    if (slot == NULL) {  // Not cacheable, or out of memory. Just send it.
+      success = this->sendAc(desired, prev);
+    } else {
+      _render_to = &slot->message;
+      success = this->sendAc(desired, prev);
+      _render_to = NULL;
+      const bool fitted = !slot->message.overflow;
+      if (!success || !fitted) {  // Unsupported, or too big. Don't keep it.
+        slot->used = 0;
+        slot = NULL;
+        if (success) success = this->sendAc(desired, prev);  // Just send it.
+      }
+    }
+    _cache_bypass = false;
+    if (slot == NULL) return success;
+  }
+  _irsend.begin();
+  _irsend.sendRendered(&slot->message);
+  return true;
+}
+#endif  // IRAC_CACHE_SLOTS
+
 /// Initialse the given state with the supplied settings.
 /// @param[out] state A Ptr to where the settings will be stored.
 /// @param[in] vendor The vendor/protocol type.
@@ -2047,12 +2306,16 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
       desired.celsius ? desired.degrees : fahrenheitToCelsius(desired.degrees);
   // special `state_t` that is required to be sent based on that.
   stdAc::state_t send = this->handleToggles(this->cleanState(desired), prev);
+#if IRAC_CACHE_SLOTS
+  if (_use_cache && !_cache_bypass)
+    return this->_sendCached(desired, prev, send);
+#endif  // IRAC_CACHE_SLOTS
   // Per vendor settings & setup.
   switch (send.protocol) {
 #if SEND_AIRWELL
     case AIRWELL:
     {
-      IRAirwellAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRAirwellAc, ac, _pin, _inverted, _modulation);
       airwell(&ac, send.power, send.mode, degC, send.fanspeed);
       break;
     }
@@ -2060,7 +2323,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_AMCOR
     case AMCOR:
     {
-      IRAmcorAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRAmcorAc, ac, _pin, _inverted, _modulation);
       amcor(&ac, send.power, send.mode, degC, send.fanspeed);
       break;
     }
@@ -2068,7 +2331,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_ARGO
     case ARGO:
     {
-      IRArgoAC ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRArgoAC, ac, _pin, _inverted, _modulation);
       argo(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
            send.turbo, send.sleep);
       break;
@@ -2077,7 +2340,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_CARRIER_AC64
     case CARRIER_AC64:
     {
-      IRCarrierAc64 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRCarrierAc64, ac, _pin, _inverted, _modulation);
       carrier64(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
                 send.sleep);
       break;
@@ -2086,7 +2349,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_COOLIX
     case COOLIX:
     {
-      IRCoolixAC ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRCoolixAC, ac, _pin, _inverted, _modulation);
       coolix(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
              send.swingh, send.turbo, send.light, send.clean, send.sleep);
       break;
@@ -2095,7 +2358,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_CORONA_AC
     case CORONA_AC:
     {
-      IRCoronaAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRCoronaAc, ac, _pin, _inverted, _modulation);
       corona(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
              send.econo);
       break;
@@ -2104,7 +2367,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_DAIKIN
     case DAIKIN:
     {
-      IRDaikinESP ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRDaikinESP, ac, _pin, _inverted, _modulation);
       daikin(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
              send.swingh, send.quiet, send.turbo, send.econo, send.clean);
       break;
@@ -2113,7 +2376,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_DAIKIN128
     case DAIKIN128:
     {
-      IRDaikin128 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRDaikin128, ac, _pin, _inverted, _modulation);
       daikin128(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
                 send.quiet, send.turbo, send.light, send.econo, send.sleep,
                 send.clock);
@@ -2123,7 +2386,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_DAIKIN152
     case DAIKIN152:
     {
-      IRDaikin152 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRDaikin152, ac, _pin, _inverted, _modulation);
       daikin152(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
                 send.quiet, send.turbo, send.econo);
       break;
@@ -2132,7 +2395,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_DAIKIN160
     case DAIKIN160:
     {
-      IRDaikin160 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRDaikin160, ac, _pin, _inverted, _modulation);
       daikin160(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv);
       break;
     }
@@ -2140,7 +2403,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_DAIKIN176
     case DAIKIN176:
     {
-      IRDaikin176 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRDaikin176, ac, _pin, _inverted, _modulation);
       daikin176(&ac, send.power, send.mode, degC, send.fanspeed, send.swingh);
       break;
     }
@@ -2148,7 +2411,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_DAIKIN2
     case DAIKIN2:
     {
-      IRDaikin2 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRDaikin2, ac, _pin, _inverted, _modulation);
       daikin2(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
               send.swingh, send.quiet, send.turbo, send.light, send.econo,
               send.filter, send.clean, send.beep, send.sleep, send.clock);
@@ -2158,7 +2421,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_DAIKIN216
     case DAIKIN216:
     {
-      IRDaikin216 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRDaikin216, ac, _pin, _inverted, _modulation);
       daikin216(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
                 send.swingh, send.quiet, send.turbo);
       break;
@@ -2167,7 +2430,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_DAIKIN64
     case DAIKIN64:
     {
-      IRDaikin64 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRDaikin64, ac, _pin, _inverted, _modulation);
       daikin64(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
                send.quiet, send.turbo, send.sleep, send.clock);
       break;
@@ -2176,7 +2439,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_DELONGHI_AC
     case DELONGHI_AC:
     {
-      IRDelonghiAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRDelonghiAc, ac, _pin, _inverted, _modulation);
       delonghiac(&ac, send.power, send.mode, send.celsius, degC, send.fanspeed,
                  send.turbo, send.sleep);
       break;
@@ -2185,7 +2448,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_ELECTRA_AC
     case ELECTRA_AC:
     {
-      IRElectraAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRElectraAc, ac, _pin, _inverted, _modulation);
       electra(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
               send.swingh, send.turbo, send.light, send.clean);
       break;
@@ -2194,8 +2457,8 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_FUJITSU_AC
     case FUJITSU_AC:
     {
-      IRFujitsuAC ac(_pin, (fujitsu_ac_remote_model_t)send.model, _inverted,
-                     _modulation);
+      IRAC_OBJECT(IRFujitsuAC, ac, _pin, (fujitsu_ac_remote_model_t)send.model,
+                  _inverted, _modulation);
       fujitsu(&ac, (fujitsu_ac_remote_model_t)send.model, send.power, send.mode,
               degC, send.fanspeed, send.swingv, send.swingh, send.quiet,
               send.turbo, send.econo, send.filter, send.clean);
@@ -2205,7 +2468,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_GOODWEATHER
     case GOODWEATHER:
     {
-      IRGoodweatherAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRGoodweatherAc, ac, _pin, _inverted, _modulation);
       goodweather(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
                   send.turbo, send.light, send.sleep);
       break;
@@ -2214,8 +2477,8 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_GREE
     case GREE:
     {
-      IRGreeAC ac(_pin, (gree_ac_remote_model_t)send.model, _inverted,
-                  _modulation);
+      IRAC_OBJECT(IRGreeAC, ac, _pin, (gree_ac_remote_model_t)send.model,
+                  _inverted, _modulation);
       gree(&ac, (gree_ac_remote_model_t)send.model, send.power, send.mode,
            send.celsius, send.degrees, send.fanspeed, send.swingv, send.turbo,
            send.light, send.clean, send.sleep);
@@ -2225,7 +2488,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_HAIER_AC
     case HAIER_AC:
     {
-      IRHaierAC ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRHaierAC, ac, _pin, _inverted, _modulation);
       haier(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
             send.filter, send.sleep, send.clock);
       break;
@@ -2234,7 +2497,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_HAIER_AC_YRW02
     case HAIER_AC_YRW02:
     {
-      IRHaierACYRW02 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRHaierACYRW02, ac, _pin, _inverted, _modulation);
       haierYrwo2(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
                  send.turbo, send.filter, send.sleep);
       break;
@@ -2243,7 +2506,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_HITACHI_AC
     case HITACHI_AC:
     {
-      IRHitachiAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRHitachiAc, ac, _pin, _inverted, _modulation);
       hitachi(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
               send.swingh);
       break;
@@ -2252,7 +2515,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_HITACHI_AC1
     case HITACHI_AC1:
     {
-      IRHitachiAc1 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRHitachiAc1, ac, _pin, _inverted, _modulation);
       bool power_toggle = false;
       bool swing_toggle = false;
       if (prev != NULL) {
@@ -2269,7 +2532,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_HITACHI_AC344
     case HITACHI_AC344:
     {
-      IRHitachiAc344 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRHitachiAc344, ac, _pin, _inverted, _modulation);
       hitachi344(&ac, send.power, send.mode, degC, send.fanspeed,
                  send.swingv, send.swingh);
       break;
@@ -2278,7 +2541,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_HITACHI_AC424
     case HITACHI_AC424:
     {
-      IRHitachiAc424 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRHitachiAc424, ac, _pin, _inverted, _modulation);
       hitachi424(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv);
       break;
     }
@@ -2286,7 +2549,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_KELVINATOR
     case KELVINATOR:
     {
-      IRKelvinatorAC ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRKelvinatorAC, ac, _pin, _inverted, _modulation);
       kelvinator(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
                  send.swingh, send.quiet, send.turbo, send.light, send.filter,
                  send.clean);
@@ -2297,7 +2560,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
     case LG:
     case LG2:
     {
-      IRLgAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRLgAc, ac, _pin, _inverted, _modulation);
       lg(&ac, (lg_ac_remote_model_t)send.model, send.power, send.mode,
          send.degrees, send.fanspeed);
       break;
@@ -2306,7 +2569,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_MIDEA
     case MIDEA:
     {
-      IRMideaAC ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRMideaAC, ac, _pin, _inverted, _modulation);
       midea(&ac, send.power, send.mode, send.celsius, send.degrees,
             send.fanspeed, send.swingv, send.econo, send.sleep);
       break;
@@ -2315,7 +2578,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_MITSUBISHI_AC
     case MITSUBISHI_AC:
     {
-      IRMitsubishiAC ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRMitsubishiAC, ac, _pin, _inverted, _modulation);
       mitsubishi(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
                  send.swingh, send.quiet, send.clock);
       break;
@@ -2324,7 +2587,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_MITSUBISHI112
     case MITSUBISHI112:
     {
-      IRMitsubishi112 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRMitsubishi112, ac, _pin, _inverted, _modulation);
       mitsubishi112(&ac, send.power, send.mode, degC, send.fanspeed,
                     send.swingv, send.swingh, send.quiet);
       break;
@@ -2333,7 +2596,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_MITSUBISHI136
     case MITSUBISHI136:
     {
-      IRMitsubishi136 ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRMitsubishi136, ac, _pin, _inverted, _modulation);
       mitsubishi136(&ac, send.power, send.mode, degC, send.fanspeed,
                     send.swingv, send.quiet);
       break;
@@ -2342,7 +2605,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_MITSUBISHIHEAVY
     case MITSUBISHI_HEAVY_88:
     {
-      IRMitsubishiHeavy88Ac ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRMitsubishiHeavy88Ac, ac, _pin, _inverted, _modulation);
       mitsubishiHeavy88(&ac, send.power, send.mode, degC, send.fanspeed,
                         send.swingv, send.swingh, send.turbo, send.econo,
                         send.clean);
@@ -2350,7 +2613,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
     }
     case MITSUBISHI_HEAVY_152:
     {
-      IRMitsubishiHeavy152Ac ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRMitsubishiHeavy152Ac, ac, _pin, _inverted, _modulation);
       mitsubishiHeavy152(&ac, send.power, send.mode, degC, send.fanspeed,
                          send.swingv, send.swingh, send.quiet, send.turbo,
                          send.econo, send.filter, send.clean, send.sleep);
@@ -2360,7 +2623,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_SOLEUS
     case SOLEUS:
     {
-      IRSoleusAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRSoleusAc, ac, _pin, _inverted, _modulation);
       soleus(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
                send.swingh, send.turbo, send.light, send.filter, send.sleep);
       break;
@@ -2369,7 +2632,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_PANASONIC_AC
     case PANASONIC_AC:
     {
-      IRPanasonicAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRPanasonicAc, ac, _pin, _inverted, _modulation);
       panasonic(&ac, (panasonic_ac_remote_model_t)send.model, send.power,
                 send.mode, degC, send.fanspeed, send.swingv, send.swingh,
                 send.quiet, send.turbo, send.clock);
@@ -2379,7 +2642,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_SAMSUNG_AC
     case SAMSUNG_AC:
     {
-      IRSamsungAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRSamsungAc, ac, _pin, _inverted, _modulation);
       samsung(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
               send.quiet, send.turbo, send.light, send.filter, send.clean,
               send.beep, prev->power);
@@ -2389,7 +2652,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_SANYO_AC
     case SANYO_AC:
     {
-      IRSanyoAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRSanyoAc, ac, _pin, _inverted, _modulation);
       sanyo(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
             send.beep, send.sleep);
       break;
@@ -2398,7 +2661,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_SHARP_AC
     case SHARP_AC:
     {
-      IRSharpAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRSharpAc, ac, _pin, _inverted, _modulation);
       bool prev_power = !send.power;
       if (prev != NULL) prev_power = prev->power;
       sharp(&ac, send.power, prev_power, send.mode, degC, send.fanspeed,
@@ -2409,7 +2672,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_TCL112AC
     case TCL112AC:
     {
-      IRTcl112Ac ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRTcl112Ac, ac, _pin, _inverted, _modulation);
       tcl112(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
              send.swingh, send.turbo, send.light, send.econo, send.filter);
       break;
@@ -2418,7 +2681,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_TECO
     case TECO:
     {
-      IRTecoAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRTecoAc, ac, _pin, _inverted, _modulation);
       teco(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
            send.light, send.sleep);
       break;
@@ -2427,7 +2690,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_TOSHIBA_AC
     case TOSHIBA_AC:
     {
-      IRToshibaAC ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRToshibaAC, ac, _pin, _inverted, _modulation);
       toshiba(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
               send.turbo, send.econo);
       break;
@@ -2436,7 +2699,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_TROTEC
     case TROTEC:
     {
-      IRTrotecESP ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRTrotecESP, ac, _pin, _inverted, _modulation);
       trotec(&ac, send.power, send.mode, degC, send.fanspeed, send.sleep);
       break;
     }
@@ -2444,7 +2707,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_VESTEL_AC
     case VESTEL_AC:
     {
-      IRVestelAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRVestelAc, ac, _pin, _inverted, _modulation);
       vestel(&ac, send.power, send.mode, degC, send.fanspeed, send.swingv,
              send.turbo, send.filter, send.sleep, send.clock);
       break;
@@ -2453,7 +2716,7 @@ bool IRac::sendAc(const stdAc::state_t desired, const stdAc::state_t *prev) {
 #if SEND_WHIRLPOOL_AC
     case WHIRLPOOL_AC:
     {
-      IRWhirlpoolAc ac(_pin, _inverted, _modulation);
+      IRAC_OBJECT(IRWhirlpoolAc, ac, _pin, _inverted, _modulation);
       whirlpool(&ac, (whirlpool_ac_remote_model_t)send.model, send.power,
                 send.mode, degC, send.fanspeed, send.swingv, send.turbo,
                 send.light, send.sleep, send.clock);
@@ -2493,11 +2756,149 @@ bool IRac::cmpStates(const stdAc::state_t a, const stdAc::state_t b) {
       a.clean != b.clean || a.beep != b.beep || a.sleep != b.sleep;
 }
 
+/// Compare two bit-packed AirCon states.
+/// @note The comparison excludes the clock.
+/// @param a A packed_state_t to be compared.
+/// @param b A packed_state_t to be compared.
+/// @return True if they differ, False if they don't.
+bool IRac::cmpStates(stdAc::packed_state_t a, stdAc::packed_state_t b) {
+  a.clock = 0;
+  b.clock = 0;
+  return a.raw != b.raw;
+}
+
+/// Limit a value to a given range, after adding an offset to it.
+/// @param[in] value The value to limit.
+/// @param[in] offset What to add to it first.
+/// @param[in] max The largest value allowed.
+/// @return The value + offset, limited to 0 to `max`.
+static uint16_t packValue(const int32_t value, const int32_t offset,
+                          const uint16_t max) {
+  return std::min(std::max(value + offset, (int32_t)0), (int32_t)max);
+}
+
+/// Convert a state_t into its bit-packed (8 byte) form.
+/// @param[in] state The state_t to convert.
+/// @return The bit-packed form of it.
+/// @note Temperatures are rounded to the nearest half degree. Other values
+///   only change if they are out of the range of `stdAc::packed_state_t`.
+stdAc::packed_state_t IRac::packState(const stdAc::state_t state) {
+  stdAc::packed_state_t packed;
+  packed.raw = 0;
+  packed.protocol = packValue(state.protocol, 1, UINT8_MAX);
+  packed.model = packValue(state.model, 1, 0x1F);
+  packed.power = state.power;
+  packed.mode = packValue((int8_t)state.mode, 1, 7);
+  packed.degrees = packValue(std::round(state.degrees * 2), 0, UINT8_MAX);
+  packed.celsius = state.celsius;
+  packed.fanspeed = packValue((int8_t)state.fanspeed, 0, 7);
+  packed.swingv = packValue((int8_t)state.swingv, 1, 7);
+  packed.swingh = packValue((int8_t)state.swingh, 1, 7);
+  packed.quiet = state.quiet;
+  packed.turbo = state.turbo;
+  packed.econo = state.econo;
+  packed.light = state.light;
+  packed.filter = state.filter;
+  packed.clean = state.clean;
+  packed.beep = state.beep;
+  packed.sleep = packValue(state.sleep, 1, 0x7FF);
+  packed.clock = packValue(state.clock, 1, 0x7FF);
+  return packed;
+}
+
+/// Convert the bit-packed form of a state_t back into a state_t.
+/// @param[in] packed The bit-packed form. See `packState()`.
+/// @return The equivalent state_t.
+stdAc::state_t IRac::unpackState(const stdAc::packed_state_t packed) {
+  stdAc::state_t state;
+  state.protocol = (decode_type_t)(packed.protocol - 1);
+  state.model = packed.model - 1;
+  state.power = packed.power;
+  state.mode = (stdAc::opmode_t)(packed.mode - 1);
+  state.degrees = packed.degrees / 2.0;
+  state.celsius = packed.celsius;
+  state.fanspeed = (stdAc::fanspeed_t)packed.fanspeed;
+  state.swingv = (stdAc::swingv_t)(packed.swingv - 1);
+  state.swingh = (stdAc::swingh_t)(packed.swingh - 1);
+  state.quiet = packed.quiet;
+  state.turbo = packed.turbo;
+  state.econo = packed.econo;
+  state.light = packed.light;
+  state.filter = packed.filter;
+  state.clean = packed.clean;
+  state.beep = packed.beep;
+  state.sleep = packed.sleep - 1;
+  state.clock = packed.clock - 1;
+  return state;
+}
+
+/// Calculate a hash of a bit-packed AirCon state. e.g. For a hash table.
+/// @param[in] packed The bit-packed state.
+/// @return A 32-bit hash of it.
+uint32_t IRac::hashState(const stdAc::packed_state_t packed) {
+  return (uint32_t)packed.raw ^ (uint32_t)(packed.raw >> 32);
+}
+
 /// Check if the internal state has changed from what was previously sent.
 /// @note The comparison excludes the clock.
 /// @return True if it has changed, False if not.
 bool IRac::hasStateChanged(void) { return cmpStates(next, _prev); }
 
+/// Set how long `updateAc()` waits for more updates, before sending one.
+/// @param[in] msecs The time in milliseconds. 0 means don't wait.
+void IRac::setCoalesceWindow(const uint16_t msecs) { _window = msecs; }
+
+/// Get how long `updateAc()` waits for more updates, before sending one.
+/// @return The time in milliseconds.
+uint16_t IRac::getCoalesceWindow(void) { return _window; }
+
+/// Update the state we want the device to be in, without sending it yet.
+/// Updates that arrive close together (e.g. from dragging a temperature
+/// slider) are merged, & only the last one is sent. It is sent by `pollAc()`
+/// once no more have arrived for the coalesce window, or once it has been
+/// held for `kIRacCoalesceMaxWindows` windows, whichever is first.
+/// @param[in] desired The state_t structure describing the desired state.
+/// @note Toggles are based on the last state actually sent, so settings that
+///   are toggled & toggled back within the window aren't sent at all.
+void IRac::updateAc(const stdAc::state_t desired) {
+  if (_pending)
+    _merged++;  // The one waiting to be sent is replaced by this one.
+  else
+    _held.reset();
+  next = desired;
+  _pending = true;
+  _quiet.reset();
+  if (!_window) flushAc();
+}
+
+/// Send the update from `updateAc()`, if it is time to. Call it often, e.g.
+/// from `loop()`.
+/// @return true if a message was sent, false if not.
+bool IRac::pollAc(void) {
+  if (!_pending) return false;
+  if (_quiet.elapsed() < _window &&
+      _held.elapsed() < (uint32_t)_window * kIRacCoalesceMaxWindows)
+    return false;  // Wait for more updates.
+  return flushAc();
+}
+
+/// Send the update from `updateAc()` now, if it changes anything.
+/// @return true if a message was sent, false if not.
+bool IRac::flushAc(void) {
+  if (!_pending) return false;
+  _pending = false;
+  if (!hasStateChanged()) {  // Nothing to do. e.g. It was changed back.
+    _merged++;
+    return false;
+  }
+  return sendAc();
+}
+
+/// Get the nr. of updates from `updateAc()` that weren't sent, because they
+/// were replaced by a later one, or didn't change anything.
+/// @return The nr. of updates merged.
+uint32_t IRac::getMergedCount(void) { return _merged; }
+
 /// Convert the supplied str into the appropriate enum.
 /// @param[in] str A Ptr to a C-style string to be converted.
 /// @param[in] def The enum to return if no conversion was possible.
@@ -2815,715 +3216,366 @@ String IRac::swinghToString(const stdAc::swingh_t swingh) {
   }
 }
 
-namespace IRAcUtils {
-  /// Display the human readable state of an A/C message if we can.
-  /// @param[in] result A Ptr to the captured `decode_results` that contains an
-  ///   A/C mesg.
-  /// @return A string with the human description of the A/C message.
-  ///   An empty string if we can't.
-  String resultAcToString(const decode_results * const result) {
-    switch (result->decode_type) {
-#if DECODE_AIRWELL
-      case decode_type_t::AIRWELL: {
-        IRAirwellAc ac(kGpioUnused);
-        ac.setRaw(result->value);  // AIRWELL uses value instead of state.
-        return ac.toString();
-      }
-#endif  // DECODE_AIRWELL
-#if DECODE_AMCOR
-      case decode_type_t::AMCOR: {
-        IRAmcorAc ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_AMCOR
-#if DECODE_ARGO
-      case decode_type_t::ARGO: {
-        IRArgoAC ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_ARGO
-#if DECODE_CARRIER_AC64
-      case decode_type_t::CARRIER_AC64: {
-        IRCarrierAc64 ac(kGpioUnused);
-        ac.setRaw(result->value);  // CARRIER_AC64 uses value instead of state.
-        return ac.toString();
-      }
-#endif  // DECODE_CARRIER_AC64
+/// Load a captured A/C message from its `state` into an A/C object.
+/// @param[in,out] ac A Ptr to the A/C object.
+/// @param[in] decode A Ptr to a successful raw IR decode object.
+template <typename AC>
+static void acRawFromState(AC *ac, const decode_results *decode) {
+  ac->setRaw(decode->state);
+}
+
+/// Load a captured A/C message from its `value` into an A/C object.
+/// @param[in,out] ac A Ptr to the A/C object.
+/// @param[in] decode A Ptr to a successful raw IR decode object.
+template <typename AC>
+static void acRawFromValue(AC *ac, const decode_results *decode) {
+  ac->setRaw(decode->value);
+}
+
+/// Load a captured variable length A/C message from its `state` into an A/C
+/// object.
+/// @param[in,out] ac A Ptr to the A/C object.
+/// @param[in] decode A Ptr to a successful raw IR decode object.
+template <typename AC>
+static void acRawFromSized(AC *ac, const decode_results *decode) {
+  ac->setRaw(decode->state, decode->bits / 8);
+}
+
+/// Decode a captured A/C message with an A/C class, for `findAcDecoder()`.
+/// @param[in] decode A Ptr to a successful raw IR decode object.
+/// @param[out] result A Ptr to store the common state in, or NULL if not
+///   wanted.
+/// @param[in] prev Unused.
+/// @param[out] text A Ptr to store the human readable description in, or NULL
+///   if not wanted.
+/// @return true if the message was understood, false if not.
+template <typename AC, void (*LOAD)(AC *, const decode_results *)>
+static bool decodeAc(const decode_results *decode, stdAc::state_t *result,
+                     const stdAc::state_t *prev __attribute__((unused)),
+                     String *text) {
+  AC ac(kGpioUnused);
+  LOAD(&ac, decode);
+  if (result != NULL) *result = ac.toCommon();
+  if (text != NULL) *text = ac.toString();
+  return true;
+}
+
+/// Decode a captured A/C message with an A/C class that uses the previous
+/// state to complete its common state, for `findAcDecoder()`.
+/// @param[in] decode A Ptr to a successful raw IR decode object.
+/// @param[out] result A Ptr to store the common state in, or NULL if not
+///   wanted.
+/// @param[in] prev A Ptr to the previous common state, or NULL.
+/// @param[out] text A Ptr to store the human readable description in, or NULL
+///   if not wanted.
+/// @return true if the message was understood, false if not.
+template <typename AC, void (*LOAD)(AC *, const decode_results *)>
+static bool decodeAcWithPrev(const decode_results *decode,
+                             stdAc::state_t *result,
+                             const stdAc::state_t *prev, String *text) {
+  AC ac(kGpioUnused);
+  LOAD(&ac, decode);
+  if (result != NULL) *result = ac.toCommon(prev);
+  if (text != NULL) *text = ac.toString();
+  return true;
+}
+
+#if DECODE_COOLIX
+/// Decode a captured Coolix A/C message, for `findAcDecoder()`.
+/// @param[in] decode A Ptr to a successful raw IR decode object.
+/// @param[out] result A Ptr to store the common state in, or NULL.
+/// @param[in] prev A Ptr to the previous common state, or NULL.
+/// @param[out] text A Ptr to store the human readable description in, or NULL.
+/// @return true, as all Coolix messages are understood.
+static bool decodeCoolixAc(const decode_results *decode,
+                           stdAc::state_t *result,
+                           const stdAc::state_t *prev, String *text) {
+  IRCoolixAC ac(kGpioUnused);
+  if (result != NULL) {
+    ac.setRaw(decode->value);  // Uses value instead of state.
+    *result = ac.toCommon(prev);
+  }
+  if (text != NULL) {
+    ac.on();
+    ac.setRaw(decode->value);
+    *text = ac.toString();
+  }
+  return true;
+}
+#endif  // DECODE_COOLIX
+
+#if DECODE_PANASONIC_AC
+/// Decode a captured Panasonic A/C message, for `findAcDecoder()`.
+/// @param[in] decode A Ptr to a successful raw IR decode object.
+/// @param[out] result A Ptr to store the common state in, or NULL.
+/// @param[in] prev Unused.
+/// @param[out] text A Ptr to store the human readable description in, or NULL.
+/// @return true if the message was understood, false if not.
+/// @note Short (special) messages have no description.
+static bool decodePanasonicAc(const decode_results *decode,
+                              stdAc::state_t *result,
+                              const stdAc::state_t *prev
+                                  __attribute__((unused)),
+                              String *text) {
+  if (text != NULL && decode->bits <= kPanasonicAcShortBits) return false;
+  IRPanasonicAc ac(kGpioUnused);
+  ac.setRaw(decode->state);
+  if (result != NULL) *result = ac.toCommon();
+  if (text != NULL) *text = ac.toString();
+  return true;
+}
+#endif  // DECODE_PANASONIC_AC
+
+#if DECODE_LG
+/// Decode a captured LG or LG2 A/C message, for `findAcDecoder()`.
+/// @param[in] decode A Ptr to a successful raw IR decode object.
+/// @param[out] result A Ptr to store the common state in, or NULL.
+/// @param[in] prev Unused.
+/// @param[out] text A Ptr to store the human readable description in, or NULL.
+/// @return true if the message was understood, false if not.
+static bool decodeLgAc(const decode_results *decode, stdAc::state_t *result,
+                       const stdAc::state_t *prev __attribute__((unused)),
+                       String *text) {
+  IRLgAc ac(kGpioUnused);
+  ac.setRaw(decode->value);  // Like Coolix, use value instead of state.
+  if (!ac.isValidLgAc()) return false;
+  switch (decode->decode_type) {
+    case decode_type_t::LG2:
+      ac.setModel(lg_ac_remote_model_t::AKB75215403);
+      break;
+    default:
+      ac.setModel(lg_ac_remote_model_t::GE6711AR2853M);
+  }
+  if (result != NULL) *result = ac.toCommon();
+  if (text != NULL) *text = ac.toString();
+  return true;
+}
+#endif  // DECODE_LG
+
+/// A function to decode an A/C message into a common state and/or a
+/// description. See `decodeAc()` for the parameters.
+typedef bool (*ac_decode_fn_t)(const decode_results *decode,
+                               stdAc::state_t *result,
+                               const stdAc::state_t *prev, String *text);
+
+/// Find the decoder for an A/C protocol.
+/// Each A/C class has one decoder for both `IRAcUtils` functions.
+/// @param[in] protocol The protocol to look for.
+/// @return A Ptr to the decoder function, or NULL if we have none.
+static ac_decode_fn_t findAcDecoder(const decode_type_t protocol) {
+  switch (protocol) {
+#if DECODE_LG
+    case decode_type_t::LG:
+      return decodeLgAc;
+#endif  // DECODE_LG
+#if DECODE_COOLIX
+    case decode_type_t::COOLIX:
+      return decodeCoolixAc;
+#endif  // DECODE_COOLIX
 #if DECODE_DAIKIN
-      case decode_type_t::DAIKIN: {
-        IRDaikinESP ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
+    case decode_type_t::DAIKIN:
+      return decodeAc<IRDaikinESP, acRawFromState<IRDaikinESP> >;
 #endif  // DECODE_DAIKIN
-#if DECODE_DAIKIN128
-      case decode_type_t::DAIKIN128: {
-        IRDaikin128 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_DAIKIN128
-#if DECODE_DAIKIN152
-      case decode_type_t::DAIKIN152: {
-        IRDaikin152 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_DAIKIN152
-#if DECODE_DAIKIN160
-      case decode_type_t::DAIKIN160: {
-        IRDaikin160 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_DAIKIN160
-#if DECODE_DAIKIN176
-      case decode_type_t::DAIKIN176: {
-        IRDaikin176 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_DAIKIN160
-#if DECODE_DAIKIN2
-      case decode_type_t::DAIKIN2: {
-        IRDaikin2 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_DAIKIN2
-#if DECODE_DAIKIN216
-      case decode_type_t::DAIKIN216: {
-        IRDaikin216 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_DAIKIN216
-#if DECODE_DAIKIN64
-      case decode_type_t::DAIKIN64: {
-        IRDaikin64 ac(kGpioUnused);
-        ac.setRaw(result->value);  // Daikin64 uses value instead of state.
-        return ac.toString();
-      }
-#endif  // DECODE_DAIKIN64
-#if DECODE_DELONGHI_AC
-      case decode_type_t::DELONGHI_AC: {
-        IRDelonghiAc ac(kGpioUnused);
-        ac.setRaw(result->value);  // DelonghiAc uses value instead of state.
-        return ac.toString();
-      }
-#endif  // DECODE_DELONGHI_AC
-#if DECODE_ELECTRA_AC
-      case decode_type_t::ELECTRA_AC: {
-        IRElectraAc ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_ELECTRA_AC
-#if DECODE_FUJITSU_AC
-      case decode_type_t::FUJITSU_AC: {
-        IRFujitsuAC ac(kGpioUnused);
-        ac.setRaw(result->state, result->bits / 8);
-        return ac.toString();
-      }
-#endif  // DECODE_FUJITSU_AC
 #if DECODE_KELVINATOR
-      case decode_type_t::KELVINATOR: {
-        IRKelvinatorAC ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
+    case decode_type_t::KELVINATOR:
+      return decodeAc<IRKelvinatorAC, acRawFromState<IRKelvinatorAC> >;
 #endif  // DECODE_KELVINATOR
 #if DECODE_MITSUBISHI_AC
-      case decode_type_t::MITSUBISHI_AC: {
-        IRMitsubishiAC ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
+    case decode_type_t::MITSUBISHI_AC:
+      return decodeAc<IRMitsubishiAC, acRawFromState<IRMitsubishiAC> >;
 #endif  // DECODE_MITSUBISHI_AC
-#if DECODE_MITSUBISHI112
-      case decode_type_t::MITSUBISHI112: {
-        IRMitsubishi112 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_MITSUBISHI112
-#if DECODE_MITSUBISHI136
-      case decode_type_t::MITSUBISHI136: {
-        IRMitsubishi136 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_MITSUBISHI136
-#if DECODE_MITSUBISHIHEAVY
-      case decode_type_t::MITSUBISHI_HEAVY_88: {
-        IRMitsubishiHeavy88Ac ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-      case decode_type_t::MITSUBISHI_HEAVY_152: {
-        IRMitsubishiHeavy152Ac ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_MITSUBISHIHEAVY
-#if DECODE_SOLEUS
-      case decode_type_t::SOLEUS: {
-        IRSoleusAc ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_SOLEUS
-#if DECODE_TOSHIBA_AC
-      case decode_type_t::TOSHIBA_AC: {
-        IRToshibaAC ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_TOSHIBA_AC
-#if DECODE_TROTEC
-      case decode_type_t::TROTEC: {
-        IRTrotecESP ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_TROTEC
-#if DECODE_GOODWEATHER
-      case decode_type_t::GOODWEATHER: {
-        IRGoodweatherAc ac(kGpioUnused);
-        ac.setRaw(result->value);  // Goodweather uses value instead of state.
-        return ac.toString();
-      }
-#endif  // DECODE_GOODWEATHER
 #if DECODE_GREE
-      case decode_type_t::GREE: {
-        IRGreeAC ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
+    case decode_type_t::GREE:
+      return decodeAc<IRGreeAC, acRawFromState<IRGreeAC> >;
 #endif  // DECODE_GREE
+#if DECODE_ARGO
+    case decode_type_t::ARGO:
+      return decodeAc<IRArgoAC, acRawFromState<IRArgoAC> >;
+#endif  // DECODE_ARGO
+#if DECODE_TROTEC
+    case decode_type_t::TROTEC:
+      return decodeAc<IRTrotecESP, acRawFromState<IRTrotecESP> >;
+#endif  // DECODE_TROTEC
+#if DECODE_TOSHIBA_AC
+    case decode_type_t::TOSHIBA_AC:
+      return decodeAc<IRToshibaAC, acRawFromState<IRToshibaAC> >;
+#endif  // DECODE_TOSHIBA_AC
+#if DECODE_FUJITSU_AC
+    case decode_type_t::FUJITSU_AC:
+      return decodeAc<IRFujitsuAC, acRawFromSized<IRFujitsuAC> >;
+#endif  // DECODE_FUJITSU_AC
 #if DECODE_MIDEA
-      case decode_type_t::MIDEA: {
-        IRMideaAC ac(kGpioUnused);
-        ac.setRaw(result->value);  // Midea uses value instead of state.
-        return ac.toString();
-      }
+    case decode_type_t::MIDEA:
+      return decodeAcWithPrev<IRMideaAC, acRawFromValue<IRMideaAC> >;
 #endif  // DECODE_MIDEA
 #if DECODE_HAIER_AC
-      case decode_type_t::HAIER_AC: {
-        IRHaierAC ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
+    case decode_type_t::HAIER_AC:
+      return decodeAc<IRHaierAC, acRawFromState<IRHaierAC> >;
 #endif  // DECODE_HAIER_AC
+#if (DECODE_HITACHI_AC || DECODE_HITACHI_AC2)
+    case decode_type_t::HITACHI_AC:
+      return decodeAc<IRHitachiAc, acRawFromState<IRHitachiAc> >;
+#endif  // (DECODE_HITACHI_AC || DECODE_HITACHI_AC2)
+#if DECODE_HITACHI_AC1
+    case decode_type_t::HITACHI_AC1:
+      return decodeAc<IRHitachiAc1, acRawFromState<IRHitachiAc1> >;
+#endif  // DECODE_HITACHI_AC1
 #if DECODE_HAIER_AC_YRW02
-      case decode_type_t::HAIER_AC_YRW02: {
-        IRHaierACYRW02 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
+    case decode_type_t::HAIER_AC_YRW02:
+      return decodeAc<IRHaierACYRW02, acRawFromState<IRHaierACYRW02> >;
 #endif  // DECODE_HAIER_AC_YRW02
+#if DECODE_WHIRLPOOL_AC
+    case decode_type_t::WHIRLPOOL_AC:
+      return decodeAc<IRWhirlpoolAc, acRawFromState<IRWhirlpoolAc> >;
+#endif  // DECODE_WHIRLPOOL_AC
 #if DECODE_SAMSUNG_AC
-      case decode_type_t::SAMSUNG_AC: {
-        IRSamsungAc ac(kGpioUnused);
-        ac.setRaw(result->state, result->bits / 8);
-        return ac.toString();
-      }
+    // Uses the size, so extended messages are shrunk for both functions.
+    case decode_type_t::SAMSUNG_AC:
+      return decodeAc<IRSamsungAc, acRawFromSized<IRSamsungAc> >;
 #endif  // DECODE_SAMSUNG_AC
-#if DECODE_SANYO_AC
-      case decode_type_t::SANYO_AC: {
-        IRSanyoAc ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_SANYO_AC
-#if DECODE_SHARP_AC
-      case decode_type_t::SHARP_AC: {
-        IRSharpAc ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_SHARP_AC
-#if DECODE_COOLIX
-      case decode_type_t::COOLIX: {
-        IRCoolixAC ac(kGpioUnused);
-        ac.on();
-        ac.setRaw(result->value);  // Coolix uses value instead of state.
-        return ac.toString();
-      }
-#endif  // DECODE_COOLIX
-#if DECODE_CORONA_AC
-      case decode_type_t::CORONA_AC: {
-        IRCoronaAc ac(kGpioUnused);
-        ac.setRaw(result->state, result->bits / 8);
-        return ac.toString();
-      }
-#endif  // DECODE_CORONA_AC
+#if DECODE_ELECTRA_AC
+    case decode_type_t::ELECTRA_AC:
+      return decodeAc<IRElectraAc, acRawFromState<IRElectraAc> >;
+#endif  // DECODE_ELECTRA_AC
 #if DECODE_PANASONIC_AC
-      case decode_type_t::PANASONIC_AC: {
-        if (result->bits > kPanasonicAcShortBits) {
-          IRPanasonicAc ac(kGpioUnused);
-          ac.setRaw(result->state);
-          return ac.toString();
-        }
-        return "";
-      }
+    case decode_type_t::PANASONIC_AC:
+      return decodePanasonicAc;
 #endif  // DECODE_PANASONIC_AC
-#if DECODE_HITACHI_AC
-      case decode_type_t::HITACHI_AC: {
-        IRHitachiAc ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_HITACHI_AC
-#if DECODE_HITACHI_AC1
-      case decode_type_t::HITACHI_AC1: {
-        IRHitachiAc1 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_HITACHI_AC1
-#if DECODE_HITACHI_AC344
-      case decode_type_t::HITACHI_AC344: {
-        IRHitachiAc344 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_HITACHI_AC344
-#if DECODE_HITACHI_AC424
-      case decode_type_t::HITACHI_AC424: {
-        IRHitachiAc424 ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_HITACHI_AC424
-#if DECODE_WHIRLPOOL_AC
-      case decode_type_t::WHIRLPOOL_AC: {
-        IRWhirlpoolAc ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
-#endif  // DECODE_WHIRLPOOL_AC
+#if DECODE_LG
+    case decode_type_t::LG2:
+      return decodeLgAc;
+#endif  // DECODE_LG
+#if DECODE_DAIKIN2
+    case decode_type_t::DAIKIN2:
+      return decodeAc<IRDaikin2, acRawFromState<IRDaikin2> >;
+#endif  // DECODE_DAIKIN2
 #if DECODE_VESTEL_AC
-      case decode_type_t::VESTEL_AC: {
-        IRVestelAc ac(kGpioUnused);
-        ac.setRaw(result->value);  // Like Coolix, use value instead of state.
-        return ac.toString();
-      }
+    case decode_type_t::VESTEL_AC:
+      return decodeAc<IRVestelAc, acRawFromValue<IRVestelAc> >;
 #endif  // DECODE_VESTEL_AC
 #if DECODE_TECO
-      case decode_type_t::TECO: {
-        IRTecoAc ac(kGpioUnused);
-        ac.setRaw(result->value);  // Like Coolix, use value instead of state.
-        return ac.toString();
-      }
+    case decode_type_t::TECO:
+      return decodeAc<IRTecoAc, acRawFromValue<IRTecoAc> >;
 #endif  // DECODE_TECO
 #if DECODE_TCL112AC
-      case decode_type_t::TCL112AC: {
-        IRTcl112Ac ac(kGpioUnused);
-        ac.setRaw(result->state);
-        return ac.toString();
-      }
+    case decode_type_t::TCL112AC:
+      return decodeAc<IRTcl112Ac, acRawFromState<IRTcl112Ac> >;
 #endif  // DECODE_TCL112AC
-#if DECODE_LG
-      case decode_type_t::LG:
-      case decode_type_t::LG2: {
-        IRLgAc ac(kGpioUnused);
-        ac.setRaw(result->value);  // Like Coolix, use value instead of state.
-        switch (result->decode_type) {
-          case decode_type_t::LG2:
-            ac.setModel(lg_ac_remote_model_t::AKB75215403);
-            break;
-          default:
-            ac.setModel(lg_ac_remote_model_t::GE6711AR2853M);
-        }
-        return ac.isValidLgAc() ? ac.toString() : "";
-      }
-#endif  // DECODE_LG
-      default:
-        return "";
-    }
-  }
-
-  /// Convert a valid IR A/C remote message that we understand enough into a
-  /// Common A/C state.
-  /// @param[in] decode A PTR to a successful raw IR decode object.
-  /// @param[in] result A PTR to a state structure to store the result in.
-  /// @param[in] prev A PTR to a state structure which has the prev. state.
-  /// @return A boolean indicating success or failure.
-  bool decodeToState(const decode_results *decode, stdAc::state_t *result,
-                     const stdAc::state_t *prev
-/// @cond IGNORE
-// *prev flagged as "unused" due to potential compiler warning when some
-// protocols that use it are disabled. It really is used.
-                                                __attribute__((unused))
-/// @endcond
-                    ) {
-    if (decode == NULL || result == NULL) return false;  // Safety check.
-    switch (decode->decode_type) {
-#if DECODE_AIRWELL
-      case decode_type_t::AIRWELL: {
-        IRAirwellAc ac(kGpioUnused);
-        ac.setRaw(decode->value);  // Uses value instead of state.
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_AIRWELL
-#if DECODE_AMCOR
-      case decode_type_t::AMCOR: {
-        IRAmcorAc ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_AMCOR
-#if DECODE_ARGO
-      case decode_type_t::ARGO: {
-        IRArgoAC ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_ARGO
-#if DECODE_COOLIX
-      case decode_type_t::COOLIX: {
-        IRCoolixAC ac(kGpioUnused);
-        ac.setRaw(decode->value);  // Uses value instead of state.
-        *result = ac.toCommon(prev);
-        break;
-      }
-#endif  // DECODE_COOLIX
-#if DECODE_CORONA_AC
-      case decode_type_t::CORONA_AC: {
-        IRCoronaAc ac(kGpioUnused);
-        ac.setRaw(decode->state, decode->bits / 8);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_CARRIER_AC64
-#if DECODE_CARRIER_AC64
-      case decode_type_t::CARRIER_AC64: {
-        IRCarrierAc64 ac(kGpioUnused);
-        ac.setRaw(decode->value);  // Uses value instead of state.
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_CARRIER_AC64
-#if DECODE_DAIKIN
-      case decode_type_t::DAIKIN: {
-        IRDaikinESP ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_DAIKIN
+#if DECODE_MITSUBISHIHEAVY
+    case decode_type_t::MITSUBISHI_HEAVY_88:
+      return decodeAc<IRMitsubishiHeavy88Ac,
+                      acRawFromState<IRMitsubishiHeavy88Ac> >;
+#endif  // DECODE_MITSUBISHIHEAVY
+#if DECODE_MITSUBISHIHEAVY
+    case decode_type_t::MITSUBISHI_HEAVY_152:
+      return decodeAc<IRMitsubishiHeavy152Ac,
+                      acRawFromState<IRMitsubishiHeavy152Ac> >;
+#endif  // DECODE_MITSUBISHIHEAVY
+#if DECODE_DAIKIN216
+    case decode_type_t::DAIKIN216:
+      return decodeAc<IRDaikin216, acRawFromState<IRDaikin216> >;
+#endif  // DECODE_DAIKIN216
+#if DECODE_SHARP_AC
+    case decode_type_t::SHARP_AC:
+      return decodeAc<IRSharpAc, acRawFromState<IRSharpAc> >;
+#endif  // DECODE_SHARP_AC
+#if DECODE_GOODWEATHER
+    case decode_type_t::GOODWEATHER:
+      return decodeAc<IRGoodweatherAc, acRawFromValue<IRGoodweatherAc> >;
+#endif  // DECODE_GOODWEATHER
+#if DECODE_DAIKIN160
+    case decode_type_t::DAIKIN160:
+      return decodeAc<IRDaikin160, acRawFromState<IRDaikin160> >;
+#endif  // DECODE_DAIKIN160
+#if DECODE_SOLEUS
+    case decode_type_t::SOLEUS:
+      return decodeAc<IRSoleusAc, acRawFromState<IRSoleusAc> >;
+#endif  // DECODE_SOLEUS
+#if DECODE_DAIKIN176
+    case decode_type_t::DAIKIN176:
+      return decodeAc<IRDaikin176, acRawFromState<IRDaikin176> >;
+#endif  // DECODE_DAIKIN176
 #if DECODE_DAIKIN128
-      case decode_type_t::DAIKIN128: {
-        IRDaikin128 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
+    case decode_type_t::DAIKIN128:
+      return decodeAc<IRDaikin128, acRawFromState<IRDaikin128> >;
 #endif  // DECODE_DAIKIN128
+#if DECODE_AMCOR
+    case decode_type_t::AMCOR:
+      return decodeAc<IRAmcorAc, acRawFromState<IRAmcorAc> >;
+#endif  // DECODE_AMCOR
 #if DECODE_DAIKIN152
-      case decode_type_t::DAIKIN152: {
-        IRDaikin152 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
+    case decode_type_t::DAIKIN152:
+      return decodeAc<IRDaikin152, acRawFromState<IRDaikin152> >;
 #endif  // DECODE_DAIKIN152
-#if DECODE_DAIKIN160
-      case decode_type_t::DAIKIN160: {
-        IRDaikin160 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_DAIKIN160
-#if DECODE_DAIKIN176
-      case decode_type_t::DAIKIN176: {
-        IRDaikin176 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_DAIKIN160
-#if DECODE_DAIKIN2
-      case decode_type_t::DAIKIN2: {
-        IRDaikin2 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_DAIKIN2
-#if DECODE_DAIKIN216
-      case decode_type_t::DAIKIN216: {
-        IRDaikin216 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_DAIKIN216
+#if DECODE_MITSUBISHI136
+    case decode_type_t::MITSUBISHI136:
+      return decodeAc<IRMitsubishi136, acRawFromState<IRMitsubishi136> >;
+#endif  // DECODE_MITSUBISHI136
+#if DECODE_MITSUBISHI112
+    case decode_type_t::MITSUBISHI112:
+      return decodeAc<IRMitsubishi112, acRawFromState<IRMitsubishi112> >;
+#endif  // DECODE_MITSUBISHI112
+#if DECODE_HITACHI_AC424
+    case decode_type_t::HITACHI_AC424:
+      return decodeAc<IRHitachiAc424, acRawFromState<IRHitachiAc424> >;
+#endif  // DECODE_HITACHI_AC424
 #if DECODE_DAIKIN64
-      case decode_type_t::DAIKIN64: {
-        IRDaikin64 ac(kGpioUnused);
-        ac.setRaw(decode->value);  // Uses value instead of state.
-        *result = ac.toCommon(prev);
-        break;
-      }
+    case decode_type_t::DAIKIN64:
+      return decodeAcWithPrev<IRDaikin64, acRawFromValue<IRDaikin64> >;
 #endif  // DECODE_DAIKIN64
+#if DECODE_AIRWELL
+    case decode_type_t::AIRWELL:
+      return decodeAc<IRAirwellAc, acRawFromValue<IRAirwellAc> >;
+#endif  // DECODE_AIRWELL
 #if DECODE_DELONGHI_AC
-      case decode_type_t::DELONGHI_AC: {
-        IRDelonghiAc ac(kGpioUnused);
-        ac.setRaw(decode->value);  // Uses value instead of state.
-        *result = ac.toCommon();
-        break;
-      }
+    case decode_type_t::DELONGHI_AC:
+      return decodeAc<IRDelonghiAc, acRawFromValue<IRDelonghiAc> >;
 #endif  // DECODE_DELONGHI_AC
-#if DECODE_ELECTRA_AC
-      case decode_type_t::ELECTRA_AC: {
-        IRElectraAc ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_ELECTRA_AC
-#if DECODE_FUJITSU_AC
-      case decode_type_t::FUJITSU_AC: {
-        IRFujitsuAC ac(kGpioUnused);
-        ac.setRaw(decode->state, decode->bits / 8);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_FUJITSU_AC
-#if DECODE_GOODWEATHER
-      case decode_type_t::GOODWEATHER: {
-        IRGoodweatherAc ac(kGpioUnused);
-        ac.setRaw(decode->value);  // Uses value instead of state.
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_GOODWEATHER
-#if DECODE_GREE
-      case decode_type_t::GREE: {
-        IRGreeAC ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_GREE
-#if DECODE_HAIER_AC
-      case decode_type_t::HAIER_AC: {
-        IRHaierAC ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_HAIER_AC
-#if DECODE_HAIER_AC_YRW02
-      case decode_type_t::HAIER_AC_YRW02: {
-        IRHaierACYRW02 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_HAIER_AC_YRW02
-#if (DECODE_HITACHI_AC || DECODE_HITACHI_AC2)
-      case decode_type_t::HITACHI_AC: {
-        IRHitachiAc ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // (DECODE_HITACHI_AC || DECODE_HITACHI_AC2)
-#if DECODE_HITACHI_AC1
-      case decode_type_t::HITACHI_AC1: {
-        IRHitachiAc1 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_HITACHI_AC1
+#if DECODE_CARRIER_AC64
+    case decode_type_t::CARRIER_AC64:
+      return decodeAc<IRCarrierAc64, acRawFromValue<IRCarrierAc64> >;
+#endif  // DECODE_CARRIER_AC64
 #if DECODE_HITACHI_AC344
-      case decode_type_t::HITACHI_AC344: {
-        IRHitachiAc344 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
+    case decode_type_t::HITACHI_AC344:
+      return decodeAc<IRHitachiAc344, acRawFromState<IRHitachiAc344> >;
 #endif  // DECODE_HITACHI_AC344
-#if DECODE_HITACHI_AC424
-      case decode_type_t::HITACHI_AC424: {
-        IRHitachiAc424 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_HITACHI_AC424
-#if DECODE_KELVINATOR
-      case decode_type_t::KELVINATOR: {
-        IRKelvinatorAC ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_KELVINATOR
-#if DECODE_LG
-      case decode_type_t::LG:
-      case decode_type_t::LG2: {
-        IRLgAc ac(kGpioUnused);
-        ac.setRaw(decode->value);  // Uses value instead of state.
-        if (!ac.isValidLgAc()) return false;
-        switch (decode->decode_type) {
-          case decode_type_t::LG2:
-            ac.setModel(lg_ac_remote_model_t::AKB75215403);
-            break;
-          default:
-            ac.setModel(lg_ac_remote_model_t::GE6711AR2853M);
-        }
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_LG
-#if DECODE_MIDEA
-      case decode_type_t::MIDEA: {
-        IRMideaAC ac(kGpioUnused);
-        ac.setRaw(decode->value);  // Uses value instead of state.
-        *result = ac.toCommon(prev);
-        break;
-      }
-#endif  // DECODE_MIDEA
-#if DECODE_MITSUBISHI_AC
-      case decode_type_t::MITSUBISHI_AC: {
-        IRMitsubishiAC ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_MITSUBISHI_AC
-#if DECODE_MITSUBISHI112
-      case decode_type_t::MITSUBISHI112: {
-        IRMitsubishi112 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_MITSUBISHI112
-#if DECODE_MITSUBISHI136
-      case decode_type_t::MITSUBISHI136: {
-        IRMitsubishi136 ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_MITSUBISHI136
-#if DECODE_MITSUBISHIHEAVY
-      case decode_type_t::MITSUBISHI_HEAVY_88: {
-        IRMitsubishiHeavy88Ac ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-      case decode_type_t::MITSUBISHI_HEAVY_152: {
-        IRMitsubishiHeavy152Ac ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_MITSUBISHIHEAVY
-#if DECODE_SOLEUS
-      case decode_type_t::SOLEUS: {
-        IRSoleusAc ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_SOLEUS
-#if DECODE_PANASONIC_AC
-      case decode_type_t::PANASONIC_AC: {
-        IRPanasonicAc ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_PANASONIC_AC
-#if DECODE_SAMSUNG_AC
-      case decode_type_t::SAMSUNG_AC: {
-        IRSamsungAc ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_SAMSUNG_AC
+#if DECODE_CORONA_AC
+    case decode_type_t::CORONA_AC:
+      return decodeAc<IRCoronaAc, acRawFromSized<IRCoronaAc> >;
+#endif  // DECODE_CORONA_AC
 #if DECODE_SANYO_AC
-      case decode_type_t::SANYO_AC: {
-        IRSanyoAc ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
+    case decode_type_t::SANYO_AC:
+      return decodeAc<IRSanyoAc, acRawFromState<IRSanyoAc> >;
 #endif  // DECODE_SANYO_AC
-#if DECODE_SHARP_AC
-      case decode_type_t::SHARP_AC: {
-        IRSharpAc ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_SHARP_AC
-#if DECODE_TCL112AC
-      case decode_type_t::TCL112AC: {
-        IRTcl112Ac ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_TCL112AC
-#if DECODE_TECO
-      case decode_type_t::TECO: {
-        IRTecoAc ac(kGpioUnused);
-        ac.setRaw(decode->value);  // Uses value instead of state.
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_TECO
-#if DECODE_TOSHIBA_AC
-      case decode_type_t::TOSHIBA_AC: {
-        IRToshibaAC ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_TOSHIBA_AC
-#if DECODE_TROTEC
-      case decode_type_t::TROTEC: {
-        IRTrotecESP ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_TROTEC
-#if DECODE_VESTEL_AC
-      case decode_type_t::VESTEL_AC: {
-        IRVestelAc ac(kGpioUnused);
-        ac.setRaw(decode->value);  // Uses value instead of state.
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_VESTEL_AC
-#if DECODE_WHIRLPOOL_AC
-      case decode_type_t::WHIRLPOOL_AC: {
-        IRWhirlpoolAc ac(kGpioUnused);
-        ac.setRaw(decode->state);
-        *result = ac.toCommon();
-        break;
-      }
-#endif  // DECODE_WHIRLPOOL_AC
-      default:
-        return false;
-    }
-    return true;
+    default:
+      return NULL;
+  }
+}
+
+namespace IRAcUtils {
+  /// Display the human readable state of an A/C message if we can.
+  /// @param[in] result A Ptr to the captured `decode_results` that contains an
+  ///   A/C mesg.
+  /// @return A string with the human description of the A/C message.
+  ///   An empty string if we can't.
+  String resultAcToString(const decode_results * const result) {
+    String text = "";
+    if (result == NULL) return text;  // Safety check.
+    const ac_decode_fn_t decoder = findAcDecoder(result->decode_type);
+    if (decoder == NULL || !decoder(result, NULL, NULL, &text)) return "";
+    return text;
+  }
+
+  /// Convert a valid IR A/C remote message that we understand enough into a
+  /// Common A/C state.
+  /// @param[in] decode A PTR to a successful raw IR decode object.
+  /// @param[in] result A PTR to a state structure to store the result in.
+  /// @param[in] prev A PTR to a state structure which has the prev. state.
+  /// @return A boolean indicating success or failure.
+  bool decodeToState(const decode_results *decode, stdAc::state_t *result,
+                     const stdAc::state_t *prev) {
+    if (decode == NULL || result == NULL) return false;  // Safety check.
+    const ac_decode_fn_t decoder = findAcDecoder(decode->decode_type);
+    return decoder != NULL && decoder(decode, result, prev, NULL);
   }
 }  // namespace IRAcUtils
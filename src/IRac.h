@@ -7,6 +7,7 @@
 #include <Arduino.h>
 #endif
 #include "IRremoteESP8266.h"
+#include "IRtimer.h"
 #include "ir_Airwell.h"
 #include "ir_Amcor.h"
 #include "ir_Argo.h"
@@ -40,6 +41,35 @@
 
 // Constants
 const int8_t kGpioUnused = -1;  ///< A placeholder for not using an actual GPIO.
+/// Default time (mSecs) `IRac::updateAc()` waits for more updates to merge.
+const uint16_t kIRacCoalesceWindowMs = 300;
+/// Max. nr. of windows an update is held for, while it keeps being replaced.
+const uint8_t kIRacCoalesceMaxWindows = 4;
+
+#if IRAC_POOL_SLOTS
+/// A protocol specific A/C object kept by `IRac` for reuse.
+typedef struct {
+  decode_type_t protocol;  ///< The protocol of the object. UNKNOWN if unused.
+  int16_t model;  ///< The model it was made for.
+  void *ac;  ///< A Ptr to the object. e.g. An `IRDaikinESP`.
+  void (*destroy)(void *ac);  ///< How to delete the object.
+  uint32_t used;  ///< When it was last used. For finding the oldest one.
+} ac_pool_slot_t;
+#endif  // IRAC_POOL_SLOTS
+
+#if IRAC_CACHE_SLOTS
+/// Max. nr. of mark & space entries in a message in the `IRac` cache.
+const uint16_t kIRacCacheBufSize = 1024;
+
+/// A rendered A/C message kept by `IRac` for sending again.
+typedef struct {
+  stdAc::packed_state_t state;  ///< What was sent. After `handleToggles()`.
+  stdAc::packed_state_t prev;  ///< The previous state, if the protocol uses it.
+  bool has_prev;  ///< Is `prev` used?
+  render_buffer_t message;  ///< The rendered message(s).
+  uint32_t used;  ///< When it was last used. 0 if the slot is free.
+} ac_cache_slot_t;
+#endif  // IRAC_CACHE_SLOTS
 
 // Class
 /// A universal/common/generic interface for controling supported A/Cs.
@@ -47,6 +77,22 @@ class IRac {
  public:
   explicit IRac(const uint16_t pin, const bool inverted = false,
                 const bool use_modulation = true);
+#if (IRAC_POOL_SLOTS || IRAC_CACHE_SLOTS)
+  ~IRac(void);
+#endif  // (IRAC_POOL_SLOTS || IRAC_CACHE_SLOTS)
+#if IRAC_POOL_SLOTS
+  // The pooled A/C objects are owned by the object, so it can't be copied.
+  IRac(const IRac &) = delete;
+  IRac &operator=(const IRac &) = delete;
+  void clearPool(void);
+#endif  // IRAC_POOL_SLOTS
+#if IRAC_CACHE_SLOTS
+  void setCache(const bool enable);
+  bool getCache(void);
+  void clearCache(void);
+  uint32_t getCacheHits(void);
+  uint32_t getCacheMisses(void);
+#endif  // IRAC_CACHE_SLOTS
   static bool isProtocolSupported(const decode_type_t protocol);
   static void initState(stdAc::state_t *state,
                         const decode_type_t vendor, const int16_t model,
@@ -72,6 +118,10 @@ class IRac {
               const bool beep, const int16_t sleep = -1,
               const int16_t clock = -1);
   static bool cmpStates(const stdAc::state_t a, const stdAc::state_t b);
+  static bool cmpStates(stdAc::packed_state_t a, stdAc::packed_state_t b);
+  static stdAc::packed_state_t packState(const stdAc::state_t state);
+  static stdAc::state_t unpackState(const stdAc::packed_state_t packed);
+  static uint32_t hashState(const stdAc::packed_state_t packed);
   static bool strToBool(const char *str, const bool def = false);
   static int16_t strToModel(const char *str, const int16_t def = -1);
   static stdAc::opmode_t strToOpmode(
@@ -91,6 +141,12 @@ class IRac {
   stdAc::state_t getState(void);
   stdAc::state_t getStatePrev(void);
   bool hasStateChanged(void);
+  void setCoalesceWindow(const uint16_t msecs);
+  uint16_t getCoalesceWindow(void);
+  void updateAc(const stdAc::state_t desired);
+  bool pollAc(void);
+  bool flushAc(void);
+  uint32_t getMergedCount(void);
   stdAc::state_t next;  ///< The state we want the device to be in after we send
 #ifndef UNIT_TEST
 
@@ -100,6 +156,39 @@ class IRac {
   bool _inverted;  ///< IR LED is lit when GPIO is LOW (true) or HIGH (false)?
   bool _modulation;  ///< Is frequency modulation to be used?
   stdAc::state_t _prev;  ///< The state we expect the device to currently be in.
+  uint16_t _window;  ///< How long (mSecs) to wait for updates to merge.
+  bool _pending;  ///< Is there an update from `updateAc()` yet to be sent?
+  TimerMs _quiet;  ///< Time since the last update.
+  TimerMs _held;  ///< Time since the first update yet to be sent.
+  uint32_t _merged;  ///< Nr. of updates merged into others, so not sent.
+#if IRAC_POOL_SLOTS
+  ac_pool_slot_t _pool[IRAC_POOL_SLOTS];  ///< The A/C objects kept for reuse.
+  uint32_t _pool_used;  ///< Nr. of times the pool has been used.
+  void *_poolGet(const decode_type_t protocol, const int16_t model);
+  bool _poolAdd(const decode_type_t protocol, const int16_t model, void *ac,
+                void (*destroy)(void *ac));
+#endif  // IRAC_POOL_SLOTS
+#if IRAC_CACHE_SLOTS
+#ifndef UNIT_TEST
+  IRsend _irsend;  ///< For sending the cached messages.
+#else
+  IRsendTest _irsend;  ///< For testing sending the cached messages.
+#endif  // UNIT_TEST
+  ac_cache_slot_t _cache[IRAC_CACHE_SLOTS];  ///< The cached messages.
+  uint32_t *_cache_buffer;  ///< All the slots' entries.
+  uint32_t _cache_used;  ///< Nr. of times the cache has been used.
+  uint32_t _cache_hits;  ///< Nr. of messages sent from the cache.
+  uint32_t _cache_misses;  ///< Nr. of messages not found in the cache.
+  bool _use_cache;  ///< Is the cache to be used?
+  bool _cache_bypass;  ///< Is `sendAc()` to skip the cache this time?
+  render_buffer_t *_render_to;  ///< Where A/C objects render to, or NULL.
+  ac_cache_slot_t *_cacheGet(const stdAc::packed_state_t send,
+                             const stdAc::state_t *prev);
+  ac_cache_slot_t *_cacheAdd(const stdAc::packed_state_t send,
+                             const stdAc::state_t *prev);
+  bool _sendCached(const stdAc::state_t desired, const stdAc::state_t *prev,
+                   const stdAc::state_t send);
+#endif  // IRAC_CACHE_SLOTS
 #if SEND_AIRWELL
   void airwell(IRAirwellAc *ac,
                const bool on, const stdAc::opmode_t mode, const float degrees,
@@ -5,6 +5,7 @@
 
 #include "IRrecv.h"
 #include <stddef.h>
+#include <string.h>
 #ifndef UNIT_TEST
 #if defined(ESP8266)
 extern "C" {
@@ -19,11 +20,19 @@ extern "C" {
 #include <cassert>
 #endif  // UNIT_TEST
 #include "IRremoteESP8266.h"
+#include "IRtimer.h"
 #include "IRutils.h"
 
 #ifdef UNIT_TEST
 #undef ICACHE_RAM_ATTR
 #define ICACHE_RAM_ATTR
+#undef USE_IRAM_ATTR
+#define USE_IRAM_ATTR
+#define memcpy_P memcpy  // The host has no separate program memory.
+#endif
+
+#ifndef PROGMEM
+#define PROGMEM  // Pretend we have the PROGMEM macro even if we really don't.
 #endif
 
 #ifndef USE_IRAM_ATTR
@@ -37,6 +46,17 @@ extern "C" {
 
 #define ONCE 0
 
+#if ENABLE_DECODE_PROFILING
+#define DPROFILE_TIMER(timer) IRtimer timer
+#define DPROFILE_ATTEMPT(timer, type, matched) \
+    _profileAttempt(type, matched, timer.elapsed())
+#define DPROFILE_CAPTURE(timer) _profileCapture(timer.elapsed())
+#else  // ENABLE_DECODE_PROFILING
+#define DPROFILE_TIMER(timer)
+#define DPROFILE_ATTEMPT(timer, type, matched)
+#define DPROFILE_CAPTURE(timer)
+#endif  // ENABLE_DECODE_PROFILING
+
 // Updated by David Conran (https://github.com/crankyoldgit) for receiving IR
 // code on ESP32
 // Updated by Sebastien Warin (http://sebastien.warin.fr) for receiving IR code
@@ -57,8 +77,23 @@ static hw_timer_t * timer = NULL;
 #if defined(ESP32)
 portMUX_TYPE irremote_mux = portMUX_INITIALIZER_UNLOCKED;
 #endif  // ESP32
-volatile irparams_t irparams;
-irparams_t *irparams_save;  // A copy of the interrupt state while decoding.
+#ifndef UNIT_TEST
+static volatile uint32_t edge_time = 0;  // When (micros()) the last edge was.
+#endif  // UNIT_TEST
+#ifdef UNIT_TEST
+// Per-thread, so host tools can capture & decode on several threads at once.
+// Each thread needs its own IRrecv, created & destroyed on that thread.
+#define IRRECV_STATE thread_local
+#else  // UNIT_TEST
+#define IRRECV_STATE
+#endif  // UNIT_TEST
+IRRECV_STATE volatile irparams_t irparams;
+// A copy of the interrupt state while decoding.
+IRRECV_STATE irparams_t *irparams_save;
+#if CAPTURE_RING_SLOTS
+// Completed captures awaiting decode.
+IRRECV_STATE volatile capture_ring_t capture_ring;
+#endif  // CAPTURE_RING_SLOTS
 
 #ifndef UNIT_TEST
 #if defined(ESP8266)
@@ -77,7 +112,11 @@ static void USE_IRAM_ATTR read_timeout(void) {
 /// @endcond
   portENTER_CRITICAL(&irremote_mux);
 #endif  // ESP32
+#if CAPTURE_RING_SLOTS
+  if (irparams.rawlen) IRrecv::_ringPublish();
+#else  // CAPTURE_RING_SLOTS
   if (irparams.rawlen) irparams.rcvstate = kStopState;
+#endif  // CAPTURE_RING_SLOTS
 #if defined(ESP8266)
   os_intr_unlock();
 #endif  // ESP8266
@@ -89,7 +128,7 @@ static void USE_IRAM_ATTR read_timeout(void) {
 /// Interrupt handler for changes on the GPIO pin handling incoming IR messages.
 static void USE_IRAM_ATTR gpio_intr() {
   uint32_t now = micros();
-  static uint32_t start = 0;
+  uint32_t start = edge_time;
 
 #if defined(ESP8266)
   uint32_t gpio_status = GPIO_REG_READ(GPIO_STATUS_ADDRESS);
@@ -109,9 +148,55 @@ static void USE_IRAM_ATTR gpio_intr() {
     irparams.overflow = true;
     irparams.rcvstate = kStopState;
   }
+#if ENABLE_COMPACT_CAPTURE
+  // Make sure there is room for the largest (3 byte) compact entry.
+  uint16_t pos = irparams.compactlen;
+  if (pos + 3 > irparams.compactsize) {
+    irparams.overflow = true;
+    irparams.rcvstate = kStopState;
+  }
+#endif  // ENABLE_COMPACT_CAPTURE
 
+#if CAPTURE_RING_SLOTS
+  // An overflowed capture is published by read_timeout() once the message
+  // ends, so keep pushing the timeout back until it does.
+  if (irparams.rcvstate == kStopState) {
+#if defined(ESP8266)
+    os_timer_arm(&timer, irparams.timeout, ONCE);
+#endif  // ESP8266
+#if defined(ESP32)
+    timerWrite(timer, 0);  // Reset the timeout.
+#endif  // ESP32
+    return;
+  }
+#else  // CAPTURE_RING_SLOTS
   if (irparams.rcvstate == kStopState) return;
+#endif  // CAPTURE_RING_SLOTS
 
+#if ENABLE_COMPACT_CAPTURE
+  uint16_t ticks;
+  if (irparams.rcvstate == kIdleState) {
+    irparams.rcvstate = kMarkState;
+    ticks = 1;
+  } else {
+    if (now < start)
+      ticks = (UINT32_MAX - start + now) / kRawTick;
+    else
+      ticks = (now - start) / kRawTick;
+  }
+  // See irutils::compactRaw() for the format. Must be done before `rawlen`
+  // is incremented. See `IRrecv::_decodeEarly()`.
+  const uint32_t units = (ticks + (1U << (kCompactShift - 1))) >>
+      kCompactShift;
+  if (units < kCompactEscape) {
+    irparams.compact[pos++] = units;
+  } else {
+    irparams.compact[pos++] = kCompactEscape;
+    irparams.compact[pos++] = ticks >> 8;
+    irparams.compact[pos++] = ticks;
+  }
+  irparams.compactlen = pos;
+#else  // ENABLE_COMPACT_CAPTURE
   if (irparams.rcvstate == kIdleState) {
     irparams.rcvstate = kMarkState;
     irparams.rawbuf[rawlen] = 1;
@@ -121,9 +206,10 @@ static void USE_IRAM_ATTR gpio_intr() {
     else
       irparams.rawbuf[rawlen] = (now - start) / kRawTick;
   }
+#endif  // ENABLE_COMPACT_CAPTURE
   irparams.rawlen++;
 
-  start = now;
+  edge_time = now;
 
 #if defined(ESP8266)
   os_timer_arm(&timer, irparams.timeout, ONCE);
@@ -175,7 +261,19 @@ IRrecv::IRrecv(const uint16_t recvpin, const uint16_t bufsize,
   // Ensure we are going to be able to store all possible values in the
   // capture buffer.
   irparams.timeout = std::min(timeout, (uint8_t)kMaxTimeoutMs);
+#if CAPTURE_RING_SLOTS
+  // One block of memory for all the slots. Capturing starts in the first one.
+  capture_ring.buffer = new uint16_t[bufsize * CAPTURE_RING_SLOTS];
+  irparams.rawbuf = capture_ring.buffer;
+#else  // CAPTURE_RING_SLOTS
   irparams.rawbuf = new uint16_t[bufsize];
+#endif  // CAPTURE_RING_SLOTS
+#if ENABLE_COMPACT_CAPTURE
+  // Room for `bufsize` entries, when up to 1 in kCompactLongRatio are long.
+  irparams.compactsize = bufsize + 2 * (bufsize / kCompactLongRatio) + 3;
+  irparams.compact = new uint8_t[irparams.compactsize];
+  irparams.compactlen = 0;
+#endif  // ENABLE_COMPACT_CAPTURE
   if (irparams.rawbuf == NULL) {
     DPRINTLN(
         "Could not allocate memory for the primary IR buffer.\n"
@@ -185,7 +283,9 @@ IRrecv::IRrecv(const uint16_t recvpin, const uint16_t bufsize,
 #endif
   }
   // If we have been asked to use a save buffer (for decoding), then create one.
-  if (save_buffer) {
+  // The capture ring & compact capture make it redundant, so don't waste the
+  // memory on it.
+  if (save_buffer && !CAPTURE_RING_SLOTS && !ENABLE_COMPACT_CAPTURE) {
     irparams_save = new irparams_t;
     irparams_save->rawbuf = new uint16_t[bufsize];
     // Check we allocated the memory successfully.
@@ -204,6 +304,26 @@ IRrecv::IRrecv(const uint16_t recvpin, const uint16_t bufsize,
   _unknown_threshold = kUnknownThreshold;
 #endif  // DECODE_HASH
   _tolerance = kTolerance;
+  _early_gap = 0;
+  _early_rawlen = 0;
+  _skip_scan = false;
+#if ENABLE_NOISE_FILTER_OPTION
+  _noise_filter = kNoiseFilterMerge;
+#endif  // ENABLE_NOISE_FILTER_OPTION
+#if CUSTOM_PROTOCOL_SLOTS
+  clearProtocols();
+#endif  // CUSTOM_PROTOCOL_SLOTS
+#if DECODE_MEMO_SLOTS
+  setDecodeMemo(false);
+#endif  // DECODE_MEMO_SLOTS
+#if ENABLE_DECODE_SCORING
+  _best_match = false;
+  _score_sum = 0;
+  _score_count = 0;
+#endif  // ENABLE_DECODE_SCORING
+#if ENABLE_DECODE_PROFILING
+  resetProfile();
+#endif  // ENABLE_DECODE_PROFILING
 }
 
 /// Class destructor
@@ -215,7 +335,14 @@ IRrecv::~IRrecv(void) {
 #if defined(ESP32)
   if (timer != NULL) timerEnd(timer);  // Cleanup the ESP32 timeout timer.
 #endif  // ESP32
+#if CAPTURE_RING_SLOTS
+  delete[] capture_ring.buffer;
+#else  // CAPTURE_RING_SLOTS
   delete[] irparams.rawbuf;
+#endif  // CAPTURE_RING_SLOTS
+#if ENABLE_COMPACT_CAPTURE
+  delete[] irparams.compact;
+#endif  // ENABLE_COMPACT_CAPTURE
   if (irparams_save != NULL) {
     delete[] irparams_save->rawbuf;
     delete irparams_save;
@@ -245,7 +372,19 @@ void IRrecv::enableIRIn(const bool pullup) {
 #endif  // ESP32
 
   // Initialize state machine variables
+#if CAPTURE_RING_SLOTS
+  // Start with an empty ring, capturing into the first slot.
+  capture_ring.head = 0;
+  capture_ring.tail = 0;
+  capture_ring.held = false;
+  capture_ring.dropped = 0;
+  irparams.rawbuf = capture_ring.buffer;
+  irparams.rawlen = 0;
+  irparams.overflow = false;
+  irparams.rcvstate = kIdleState;
+#else  // CAPTURE_RING_SLOTS
   resume();
+#endif  // CAPTURE_RING_SLOTS
 
 #ifndef UNIT_TEST
 #if defined(ESP8266)
@@ -276,16 +415,77 @@ void IRrecv::disableIRIn(void) {
 /// Resume collection of received IR data.
 /// @note This is required if `decode()` is successful and `save_buffer` was
 ///   not set when the class was instanciated.
+/// @note When the capture ring is in use, capturing never stops. This just
+///   hands the slot from the last `decode()` or `popCapture()` back to the
+///   interrupt handler.
 /// @see IRrecv class constructor
 void IRrecv::resume(void) {
+#if CAPTURE_RING_SLOTS
+  if (capture_ring.held) {
+    capture_ring.held = false;
+    capture_ring.tail = (capture_ring.tail + 1) % CAPTURE_RING_SLOTS;
+  }
+#else  // CAPTURE_RING_SLOTS
   irparams.rcvstate = kIdleState;
   irparams.rawlen = 0;
+#if ENABLE_COMPACT_CAPTURE
+  irparams.compactlen = 0;
+#endif  // ENABLE_COMPACT_CAPTURE
   irparams.overflow = false;
 #if defined(ESP32)
   timerAlarmDisable(timer);
 #endif  // ESP32
+#endif  // CAPTURE_RING_SLOTS
 }
 
+#if CAPTURE_RING_SLOTS
+/// Publish the message the interrupt handler has just finished capturing to
+/// the capture ring, and start capturing the next one into a free slot.
+/// If there are no free slots, the message is dropped & counted instead.
+/// @note Only ever called from the interrupt handlers. It is the only
+///   producer, and the only thing that changes `capture_ring.head`.
+void USE_IRAM_ATTR IRrecv::_ringPublish(void) {
+  const uint8_t head = capture_ring.head;
+  const uint8_t next = (head + 1) % CAPTURE_RING_SLOTS;
+  if (next == capture_ring.tail) {
+    capture_ring.dropped++;  // Full. Reuse the current slot.
+  } else {
+    capture_ring.rawlen[head] = irparams.rawlen;
+    capture_ring.overflow[head] = irparams.overflow;
+    irparams.rawbuf = capture_ring.buffer + next * irparams.bufsize;
+    capture_ring.head = next;  // Must be last. It makes the slot visible.
+  }
+  irparams.rawlen = 0;
+  irparams.overflow = false;
+  irparams.rcvstate = kIdleState;
+}
+
+/// Get the oldest completed capture from the capture ring, if there is one.
+/// Any capture obtained by a previous call (or `decode()`) is released first.
+/// @param[out] results A ptr to where to point at the capture. Only `rawbuf`,
+///   `rawlen`, & `overflow` are set.
+/// @return A boolean. True if there was a capture, false if the ring is empty.
+/// @note The capture is only valid until the next call to `popCapture()`,
+///   `decode()`, or `resume()`. After that, the slot may be reused.
+bool IRrecv::popCapture(decode_results *results) {
+  resume();  // Release the slot we were holding, if any.
+  const uint8_t slot = capture_ring.tail;
+  if (slot == capture_ring.head) return false;  // Empty.
+  capture_ring.held = true;
+  results->rawbuf = capture_ring.buffer + slot * irparams.bufsize;
+  results->rawlen = capture_ring.rawlen[slot];
+  results->overflow = capture_ring.overflow[slot];
+  // Clear the entry after the end of the message. See `decode()` for why.
+  if (results->rawlen < irparams.bufsize) results->rawbuf[results->rawlen] = 0;
+  return true;
+}
+
+/// Nr. of completed messages thrown away because the capture ring was full.
+/// i.e. They weren't popped/decoded quickly enough.
+/// @return The nr. of messages dropped since `enableIRIn()` was called.
+uint32_t IRrecv::getDroppedCount(void) { return capture_ring.dropped; }
+#endif  // CAPTURE_RING_SLOTS
+
 /// Make a copy of the interrupt state & buffer data.
 /// Needed because irparams is marked as volatile, thus memcpy() isn't allowed.
 /// Only call this when you know the interrupt handlers won't modify anything.
@@ -331,48 +531,609 @@ void IRrecv::setUnknownThreshold(const uint16_t length) {
 /// @param[in] percent An integer percentage. (0-100)
 void IRrecv::setTolerance(const uint8_t percent) {
   _tolerance = std::min(percent, (uint8_t)100);
+#if DECODE_MEMO_SLOTS
+  clearDecodeMemo();  // What decodes may have changed.
+#endif  // DECODE_MEMO_SLOTS
 }
 
 /// Get the base tolerance percentage for matching incoming IR messages.
 /// @return A integer percentage.
 uint8_t IRrecv::getTolerance(void) { return _tolerance; }
 
+/// Set how long the line must be quiet before `decode()` tries to decode a
+/// message that is still being captured. i.e. Before the capture timeout.
+/// The message is only reported (& the capture ended) early if a protocol
+/// matches it. Anything else still waits for the timeout, as normal.
+/// This can greatly reduce the latency of decoding, particularly when a large
+/// timeout is used for A/C protocols. `decode()` needs to be called often.
+/// @param[in] usecs Nr. of uSeconds. 0 disables early decoding. (Default)
+/// @note It should be longer than any space within the messages you expect,
+///   as a protocol with a variable size may decode a partial message.
+///   e.g. 8 bits of a 12 bit message.
+/// @note It is not used when `decode()` is asked to filter noise.
+/// @see kEarlyDecodeGap for a suggested value.
+void IRrecv::setEarlyDecodeGap(const uint16_t usecs) { _early_gap = usecs; }
+
+/// Get how long the line must be quiet before an early decode is attempted.
+/// @return The nr. of uSeconds. 0 means early decoding is disabled.
+uint16_t IRrecv::getEarlyDecodeGap(void) { return _early_gap; }
+
+/// Set if `decode()` should scan the pulses it may skip (see `max_skip`) for
+/// where a protocol's header could start, & only try decoding those protocols
+/// from those places.
+/// This makes larger `max_skip` values much cheaper, as decoding is otherwise
+/// attempted (with every header-less protocol) after each & every skipped
+/// pulse pair.
+/// @param[in] enable true to scan, false (Default) to try every position.
+/// @note When scanning, protocols without a distinctive header (e.g. RC5)
+///   are only found if no pulses need to be skipped.
+/// @note Scanning isn't used when the tolerance is very high.
+///   See `kDecodeIndexMaxTolerance`.
+void IRrecv::setSkipScan(const bool enable) { _skip_scan = enable; }
+
+/// Get if `decode()` scans the pulses it may skip for where to decode from.
+/// @return true if it scans, false if it tries every position.
+bool IRrecv::getSkipScan(void) { return _skip_scan; }
+
+#if ENABLE_DECODE_SCORING
+/// Set if `decode()` reports the best matching protocol, rather than the first.
+/// i.e. Every decoder that is plausible for the message is tried, & the match
+/// with the lowest timing error (`decode_results::score`) wins. The others are
+/// listed in `decode_results::candidates`. Ties go to the usual decoder order.
+/// Only the first position (of those `max_skip` allows) with a match counts.
+/// @param[in] enable true to use the best match, false for the first match.
+///   (Default: false)
+/// @note It avoids needing the decoder order to pick between protocols with
+///   similar timings (e.g. NEC-like ones), at the cost of trying more decoders.
+void IRrecv::setBestMatch(const bool enable) { _best_match = enable; }
+
+/// Get if `decode()` reports the best matching protocol, or the first.
+/// @return true if it is the best match, false if it is the first match.
+bool IRrecv::getBestMatch(void) { return _best_match; }
+#endif  // ENABLE_DECODE_SCORING
+
+#if DECODE_MEMO_SLOTS
+/// Set if `decode()` remembers recent decodes, & re-uses them for repeats of
+/// the same message rather than running the decoders again.
+/// See `DECODE_MEMO_SLOTS`.
+/// @param[in] enable true to use the memo, false to not. (Default: false)
+/// @note `decode()` then updates the object for every capture, so it can't be
+///   shared between threads. Call `clearDecodeMemo()` after changing any other
+///   decoding settings (e.g. `addProtocol()`). `setTolerance()` does so.
+void IRrecv::setDecodeMemo(const bool enable) {
+  _use_memo = enable;
+  clearDecodeMemo();
+}
+
+/// Get if `decode()` re-uses recent decodes for repeats of the same message.
+/// @return true if it does, false if it doesn't.
+bool IRrecv::getDecodeMemo(void) { return _use_memo; }
+
+/// Forget all the remembered decodes. See `setDecodeMemo()`.
+void IRrecv::clearDecodeMemo(void) {
+  for (uint8_t i = 0; i < DECODE_MEMO_SLOTS; i++) _memo[i].fingerprint = 0;
+}
+
+/// Calculate a fingerprint of a capture's timings, for the decode memo.
+/// Like `decodeHash()`, each mark (or space) is only compared against the
+/// next one as shorter, about the same, or longer, & the results hashed.
+/// That is cheap, & unaffected by the usual jitter between captures of the
+/// same message, as the pulses of a protocol are either about the same, or
+/// differ by a lot more than the 20% threshold.
+/// @param[in] results Ptr to the capture.
+/// @return The fingerprint. Never 0.
+uint32_t IRrecv::_fingerprint(const decode_results *results) {
+  uint32_t hash = kFnvBasis32 ^ results->rawlen;
+  for (uint16_t i = kStartOffset; i + 2 < results->rawlen; i++) {
+    const uint32_t now = results->rawbuf[i];
+    const uint32_t next = results->rawbuf[i + 2];
+    // Same as `compare()`, but without the floating point.
+    uint8_t value = 1;
+    if (next * 5 < now * 4)
+      value = 0;
+    else if (now * 5 < next * 4)
+      value = 2;
+    hash = (hash * kFnvPrime32) ^ value;
+  }
+  return hash ? hash : 1;
+}
+
+/// Use a remembered decode for a capture, if it is a repeat of one.
+/// i.e. It has the same fingerprint & length, a similar leading mark & space
+/// (which gives the timings' scale), & was last seen recently.
+/// @param[in,out] results Ptr to the capture & where to store the result.
+/// @param[in] fingerprint The capture's fingerprint. See `_fingerprint()`.
+/// @return true if a remembered decode was used, false if not.
+bool IRrecv::_recallDecode(decode_results *results,
+                           const uint32_t fingerprint) {
+  if (results->rawlen <= kStartOffset + 1) return false;
+  const uint16_t mark = results->rawbuf[kStartOffset];
+  const uint16_t space = results->rawbuf[kStartOffset + 1];
+  for (uint8_t i = 0; i < DECODE_MEMO_SLOTS; i++) {
+    decode_memo_t *memo = &_memo[i];
+    if (memo->fingerprint != fingerprint || memo->rawlen != results->rawlen)
+      continue;
+    if (memo->seen.elapsed() > kDecodeMemoTimeoutMs) continue;
+    if (!match(mark, memo->mark * kRawTick, kDecodeMemoTolerance) ||
+        !match(space, memo->space * kRawTick, kDecodeMemoTolerance))
+      continue;
+    // It's a repeat. Keep our capture, but use the remembered decode.
+    volatile uint16_t *rawbuf = results->rawbuf;
+    const bool overflow = results->overflow;
+    *results = memo->result;
+    results->rawbuf = rawbuf;
+    results->overflow = overflow;
+    results->repeat = true;
+    memo->seen.reset();  // Keep it while the key is being held down etc.
+    return true;
+  }
+  return false;
+}
+
+/// Remember a successful decode of a capture. It replaces the oldest (or an
+/// expired) remembered decode, if there are no free slots.
+/// @param[in] results Ptr to the decoded capture.
+/// @param[in] fingerprint The capture's fingerprint. See `_fingerprint()`.
+void IRrecv::_rememberDecode(const decode_results *results,
+                             const uint32_t fingerprint) {
+  if (results->rawlen <= kStartOffset + 1) return;
+  decode_memo_t *memo = &_memo[0];
+  for (uint8_t i = 0; i < DECODE_MEMO_SLOTS; i++) {
+    if (!_memo[i].fingerprint) {  // A free slot.
+      memo = &_memo[i];
+      break;
+    }
+    if (_memo[i].seen.elapsed() > memo->seen.elapsed()) memo = &_memo[i];
+  }
+  memo->fingerprint = fingerprint;
+  memo->rawlen = results->rawlen;
+  memo->mark = results->rawbuf[kStartOffset];
+  memo->space = results->rawbuf[kStartOffset + 1];
+  memo->seen.reset();
+  memo->result = *results;
+}
+#endif  // DECODE_MEMO_SLOTS
+
+#if CUSTOM_PROTOCOL_SLOTS
+/// Add a protocol for `decode()` to try, described by a descriptor.
+/// They are tried, in the order they were added, after the built-in protocols.
+/// @param[in] timing A ptr to the descriptor of the protocol.
+/// @note The descriptor isn't copied, so it must outlive its use here, & be in
+///   RAM. It is read directly while decoding, so it can't be in PROGMEM/flash.
+/// @return true if it was added, false if there was no room for it.
+bool IRrecv::addProtocol(const protocol_timing_t *timing) {
+  if (timing == NULL) return false;
+  for (uint8_t i = 0; i < CUSTOM_PROTOCOL_SLOTS; i++)
+    if (_protocols[i] == NULL) {
+      _protocols[i] = timing;
+      return true;
+    }
+  return false;  // No free slots.
+}
+
+/// Remove all the protocols added by `addProtocol()`.
+void IRrecv::clearProtocols(void) {
+  for (uint8_t i = 0; i < CUSTOM_PROTOCOL_SLOTS; i++) _protocols[i] = NULL;
+}
+#endif  // CUSTOM_PROTOCOL_SLOTS
+
+#if ENABLE_DECODE_PROFILING
+/// Get the decode profiling statistics collected so far.
+/// @return A reference to the statistics. They keep being updated by `decode()`
+///   so copy them if you need a snapshot.
+const decode_profile_t &IRrecv::getProfile(void) { return _profile; }
+
+/// Reset (zero) all the decode profiling statistics.
+void IRrecv::resetProfile(void) { memset(&_profile, 0, sizeof(_profile)); }
+
+/// Record the outcome of a single decoder attempt.
+/// @param[in] type The protocol/decoder that was attempted.
+/// @param[in] matched Was the decoder successful?
+/// @param[in] usecs How long the attempt took. (uSeconds)
+void IRrecv::_profileAttempt(const decode_type_t type, const bool matched,
+                             const uint32_t usecs) {
+  if (type < 0 || type > kLastDecodeType) return;
+  _profile.attempts[type]++;
+  if (matched) _profile.matches[type]++;
+  _profile.usecs[type] += usecs;
+}
+
+/// Record the total time it took to decode a capture.
+/// @param[in] usecs How long `decode()` spent on the capture. (uSeconds)
+void IRrecv::_profileCapture(const uint32_t usecs) {
+  uint8_t bucket = 0;
+  for (uint32_t remaining = usecs >> 1;
+       remaining && bucket < kDecodeLatencyBuckets - 1;
+       remaining >>= 1)
+    bucket++;
+  _profile.captures++;
+  _profile.latency[bucket]++;
+}
+#endif  // ENABLE_DECODE_PROFILING
+
 #if ENABLE_NOISE_FILTER_OPTION
-/// Remove or merge pulses in the capture buffer that are too short.
+/// Remove, merge, or smooth pulses in the capture buffer that are too short.
+/// It is done in a single pass over the buffer. i.e. Linear time.
 /// @param[in,out] results Ptr to the decode_results we are going to filter.
 /// @param[in] floor Only allow values in the buffer large than this.
 ///   (in microSeconds)
-void IRrecv::crudeNoiseFilter(decode_results *results, const uint16_t floor) {
-  if (floor == 0) return;  // Nothing to do.
+/// @param[in] mode How to deal with any pulses that are too short.
+///   kNoiseFilterMerge: Remove it & the following pulse, and add them both to
+///     the previous pulse. e.g. A glitch in a space, becomes part of the space.
+///   kNoiseFilterDrop: Remove it & the following pulse, discarding their time.
+///   kNoiseFilterMedian: Replace it with the median of it & the pulses of the
+///     same type (mark or space) either side. The buffer length is unchanged.
+///     The first & last two pulses are left alone.
+/// @return The nr. of pulses that were too short & thus changed.
+uint16_t IRrecv::noiseFilter(decode_results *results, const uint16_t floor,
+                             const noise_filter_t mode) {
+  if (floor == 0) return 0;  // Nothing to do.
   const uint16_t kTickFloor = floor / kRawTick;
   const uint16_t kBufSize = getBufSize();
-  uint16_t offset = kStartOffset;
-  while (offset < results->rawlen && offset + 2 < kBufSize) {
-    uint16_t curr = results->rawbuf[offset];
-    uint16_t next = results->rawbuf[offset + 1];
-    uint16_t addition = curr + next;
+  const uint16_t rawlen = results->rawlen;
+  uint16_t changed = 0;
+  if (mode == kNoiseFilterMedian) {
+    for (uint16_t i = kStartOffset + 2; i + 2 < rawlen; i++) {
+      const uint16_t curr = results->rawbuf[i];
+      if (curr >= kTickFloor) continue;  // Long enough.
+      const uint16_t before = results->rawbuf[i - 2];
+      const uint16_t after = results->rawbuf[i + 2];
+      results->rawbuf[i] = std::max(std::min(before, after),
+                                    std::min(std::max(before, after), curr));
+      changed++;
+    }
+    return changed;
+  }
+  // Compact the buffer in place. We only ever write to where we've read from.
+  uint16_t read = kStartOffset;
+  uint16_t write = kStartOffset;
+  while (read < rawlen && write + 2 < kBufSize) {
+    const uint16_t curr = results->rawbuf[read];
     if (curr < kTickFloor) {  // Is it too short?
-      // Shuffle the buffer down. i.e. Remove the mark & space pair.
-      // Note: `memcpy()` can't be used as rawbuf is `volatile`.
-      for (uint16_t i = offset + 2; i <= results->rawlen && i < kBufSize; i++)
-        results->rawbuf[i - 2] = results->rawbuf[i];
-      if (offset > 1) {  // There is a previous pair we can add to.
-        // Merge this pair into into the previous space.
-        results->rawbuf[offset - 1] += addition;
-      }
-      results->rawlen -= 2;  // Adjust the length.
+      // Remove the pulse & the following one. e.g. The mark & space pair.
+      const uint16_t next = (read + 1 < kBufSize) ? results->rawbuf[read + 1]
+                                                  : 0;
+      // Merge them into the previous pulse, if there is one.
+      if (mode == kNoiseFilterMerge && write > kStartOffset)
+        results->rawbuf[write - 1] += curr + next;
+      read += 2;
+      changed++;
     } else {
-      offset++;  // Move along.
+      results->rawbuf[write++] = results->rawbuf[read++];
     }
   }
+  // Move down anything we didn't get to, including the end of buffer entry.
+  while (read <= rawlen && read < kBufSize)
+    results->rawbuf[write++] = results->rawbuf[read++];
+  results->rawlen = rawlen - 2 * changed;  // Adjust the length.
+  return changed;
 }
+
+/// Set how `decode()` deals with pulses below its `noise_floor`.
+/// @param[in] mode The strategy to use. See `noiseFilter()`.
+///   (Default: kNoiseFilterMerge)
+void IRrecv::setNoiseFilter(const noise_filter_t mode) { _noise_filter = mode; }
+
+/// Get how `decode()` deals with pulses below its `noise_floor`.
+/// @return The strategy in use. See `noiseFilter()`.
+noise_filter_t IRrecv::getNoiseFilter(void) { return _noise_filter; }
 #endif  // ENABLE_NOISE_FILTER_OPTION
 
+// The decoder dispatch index.
+// Entries are in the order the decoders are attempted, thus priority matters.
+// e.g. Protocols that look like NEC, but are more specific, must precede it.
+// Leading mark & space values are nominal uSeconds taken from each protocol's
+// header (or first bit if it has no header). Entries with a zero mark are the
+// "fallback" decoders (no usable header) and are always attempted.
+// Note: The table is terminated by an UNKNOWN entry.
+// Note: Each protocol here also needs a case in `_decodeIndexed()`.
+// Note: It is kept in PROGMEM (flash) to save RAM. Use `memcpy_P()` to read it.
+const decode_index_t kDecodeIndex[] PROGMEM = {
+#if DECODE_AIWA_RC_T501
+  // Try decodeAiwaRCT501() before decodeSanyoLC7461() & decodeNEC()
+  // because the protocols are similar. This protocol is more specific than
+  // those ones, so should go before them.
+  {decode_type_t::AIWA_RC_T501, 8960, 8960, 2240, 4480},  // NEC Hdr & Rpt
+#endif
+#if DECODE_SANYO
+  // Try decodeSanyoLC7461() before decodeNEC() because the protocols are
+  // similar in timings & structure, but the Sanyo one is much longer than the
+  // NEC protocol (42 vs 32 bits) so this one should be tried first to try to
+  // reduce false detection as a NEC packet.
+  {decode_type_t::SANYO_LC7461, 9000, 9000, 4500, 4500},
+#endif
+#if DECODE_CARRIER_AC
+  // Try decodeCarrierAC() before decodeNEC() because the protocols are
+  // similar in timings & structure, but the Carrier one is much longer than
+  // the NEC protocol (3x32 bits vs 1x32 bits) so this one should be tried
+  // first to try to reduce false detection as a NEC packet.
+  {decode_type_t::CARRIER_AC, 8532, 8532, 4228, 4228},
+#endif
+#if DECODE_PIONEER
+  // Try decodePioneer() before decodeNEC() because the protocols are
+  // similar in timings & structure, but the Pioneer one is much longer than
+  // the NEC protocol (2x32 bits vs 1x32 bits) so this one should be tried
+  // first to try to reduce false detection as a NEC packet.
+  {decode_type_t::PIONEER, 8506, 8506, 4191, 4191},
+#endif
+#if DECODE_EPSON
+  // Try decodeEpson() before decodeNEC() because the protocols are
+  // similar in timings & structure, but the Epson one is much longer than the
+  // NEC protocol (3x32 identical bits vs 1x32 bits) so this one should be tried
+  // first to try to reduce false detection as a NEC packet.
+  {decode_type_t::EPSON, 8960, 8960, 4480, 4480},  // NEC Hdr
+#endif
+#if DECODE_NEC
+  {decode_type_t::NEC, 8960, 8960, 2240, 4480},  // Hdr & Rpt
+#endif
+#if DECODE_SONY
+  {decode_type_t::SONY, 2400, 2400, 600, 600},
+#endif
+#if DECODE_MITSUBISHI
+  // No header. Use the first bit instead.
+  {decode_type_t::MITSUBISHI, 300, 300, 900, 2100},
+#endif
+#if DECODE_MITSUBISHI_AC
+  {decode_type_t::MITSUBISHI_AC, 3400, 3400, 1750, 1750},
+#endif
+#if DECODE_MITSUBISHI2
+  {decode_type_t::MITSUBISHI2, 8400, 8400, 8400, 8400},
+#endif
+#if DECODE_RC5
+  {decode_type_t::RC5, 0, 0, 0, 0},  // Manchester encoded. No usable header.
+#endif
+#if DECODE_RC6
+  {decode_type_t::RC6, 2664, 2664, 888, 888},
+#endif
+#if DECODE_RCMM
+  {decode_type_t::RCMM, 416, 416, 277, 277},
+#endif
+#if DECODE_FUJITSU_AC
+  // Fujitsu A/C needs to precede Panasonic and Denon as it has a short
+  // message which looks exactly the same as a Panasonic/Denon message.
+  {decode_type_t::FUJITSU_AC, 3324, 3324, 1574, 1574},
+#endif
+#if DECODE_DENON
+  // Denon needs to precede Panasonic as it is a special case of Panasonic.
+  // It also tries the headerless Sharp protocol, so it has no usable header.
+  {decode_type_t::DENON, 0, 0, 0, 0},
+#endif
+#if DECODE_PANASONIC
+  {decode_type_t::PANASONIC, 3456, 3456, 1728, 1728},
+#endif
+#if DECODE_LG
+  // LG2, LG (28-bit), LG32 (32-bit), and the repeat codes.
+  {decode_type_t::LG, 3200, 8950, 2250, 9850},
+#endif
+#if DECODE_GICABLE
+  // Note: Needs to happen before JVC decode, because it looks similar except
+  //       with a required NEC-like repeat code.
+  {decode_type_t::GICABLE, 9000, 9000, 4400, 4400},
+#endif
+#if DECODE_JVC
+  {decode_type_t::JVC, 0, 0, 0, 0},  // Repeats have no header.
+#endif
+#if DECODE_SAMSUNG
+  {decode_type_t::SAMSUNG, 4480, 4480, 4480, 4480},
+#endif
+#if DECODE_SAMSUNG36
+  {decode_type_t::SAMSUNG36, 4515, 4515, 4438, 4438},
+#endif
+#if DECODE_WHYNTER
+  {decode_type_t::WHYNTER, 750, 750, 750, 750},  // Leading bit.
+#endif
+#if DECODE_DISH
+  {decode_type_t::DISH, 400, 400, 6100, 6100},
+#endif
+#if DECODE_SHARP
+  {decode_type_t::SHARP, 0, 0, 0, 0},  // No header.
+#endif
+#if DECODE_COOLIX
+  {decode_type_t::COOLIX, 4692, 4692, 4416, 4416},
+#endif
+#if DECODE_NIKAI
+  {decode_type_t::NIKAI, 4000, 4000, 4000, 4000},
+#endif
+#if DECODE_KELVINATOR
+  // Kelvinator based-devices use a similar code to Gree ones, to avoid false
+  // matches this needs to happen before decodeGree().
+  {decode_type_t::KELVINATOR, 9010, 9010, 4505, 4505},
+#endif
+#if DECODE_DAIKIN
+  {decode_type_t::DAIKIN, 0, 0, 0, 0},  // Starts with headerless preamble bits.
+#endif
+#if DECODE_DAIKIN2
+  {decode_type_t::DAIKIN2, 10024, 10024, 25180, 25180},  // Leader.
+#endif
+#if DECODE_DAIKIN216
+  {decode_type_t::DAIKIN216, 3440, 3440, 1750, 1750},
+#endif
+#if DECODE_TOSHIBA_AC
+  {decode_type_t::TOSHIBA_AC, 4400, 4400, 4300, 4300},
+#endif
+#if DECODE_MIDEA
+  {decode_type_t::MIDEA, 4480, 4480, 4480, 4480},
+#endif
+#if DECODE_MAGIQUEST
+  {decode_type_t::MAGIQUEST, 0, 0, 0, 0},  // No header.
+#endif
+  /* NOTE: Disabled due to poor quality.
+#if DECODE_SANYO
+  // The Sanyo S866500B decoder is very poor quality & depricated.
+  // *IF* you are going to enable it, do it near last to avoid false positive
+  // matches.
+  {decode_type_t::SANYO, 3500, 3500, 950, 950},
+#endif
+  */
+#if DECODE_NEC
+  // Some devices send NEC-like codes that don't follow the true NEC spec.
+  // This should detect those. e.g. Apple TV remote etc.
+  // This needs to be done after all other codes that use strict and some
+  // other protocols that are NEC-like as well, as turning off strict may
+  // cause this to match other valid protocols.
+  {decode_type_t::NEC_LIKE, 8960, 8960, 2240, 4480},  // NEC Hdr & Rpt
+#endif
+#if DECODE_LASERTAG
+  {decode_type_t::LASERTAG, 0, 0, 0, 0},  // Manchester encoded. No header.
+#endif
+#if DECODE_GREE
+  // Gree based-devices use a similar code to Kelvinator ones, to avoid false
+  // matches this needs to happen after decodeKelvinator().
+  {decode_type_t::GREE, 9000, 9000, 4500, 4500},
+#endif
+#if DECODE_HAIER_AC
+  {decode_type_t::HAIER_AC, 3000, 3000, 3000, 3000},
+#endif
+#if DECODE_HAIER_AC_YRW02
+  {decode_type_t::HAIER_AC_YRW02, 3000, 3000, 3000, 3000},
+#endif
+#if DECODE_HITACHI_AC424
+  // HitachiAc424 should be checked before HitachiAC, HitachiAC2,
+  // & HitachiAC184
+  {decode_type_t::HITACHI_AC424, 29784, 29784, 49290, 49290},  // Leader.
+#endif  // DECODE_HITACHI_AC424
+#if DECODE_MITSUBISHI136
+  // Needs to happen before HitachiAc3 decode.
+  {decode_type_t::MITSUBISHI136, 3324, 3324, 1474, 1474},
+#endif  // DECODE_MITSUBISHI136
+#if DECODE_HITACHI_AC3
+  // HitachiAc3 should be checked before HitachiAC & HitachiAC2
+  {decode_type_t::HITACHI_AC3, 3400, 3400, 1660, 1660},
+#endif  // DECODE_HITACHI_AC3
+#if DECODE_HITACHI_AC344
+  // HitachiAC344 should be checked before HitachiAC
+  {decode_type_t::HITACHI_AC344, 3300, 3300, 1700, 1700},
+#endif  // DECODE_HITACHI_AC344
+#if DECODE_HITACHI_AC2
+  // HitachiAC2 should be checked before HitachiAC
+  {decode_type_t::HITACHI_AC2, 3300, 3300, 1700, 1700},
+#endif  // DECODE_HITACHI_AC2
+#if DECODE_HITACHI_AC
+  {decode_type_t::HITACHI_AC, 3300, 3300, 1700, 1700},
+#endif
+#if DECODE_HITACHI_AC1
+  {decode_type_t::HITACHI_AC1, 3400, 3400, 3400, 3400},
+#endif
+#if DECODE_WHIRLPOOL_AC
+  {decode_type_t::WHIRLPOOL_AC, 8950, 8950, 4484, 4484},
+#endif
+#if DECODE_SAMSUNG_AC
+  {decode_type_t::SAMSUNG_AC, 586, 586, 17844, 17844},  // Leading bit.
+#endif
+#if DECODE_ELECTRA_AC
+  {decode_type_t::ELECTRA_AC, 9166, 9166, 4470, 4470},
+#endif
+#if DECODE_PANASONIC_AC
+  {decode_type_t::PANASONIC_AC, 3456, 3456, 1728, 1728},
+#endif
+#if DECODE_LUTRON
+  {decode_type_t::LUTRON, 0, 0, 0, 0},  // No header.
+#endif
+#if DECODE_MWM
+  {decode_type_t::MWM, 0, 0, 0, 0},  // No header.
+#endif
+#if DECODE_VESTEL_AC
+  {decode_type_t::VESTEL_AC, 3110, 3110, 9066, 9066},
+#endif
+#if DECODE_MITSUBISHI112 || DECODE_TCL112AC
+  // Mitsubish112 and Tcl112 share the same decoder.
+  {decode_type_t::MITSUBISHI112, 3000, 3450, 1650, 1696},
+#endif  // DECODE_MITSUBISHI112 || DECODE_TCL112AC
+#if DECODE_TECO
+  {decode_type_t::TECO, 9000, 9000, 4440, 4440},
+#endif
+#if DECODE_LEGOPF
+  {decode_type_t::LEGOPF, 158, 158, 1026, 1026},
+#endif
+#if DECODE_MITSUBISHIHEAVY
+  {decode_type_t::MITSUBISHI_HEAVY_152, 3140, 3140, 1630, 1630},
+#endif
+#if DECODE_ARGO
+  {decode_type_t::ARGO, 6400, 6400, 3300, 3300},
+#endif  // DECODE_ARGO
+#if DECODE_SHARP_AC
+  {decode_type_t::SHARP_AC, 3800, 3800, 1900, 1900},
+#endif
+#if DECODE_GOODWEATHER
+  {decode_type_t::GOODWEATHER, 6820, 6820, 6820, 6820},
+#endif  // DECODE_GOODWEATHER
+#if DECODE_INAX
+  {decode_type_t::INAX, 9000, 9000, 4500, 4500},
+#endif  // DECODE_INAX
+#if DECODE_TROTEC
+  {decode_type_t::TROTEC, 5952, 5952, 7364, 7364},
+#endif  // DECODE_TROTEC
+#if DECODE_DAIKIN160
+  {decode_type_t::DAIKIN160, 5000, 5000, 2145, 2145},
+#endif  // DECODE_DAIKIN160
+#if DECODE_SOLEUS
+  {decode_type_t::SOLEUS, 6112, 6112, 7391, 7391},
+#endif  // DECODE_SOLEUS
+#if DECODE_DAIKIN176
+  {decode_type_t::DAIKIN176, 5070, 5070, 2140, 2140},
+#endif  // DECODE_DAIKIN176
+#if DECODE_DAIKIN128
+  {decode_type_t::DAIKIN128, 9800, 9800, 9800, 9800},  // Leader.
+#endif  // DECODE_DAIKIN128
+#if DECODE_AMCOR
+  {decode_type_t::AMCOR, 8200, 8200, 4200, 4200},
+#endif  // DECODE_AMCOR
+#if DECODE_DAIKIN152
+  {decode_type_t::DAIKIN152, 0, 0, 0, 0},  // Starts with headerless leader.
+#endif  // DECODE_DAIKIN152
+#if DECODE_SYMPHONY
+  {decode_type_t::SYMPHONY, 0, 0, 0, 0},  // No header.
+#endif  // DECODE_SYMPHONY
+#if DECODE_DAIKIN64
+  {decode_type_t::DAIKIN64, 9800, 9800, 9800, 9800},  // Leader.
+#endif  // DECODE_DAIKIN64
+#if DECODE_AIRWELL
+  {decode_type_t::AIRWELL, 0, 0, 0, 0},  // Manchester encoded.
+#endif  // DECODE_AIRWELL
+#if DECODE_DELONGHI_AC
+  {decode_type_t::DELONGHI_AC, 8984, 8984, 4200, 4200},
+#endif  // DECODE_DELONGHI_AC
+#if DECODE_DOSHISHA
+  {decode_type_t::DOSHISHA, 3412, 3412, 1722, 1722},
+#endif  // DECODE_DOSHISHA
+#if DECODE_MULTIBRACKETS
+  {decode_type_t::MULTIBRACKETS, 0, 0, 0, 0},  // Variable length header.
+#endif  // DECODE_MULTIBRACKETS
+#if DECODE_CARRIER_AC40
+  {decode_type_t::CARRIER_AC40, 8402, 8402, 4166, 4166},
+#endif  // DECODE_CARRIER_AC40
+#if DECODE_CARRIER_AC64
+  {decode_type_t::CARRIER_AC64, 8940, 8940, 4556, 4556},
+#endif  // DECODE_CARRIER_AC64
+#if DECODE_CORONA_AC
+  {decode_type_t::CORONA_AC, 3500, 3500, 1680, 1680},
+#endif  // DECODE_CORONA_AC
+#if DECODE_MIDEA24
+  {decode_type_t::MIDEA24, 8960, 8960, 4480, 4480},  // NEC Hdr
+#endif  // DECODE_MIDEA24
+#if DECODE_ZEPEAL
+  {decode_type_t::ZEPEAL, 2330, 2330, 3380, 3380},
+#endif  // DECODE_ZEPEAL
+#if DECODE_SANYO_AC
+  {decode_type_t::SANYO_AC, 8500, 8500, 4200, 4200},
+#endif  // DECODE_SANYO_AC
+#if DECODE_VOLTAS
+  {decode_type_t::VOLTAS, 0, 0, 0, 0},  // No header. Ignores the offset.
+#endif  // DECODE_VOLTAS
+#if DECODE_METZ
+  {decode_type_t::METZ, 880, 880, 2336, 2336},
+#endif  // DECODE_METZ
+  // Typically new protocols are added above this line.
+  {(uint8_t)decode_type_t::UNKNOWN, 0, 0, 0, 0}  // End of table marker.
+};
+
 /// Decodes the received IR message.
 /// If the interrupt state is saved, we will immediately resume waiting
 /// for the next IR message to avoid missing messages.
 /// @note There is a trade-off here. Saving the state means less time lost until
 /// we can receiving the next message vs. using more RAM. Choose appropriately.
+/// @note With the capture ring (`CAPTURE_RING_SLOTS`), capturing never stops,
+///   & the oldest waiting message is decoded in place. `save` is ignored.
 /// @param[out] results A PTR to where the decoded IR message will be stored.
 /// @param[out] save A PTR to an irparams_t instance in which to save
 ///   the interrupt's memory/state. NULL means don't save it.
@@ -408,9 +1169,24 @@ void IRrecv::crudeNoiseFilter(decode_results *results, const uint16_t floor) {
 /// @return A boolean indicating if an IR message is ready or not.
 bool IRrecv::decode(decode_results *results, irparams_t *save,
                     uint8_t max_skip, uint16_t noise_floor) {
+#if CAPTURE_RING_SLOTS
+  // Decode directly from the oldest completed slot in the capture ring.
+  // The interrupt handler won't touch it until we are done with it, so no
+  // save buffer is needed.
+  (void)save;  // Unused.
+#ifndef UNIT_TEST
+  if (!popCapture(results))
+    return _decodeEarly(results, save, max_skip, noise_floor,
+                        micros() - edge_time);
+#endif
+  DPROFILE_TIMER(decode_timer);  // Time how long it takes to decode.
+  const bool resumed = false;
+#else  // CAPTURE_RING_SLOTS
   // Proceed only if an IR message been received.
 #ifndef UNIT_TEST
-  if (irparams.rcvstate != kStopState) return false;
+  if (irparams.rcvstate != kStopState)
+    return _decodeEarly(results, save, max_skip, noise_floor,
+                        micros() - edge_time);
 #endif
 
   // Clear the entry we are currently pointing to when we got the timeout.
@@ -421,7 +1197,13 @@ bool IRrecv::decode(decode_results *results, irparams_t *save,
   // interrupt. decode() is not stored in ICACHE_RAM.
   // Another better option would be to zero the entire irparams.rawbuf[] on
   // resume() but that is a much more expensive operation compare to this.
+#if ENABLE_COMPACT_CAPTURE
+  // Unpack the interrupt handler's compact capture into the capture buffer.
+  irparams.rawlen = irutils::expandRaw(irparams.compact, irparams.compactlen,
+                                       irparams.rawbuf, irparams.bufsize);
+#endif  // ENABLE_COMPACT_CAPTURE
   irparams.rawbuf[irparams.rawlen] = 0;
+  DPROFILE_TIMER(decode_timer);  // Time how long it takes to decode.
 
   bool resumed = false;  // Flag indicating if we have resumed.
 
@@ -435,6 +1217,11 @@ bool IRrecv::decode(decode_results *results, irparams_t *save,
     results->rawlen = irparams.rawlen;
     results->overflow = irparams.overflow;
 #endif
+#if ENABLE_COMPACT_CAPTURE
+    // The interrupt handler only uses the compact buffer, so it can carry on.
+    resume();
+    resumed = true;
+#endif  // ENABLE_COMPACT_CAPTURE
   } else {
     copyIrParams(&irparams, save);  // Duplicate the interrupt's memory.
     resume();  // It's now safe to rearm. The IR message won't be overridden.
@@ -444,7 +1231,89 @@ bool IRrecv::decode(decode_results *results, irparams_t *save,
     results->rawlen = save->rawlen;
     results->overflow = save->overflow;
   }
+#endif  // CAPTURE_RING_SLOTS
+
+  _early_rawlen = 0;  // A new capture, so allow early attempts on it again.
+
+#if ENABLE_NOISE_FILTER_OPTION
+  noiseFilter(results, noise_floor, _noise_filter);
+#endif  // ENABLE_NOISE_FILTER_OPTION
+#if DECODE_MEMO_SLOTS
+  // Skip the decoders if it's a repeat of a message we've just decoded.
+  const uint32_t fingerprint = _use_memo ? _fingerprint(results) : 0;
+  if (_use_memo && _recallDecode(results, fingerprint)) {
+    DPROFILE_CAPTURE(decode_timer);
+    return true;
+  }
+#endif  // DECODE_MEMO_SLOTS
+  if (_tryDecoders(results, max_skip)) {
+#if DECODE_MEMO_SLOTS
+    if (_use_memo) _rememberDecode(results, fingerprint);
+#endif  // DECODE_MEMO_SLOTS
+    DPROFILE_CAPTURE(decode_timer);
+    return true;
+  }
+#if DECODE_HASH
+  // decodeHash returns a hash on any input.
+  // Thus, it needs to be last in the list.
+  // If you add any decodes, add them before this.
+  if (decodeHash(results)) {
+    DPROFILE_CAPTURE(decode_timer);
+    return true;
+  }
+#endif  // DECODE_HASH
+  DPROFILE_CAPTURE(decode_timer);
+  // Throw away and start over
+  if (!resumed)  // Check if we have already resumed.
+    resume();
+  return false;
+}
+
+#if ENABLE_PULSE_CLASSIFICATION
+// Pulse classification. Durations are put into classes half an octave wide.
+// e.g. 2-2, 3-3, 4-5, 6-7, 8-11, 12-15, 16-23 kRawTicks etc. These are
+// `constexpr`, so the classes of a protocol's timings are compile time
+// constants. See `IRrecv::_plausibleLead()`.
+
+/// The position of the most significant bit set in a value.
+/// @param[in] value The value. Must be non-zero.
+/// @return The bit position. e.g. 0 for 1, 3 for 8 to 15.
+static constexpr uint8_t msbPosition(const uint32_t value) {
+  return (value > 1) ? 1 + msbPosition(value >> 1) : 0;
+}
 
+/// The class of a duration.
+/// @param[in] ticks The duration. (kRawTicks)
+/// @return The class, from 0 to kPulseClasses - 1.
+static constexpr uint8_t pulseClass(const uint32_t ticks) {
+  return (ticks < 2) ? 0 : (ticks > UINT16_MAX) ? kPulseClasses - 1
+      : 2 * msbPosition(ticks) + ((ticks >> (msbPosition(ticks) - 1)) & 1);
+}
+
+/// The classes a range of nominal durations could be measured in. i.e. Those
+/// covering the (very) generous window `_plausibleHeader()` allows around it.
+/// @param[in] low The shortest nominal duration. (uSeconds)
+/// @param[in] high The longest nominal duration. (uSeconds)
+/// @return A bit mask of the classes. e.g. Bit `n` for class `n`.
+static constexpr uint32_t pulseClassesNear(const uint32_t low,
+                                           const uint32_t high) {
+  return (UINT32_MAX << pulseClass(
+              (low > low * kDecodeIndexTolerance / 100 + kDecodeIndexDelta) ?
+              (low - low * kDecodeIndexTolerance / 100 - kDecodeIndexDelta) /
+                  kRawTick : 0)) &
+         (UINT32_MAX >> (kPulseClasses - 1 - pulseClass(
+              (high + high * kDecodeIndexTolerance / 100 + kDecodeIndexDelta) /
+                  kRawTick)));
+}
+#endif  // ENABLE_PULSE_CLASSIFICATION
+
+/// Try every (plausible) decoder on a capture, skipping up to `max_skip`
+/// leading pulse pairs. Doesn't try `decodeHash()`.
+/// @param[in,out] results Ptr to the data to decode & where to store the result.
+/// @param[in] max_skip Maximum Nr. of pulses at the begining of a capture we
+///   can skip when attempting to find a protocol we can successfully decode.
+/// @return A boolean. True if it can decode it, false if it can't.
+bool IRrecv::_tryDecoders(decode_results *results, const uint8_t max_skip) {
   // Reset any previously partially processed results.
   results->decode_type = UNKNOWN;
   results->bits = 0;
@@ -452,437 +1321,774 @@ bool IRrecv::decode(decode_results *results, irparams_t *save,
   results->address = 0;
   results->command = 0;
   results->repeat = false;
-
-#if ENABLE_NOISE_FILTER_OPTION
-  crudeNoiseFilter(results, noise_floor);
-#endif  // ENABLE_NOISE_FILTER_OPTION
+#if ENABLE_DECODE_SCORING
+  results->score = kNoScore;
+  for (uint8_t i = 0; i < kDecodeCandidates; i++) {
+    results->candidates[i].decode_type = UNKNOWN;
+    results->candidates[i].bits = 0;
+    results->candidates[i].score = kNoScore;
+  }
+  decode_results best;  // The best match so far, when looking for it.
+  bool found = false;
+#endif  // ENABLE_DECODE_SCORING
+
+  // Only use the index to rule out decoders when the tolerance is low enough
+  // that the index's window is guaranteed to be wider than the decoder's.
+  const bool use_index = _tolerance <= kDecodeIndexMaxTolerance;
+  const bool scan = use_index && _skip_scan;
   // Keep looking for protocols until we've run out of entries to skip or we
   // find a valid protocol message.
   for (uint16_t offset = kStartOffset;
        offset <= (max_skip * 2) + kStartOffset;
        offset += 2) {
+    // The leading mark & space (in uSeconds) at this offset, if we have them.
+    const uint32_t mark = (offset < results->rawlen) ?
+        results->rawbuf[offset] * kRawTick : 0;
+    const uint32_t space = (offset + 1 < results->rawlen) ?
+        results->rawbuf[offset + 1] * kRawTick : 0;
+#if ENABLE_PULSE_CLASSIFICATION
+    // Classify the leading mark once, for all the entries without a header.
+    const uint32_t lead = 1UL << pulseClass(mark / kRawTick);
+#endif  // ENABLE_PULSE_CLASSIFICATION
+    decode_index_t entry;
+    for (const decode_index_t *ptr = kDecodeIndex; ; ptr++) {
+      memcpy_P(&entry, ptr, sizeof(entry));
+      if (entry.type == (uint8_t)decode_type_t::UNKNOWN) break;  // The end.
+      if (use_index && !_plausibleHeader(&entry, mark, space)) continue;
+      // When scanning, only decode from skipped pulses that look like the
+      // header of a protocol. i.e. Never try the fallback entries there.
+      if (scan && offset > kStartOffset && !entry.hdrmark_max) continue;
+      const decode_type_t type = (decode_type_t)entry.type;
+#if ENABLE_PULSE_CLASSIFICATION
+      if (use_index && !entry.hdrmark_max && !_plausibleLead(type, lead))
+        continue;
+#endif  // ENABLE_PULSE_CLASSIFICATION
+#if ENABLE_DECODE_SCORING
+      _score_sum = 0;
+      _score_count = 0;
+#endif  // ENABLE_DECODE_SCORING
+      DPROFILE_TIMER(attempt_timer);
+      const bool matched = _decodeIndexed(type, results, offset);
+      DPROFILE_ATTEMPT(attempt_timer, type, matched);
+#if ENABLE_DECODE_SCORING
+      if (matched && _rankMatch(results, &best, found)) return true;
+      found |= matched;
+#else  // ENABLE_DECODE_SCORING
+      if (matched) return true;
+#endif  // ENABLE_DECODE_SCORING
+    }
+#if CUSTOM_PROTOCOL_SLOTS
+    for (uint8_t i = 0; i < CUSTOM_PROTOCOL_SLOTS && _protocols[i] != NULL;
+         i++) {
+#if ENABLE_DECODE_SCORING
+      _score_sum = 0;
+      _score_count = 0;
+      const bool matched = decodeGeneric(results, offset, _protocols[i],
+                                         _protocols[i]->bits);
+      if (matched && _rankMatch(results, &best, found)) return true;
+      found |= matched;
+#else  // ENABLE_DECODE_SCORING
+      if (decodeGeneric(results, offset, _protocols[i], _protocols[i]->bits))
+        return true;
+#endif  // ENABLE_DECODE_SCORING
+    }
+#endif  // CUSTOM_PROTOCOL_SLOTS
+#if ENABLE_DECODE_SCORING
+    if (found) {  // Report the best match at this offset.
+      *results = best;
+      return true;
+    }
+#endif  // ENABLE_DECODE_SCORING
+  }
+  return false;
+}
+
+#if ENABLE_DECODE_SCORING
+/// Record how far a measured period was from the nominal one it matched.
+/// @param[in] measured The recorded period. (uSeconds)
+/// @param[in] desired The nominal period it matched. (uSeconds)
+void IRrecv::_scoreTiming(const uint32_t measured, const uint32_t desired) {
+  if (desired == 0) return;  // Nothing sensible to compare against.
+  const uint32_t error = (measured > desired) ? measured - desired
+                                              : desired - measured;
+  _score_sum += error * 1000 / desired;
+  _score_count++;
+}
+
+/// Score a successful decoder attempt, & rank it against any earlier ones.
+/// @param[in,out] results The result of the attempt. Its score gets set.
+/// @param[in,out] best The best result (& runners-up) so far.
+/// @param[in] found Is there an earlier match in `best` to rank against?
+/// @return true if the attempt should be reported now. i.e. Not looking for
+///   the best match.
+bool IRrecv::_rankMatch(decode_results *results, decode_results *best,
+                        const bool found) {
+  results->score = (_score_count) ?
+      std::min(_score_sum / _score_count, (uint32_t)(kNoScore - 1)) : kNoScore;
+  if (!_best_match) return true;  // First match wins.
+  decode_candidate_t candidate;
+  if (!found) {
+    *best = *results;  // The first match. No runners-up yet.
+  } else {
+    if (results->score < best->score) {
+      // The new best. The previous best becomes a runner-up.
+      candidate.decode_type = best->decode_type;
+      candidate.bits = best->bits;
+      candidate.score = best->score;
+      decode_candidate_t runners_up[kDecodeCandidates];
+      for (uint8_t i = 0; i < kDecodeCandidates; i++)
+        runners_up[i] = best->candidates[i];
+      *best = *results;
+      for (uint8_t i = 0; i < kDecodeCandidates; i++)
+        best->candidates[i] = runners_up[i];
+    } else {
+      candidate.decode_type = results->decode_type;
+      candidate.bits = results->bits;
+      candidate.score = results->score;
+    }
+    // Insert it into the runners-up, in score order. Earlier entries win
+    // ties, as they would have without scoring.
+    for (uint8_t i = 0; i < kDecodeCandidates; i++) {
+      if (best->candidates[i].decode_type == UNKNOWN ||
+          candidate.score < best->candidates[i].score) {
+        for (uint8_t j = kDecodeCandidates - 1; j > i; j--)
+          best->candidates[j] = best->candidates[j - 1];
+        best->candidates[i] = candidate;
+        break;
+      }
+    }
+  }
+  // Reset the results for the next attempt.
+  results->decode_type = UNKNOWN;
+  results->bits = 0;
+  results->value = 0;
+  results->address = 0;
+  results->command = 0;
+  results->repeat = false;
+  return false;
+}
+#endif  // ENABLE_DECODE_SCORING
+
+/// Try to decode the message the interrupt handler is still capturing, rather
+/// than waiting for the capture timeout to end it.
+/// If the line has been quiet for at least the early decode gap, the pulses so
+/// far are decoded as if the message had ended. Only if a protocol matches
+/// (`UNKNOWN` messages always wait for the timeout) is the capture then ended
+/// early, exactly as if it had timed out, & the result reported.
+/// Each capture length is only tried once, so it is cheap to call repeatedly.
+/// @param[out] results A PTR to where the decoded IR message will be stored.
+/// @param[out] save A PTR to an irparams_t instance in which to save
+///   the interrupt's memory/state. NULL means don't save it.
+/// @param[in] max_skip Maximum Nr. of pulses at the begining of a capture we
+///   can skip when attempting to find a protocol we can successfully decode.
+/// @param[in] noise_floor Early decoding isn't done when this is non-zero, as
+///   the filter would modify the buffer the interrupt handler is using.
+/// @param[in] quiet Nr. of uSeconds since the last edge was captured.
+/// @return A boolean indicating if an IR message was decoded early or not.
+/// @see setEarlyDecodeGap()
+bool IRrecv::_decodeEarly(decode_results *results, irparams_t *save,
+                          const uint8_t max_skip, const uint16_t noise_floor,
+                          const uint32_t quiet) {
+  if (!_early_gap || noise_floor || quiet < _early_gap) return false;
+  const uint16_t rawlen = irparams.rawlen;
+  // We need the message to have ended on a mark, & be one we haven't tried.
+  if (rawlen <= kStartOffset || rawlen % 2 || rawlen >= irparams.bufsize ||
+      irparams.overflow || rawlen == _early_rawlen) return false;
+  _early_rawlen = rawlen;
+#if ENABLE_COMPACT_CAPTURE
+  // Unpack what we have so far. The interrupt handler doesn't use the capture
+  // buffer. Note: `compactlen` is updated before `rawlen` is, so it is safe.
+  irutils::expandRaw(irparams.compact, irparams.compactlen, irparams.rawbuf,
+                     rawlen);
+#endif  // ENABLE_COMPACT_CAPTURE
+  // Decode it in place. The interrupt handler only ever appends to it.
+  // Any entry it adds during this is ignored, as we've fixed the length.
+  results->rawbuf = irparams.rawbuf;
+  results->rawlen = rawlen;
+  results->overflow = false;
+  DPROFILE_TIMER(decode_timer);  // Time how long it takes to decode.
+  // Mark the end of the data, unless the next edge has just arrived.
+  // See `decode()` for why.
+  if (!_endCaptureEarly(rawlen, false) || !_tryDecoders(results, max_skip)) {
+    DPROFILE_CAPTURE(decode_timer);
+    return false;
+  }
+  DPROFILE_CAPTURE(decode_timer);
+  // It decoded, so end the capture there, if it still hasn't changed.
+  if (!_endCaptureEarly(rawlen, true)) return false;
+  _early_rawlen = 0;
+#if CAPTURE_RING_SLOTS
+  (void)save;  // Unused.
+  return popCapture(results);  // Hold on to the slot it was published to.
+#else  // CAPTURE_RING_SLOTS
+  if (save == NULL) save = irparams_save;
+  if (save != NULL) {
+    copyIrParams(&irparams, save);  // Duplicate the interrupt's memory.
+    resume();  // It's now safe to rearm. The IR message won't be overridden.
+    results->rawbuf = save->rawbuf;
+  } else if (ENABLE_COMPACT_CAPTURE) {
+    resume();  // The interrupt handler only uses the compact buffer.
+  }
+  return true;
+#endif  // CAPTURE_RING_SLOTS
+}
+
+/// Atomically check the interrupt handler hasn't captured anything more, and
+/// then either mark the end of the data, or end the capture.
+/// @param[in] rawlen The expected nr. of entries in the capture buffer.
+/// @param[in] end Do we end the capture (as the timeout would), or just mark
+///   the end of the data?
+/// @return A boolean. True if nothing more was captured, false if it was.
+bool IRrecv::_endCaptureEarly(const uint16_t rawlen, const bool end) {
+#ifndef UNIT_TEST
+#if defined(ESP8266)
+  os_intr_lock();
+#endif  // ESP8266
+#if defined(ESP32)
+  portENTER_CRITICAL(&irremote_mux);
+#endif  // ESP32
+#endif  // UNIT_TEST
+  const bool unchanged = (irparams.rawlen == rawlen);
+  if (unchanged) {
+    if (!end) {
+      irparams.rawbuf[rawlen] = 0;
+    } else {
+#if CAPTURE_RING_SLOTS
+      _ringPublish();
+#else  // CAPTURE_RING_SLOTS
+      irparams.rcvstate = kStopState;
+#endif  // CAPTURE_RING_SLOTS
+    }
+  }
+#ifndef UNIT_TEST
+#if defined(ESP8266)
+  os_intr_unlock();
+#endif  // ESP8266
+#if defined(ESP32)
+  portEXIT_CRITICAL(&irremote_mux);
+#endif  // ESP32
+#endif  // UNIT_TEST
+  return unchanged;
+}
+
+/// Attempt to decode the captured message with the decoder(s) for a protocol.
+/// @param[in] type The entry in the decoder dispatch index to attempt.
+/// @param[in,out] results Ptr to the data to decode & where to store the result.
+/// @param[in] offset The starting index to use when attempting to decode.
+/// @return A boolean. True if it can decode it, false if it can't.
+bool IRrecv::_decodeIndexed(const decode_type_t type, decode_results *results,
+                            const uint16_t offset) {
+  switch (type) {
 #if DECODE_AIWA_RC_T501
-    DPRINTLN("Attempting Aiwa RC T501 decode");
-    // Try decodeAiwaRCT501() before decodeSanyoLC7461() & decodeNEC()
-    // because the protocols are similar. This protocol is more specific than
-    // those ones, so should go before them.
-    if (decodeAiwaRCT501(results, offset)) return true;
+    case decode_type_t::AIWA_RC_T501:
+      DPRINTLN("Attempting Aiwa RC T501 decode");
+      return decodeAiwaRCT501(results, offset);
 #endif
 #if DECODE_SANYO
-    DPRINTLN("Attempting Sanyo LC7461 decode");
-    // Try decodeSanyoLC7461() before decodeNEC() because the protocols are
-    // similar in timings & structure, but the Sanyo one is much longer than the
-    // NEC protocol (42 vs 32 bits) so this one should be tried first to try to
-    // reduce false detection as a NEC packet.
-    if (decodeSanyoLC7461(results, offset)) return true;
+    case decode_type_t::SANYO_LC7461:
+      DPRINTLN("Attempting Sanyo LC7461 decode");
+      return decodeSanyoLC7461(results, offset);
 #endif
 #if DECODE_CARRIER_AC
-    DPRINTLN("Attempting Carrier AC decode");
-    // Try decodeCarrierAC() before decodeNEC() because the protocols are
-    // similar in timings & structure, but the Carrier one is much longer than
-    // the NEC protocol (3x32 bits vs 1x32 bits) so this one should be tried
-    // first to try to reduce false detection as a NEC packet.
-    if (decodeCarrierAC(results, offset)) return true;
+    case decode_type_t::CARRIER_AC:
+      DPRINTLN("Attempting Carrier AC decode");
+      return decodeCarrierAC(results, offset);
 #endif
 #if DECODE_PIONEER
-    DPRINTLN("Attempting Pioneer decode");
-    // Try decodePioneer() before decodeNEC() because the protocols are
-    // similar in timings & structure, but the Pioneer one is much longer than
-    // the NEC protocol (2x32 bits vs 1x32 bits) so this one should be tried
-    // first to try to reduce false detection as a NEC packet.
-    if (decodePioneer(results, offset)) return true;
+    case decode_type_t::PIONEER:
+      DPRINTLN("Attempting Pioneer decode");
+      return decodePioneer(results, offset);
 #endif
 #if DECODE_EPSON
-  DPRINTLN("Attempting Epson decode");
-  // Try decodeEpson() before decodeNEC() because the protocols are
-  // similar in timings & structure, but the Epson one is much longer than the
-  // NEC protocol (3x32 identical bits vs 1x32 bits) so this one should be tried
-  // first to try to reduce false detection as a NEC packet.
-  if (decodeEpson(results, offset)) return true;
+    case decode_type_t::EPSON:
+      DPRINTLN("Attempting Epson decode");
+      return decodeEpson(results, offset);
 #endif
 #if DECODE_NEC
-    DPRINTLN("Attempting NEC decode");
-    if (decodeNEC(results, offset)) return true;
+    case decode_type_t::NEC:
+      DPRINTLN("Attempting NEC decode");
+      return decodeNEC(results, offset);
+    case decode_type_t::NEC_LIKE:
+      DPRINTLN("Attempting NEC (non-strict) decode");
+      if (decodeNEC(results, offset, kNECBits, false)) {
+        results->decode_type = NEC_LIKE;
+        return true;
+      }
+      return false;
 #endif
 #if DECODE_SONY
-    DPRINTLN("Attempting Sony decode");
-    if (decodeSony(results, offset)) return true;
+    case decode_type_t::SONY:
+      DPRINTLN("Attempting Sony decode");
+      return decodeSony(results, offset);
 #endif
 #if DECODE_MITSUBISHI
-    DPRINTLN("Attempting Mitsubishi decode");
-    if (decodeMitsubishi(results, offset)) return true;
+    case decode_type_t::MITSUBISHI:
+      DPRINTLN("Attempting Mitsubishi decode");
+      return decodeMitsubishi(results, offset);
 #endif
 #if DECODE_MITSUBISHI_AC
-    DPRINTLN("Attempting Mitsubishi AC decode");
-    if (decodeMitsubishiAC(results, offset)) return true;
+    case decode_type_t::MITSUBISHI_AC:
+      DPRINTLN("Attempting Mitsubishi AC decode");
+      return decodeMitsubishiAC(results, offset);
 #endif
 #if DECODE_MITSUBISHI2
-    DPRINTLN("Attempting Mitsubishi2 decode");
-    if (decodeMitsubishi2(results, offset)) return true;
+    case decode_type_t::MITSUBISHI2:
+      DPRINTLN("Attempting Mitsubishi2 decode");
+      return decodeMitsubishi2(results, offset);
 #endif
 #if DECODE_RC5
-    DPRINTLN("Attempting RC5 decode");
-    if (decodeRC5(results, offset)) return true;
+    case decode_type_t::RC5:
+      DPRINTLN("Attempting RC5 decode");
+      return decodeRC5(results, offset);
 #endif
 #if DECODE_RC6
-    DPRINTLN("Attempting RC6 decode");
-    if (decodeRC6(results, offset)) return true;
+    case decode_type_t::RC6:
+      DPRINTLN("Attempting RC6 decode");
+      return decodeRC6(results, offset);
 #endif
 #if DECODE_RCMM
-    DPRINTLN("Attempting RC-MM decode");
-    if (decodeRCMM(results, offset)) return true;
+    case decode_type_t::RCMM:
+      DPRINTLN("Attempting RC-MM decode");
+      return decodeRCMM(results, offset);
 #endif
 #if DECODE_FUJITSU_AC
-    // Fujitsu A/C needs to precede Panasonic and Denon as it has a short
-    // message which looks exactly the same as a Panasonic/Denon message.
-    DPRINTLN("Attempting Fujitsu A/C decode");
-    if (decodeFujitsuAC(results, offset)) return true;
+    case decode_type_t::FUJITSU_AC:
+      DPRINTLN("Attempting Fujitsu A/C decode");
+      return decodeFujitsuAC(results, offset);
 #endif
 #if DECODE_DENON
-    // Denon needs to precede Panasonic as it is a special case of Panasonic.
-    DPRINTLN("Attempting Denon decode");
-    if (decodeDenon(results, offset, kDenon48Bits) ||
-        decodeDenon(results, offset, kDenonBits) ||
-        decodeDenon(results, offset, kDenonLegacyBits))
-      return true;
+    case decode_type_t::DENON:
+      DPRINTLN("Attempting Denon decode");
+      return decodeDenon(results, offset, kDenon48Bits) ||
+             decodeDenon(results, offset, kDenonBits) ||
+             decodeDenon(results, offset, kDenonLegacyBits);
 #endif
 #if DECODE_PANASONIC
-    DPRINTLN("Attempting Panasonic decode");
-    if (decodePanasonic(results, offset)) return true;
+    case decode_type_t::PANASONIC:
+      DPRINTLN("Attempting Panasonic decode");
+      return decodePanasonic(results, offset);
 #endif
 #if DECODE_LG
-    DPRINTLN("Attempting LG (28-bit) decode");
-    if (decodeLG(results, offset, kLgBits, true)) return true;
-    DPRINTLN("Attempting LG (32-bit) decode");
-    // LG32 should be tried before Samsung
-    if (decodeLG(results, offset, kLg32Bits, true)) return true;
+    case decode_type_t::LG:
+      DPRINTLN("Attempting LG (28-bit) decode");
+      if (decodeLG(results, offset, kLgBits, true)) return true;
+      DPRINTLN("Attempting LG (32-bit) decode");
+      // LG32 should be tried before Samsung
+      return decodeLG(results, offset, kLg32Bits, true);
 #endif
 #if DECODE_GICABLE
-    // Note: Needs to happen before JVC decode, because it looks similar except
-    //       with a required NEC-like repeat code.
-    DPRINTLN("Attempting GICable decode");
-    if (decodeGICable(results, offset)) return true;
+    case decode_type_t::GICABLE:
+      DPRINTLN("Attempting GICable decode");
+      return decodeGICable(results, offset);
 #endif
 #if DECODE_JVC
-    DPRINTLN("Attempting JVC decode");
-    if (decodeJVC(results, offset)) return true;
+    case decode_type_t::JVC:
+      DPRINTLN("Attempting JVC decode");
+      return decodeJVC(results, offset);
 #endif
 #if DECODE_SAMSUNG
-    DPRINTLN("Attempting SAMSUNG decode");
-    if (decodeSAMSUNG(results, offset)) return true;
+    case decode_type_t::SAMSUNG:
+      DPRINTLN("Attempting SAMSUNG decode");
+      return decodeSAMSUNG(results, offset);
 #endif
 #if DECODE_SAMSUNG36
-    DPRINTLN("Attempting Samsung36 decode");
-    if (decodeSamsung36(results, offset)) return true;
+    case decode_type_t::SAMSUNG36:
+      DPRINTLN("Attempting Samsung36 decode");
+      return decodeSamsung36(results, offset);
 #endif
 #if DECODE_WHYNTER
-    DPRINTLN("Attempting Whynter decode");
-    if (decodeWhynter(results, offset)) return true;
+    case decode_type_t::WHYNTER:
+      DPRINTLN("Attempting Whynter decode");
+      return decodeWhynter(results, offset);
 #endif
 #if DECODE_DISH
-    DPRINTLN("Attempting DISH decode");
-    if (decodeDISH(results, offset)) return true;
+    case decode_type_t::DISH:
+      DPRINTLN("Attempting DISH decode");
+      return decodeDISH(results, offset);
 #endif
 #if DECODE_SHARP
-    DPRINTLN("Attempting Sharp decode");
-    if (decodeSharp(results, offset)) return true;
+    case decode_type_t::SHARP:
+      DPRINTLN("Attempting Sharp decode");
+      return decodeSharp(results, offset);
 #endif
 #if DECODE_COOLIX
-    DPRINTLN("Attempting Coolix decode");
-    if (decodeCOOLIX(results, offset)) return true;
+    case decode_type_t::COOLIX:
+      DPRINTLN("Attempting Coolix decode");
+      return decodeCOOLIX(results, offset);
 #endif
 #if DECODE_NIKAI
-    DPRINTLN("Attempting Nikai decode");
-    if (decodeNikai(results, offset)) return true;
+    case decode_type_t::NIKAI:
+      DPRINTLN("Attempting Nikai decode");
+      return decodeNikai(results, offset);
 #endif
 #if DECODE_KELVINATOR
-    // Kelvinator based-devices use a similar code to Gree ones, to avoid false
-    // matches this needs to happen before decodeGree().
-    DPRINTLN("Attempting Kelvinator decode");
-    if (decodeKelvinator(results, offset)) return true;
+    case decode_type_t::KELVINATOR:
+      DPRINTLN("Attempting Kelvinator decode");
+      return decodeKelvinator(results, offset);
 #endif
 #if DECODE_DAIKIN
-    DPRINTLN("Attempting Daikin decode");
-    if (decodeDaikin(results, offset)) return true;
+    case decode_type_t::DAIKIN:
+      DPRINTLN("Attempting Daikin decode");
+      return decodeDaikin(results, offset);
 #endif
 #if DECODE_DAIKIN2
-    DPRINTLN("Attempting Daikin2 decode");
-    if (decodeDaikin2(results, offset)) return true;
+    case decode_type_t::DAIKIN2:
+      DPRINTLN("Attempting Daikin2 decode");
+      return decodeDaikin2(results, offset);
 #endif
 #if DECODE_DAIKIN216
-    DPRINTLN("Attempting Daikin216 decode");
-    if (decodeDaikin216(results, offset)) return true;
+    case decode_type_t::DAIKIN216:
+      DPRINTLN("Attempting Daikin216 decode");
+      return decodeDaikin216(results, offset);
 #endif
 #if DECODE_TOSHIBA_AC
-    DPRINTLN("Attempting Toshiba AC 72bit decode");
-    if (decodeToshibaAC(results, offset)) return true;
-    DPRINTLN("Attempting Toshiba AC 80bit decode");
-    if (decodeToshibaAC(results, offset, kToshibaACBitsLong)) return true;
-    DPRINTLN("Attempting Toshiba AC 56bit decode");
-    if (decodeToshibaAC(results, offset, kToshibaACBitsShort)) return true;
+    case decode_type_t::TOSHIBA_AC:
+      DPRINTLN("Attempting Toshiba AC 72bit decode");
+      if (decodeToshibaAC(results, offset)) return true;
+      DPRINTLN("Attempting Toshiba AC 80bit decode");
+      if (decodeToshibaAC(results, offset, kToshibaACBitsLong)) return true;
+      DPRINTLN("Attempting Toshiba AC 56bit decode");
+      return decodeToshibaAC(results, offset, kToshibaACBitsShort);
 #endif
 #if DECODE_MIDEA
-    DPRINTLN("Attempting Midea decode");
-    if (decodeMidea(results, offset)) return true;
+    case decode_type_t::MIDEA:
+      DPRINTLN("Attempting Midea decode");
+      return decodeMidea(results, offset);
 #endif
 #if DECODE_MAGIQUEST
-    DPRINTLN("Attempting Magiquest decode");
-    if (decodeMagiQuest(results, offset)) return true;
-#endif
-  /* NOTE: Disabled due to poor quality.
-#if DECODE_SANYO
-    // The Sanyo S866500B decoder is very poor quality & depricated.
-    // *IF* you are going to enable it, do it near last to avoid false positive
-    // matches.
-    DPRINTLN("Attempting Sanyo SA8650B decode");
-    if (decodeSanyo(results, offset))
-      return true;
-#endif
-  */
-#if DECODE_NEC
-    // Some devices send NEC-like codes that don't follow the true NEC spec.
-    // This should detect those. e.g. Apple TV remote etc.
-    // This needs to be done after all other codes that use strict and some
-    // other protocols that are NEC-like as well, as turning off strict may
-    // cause this to match other valid protocols.
-    DPRINTLN("Attempting NEC (non-strict) decode");
-    if (decodeNEC(results, offset, kNECBits, false)) {
-      results->decode_type = NEC_LIKE;
-      return true;
-    }
+    case decode_type_t::MAGIQUEST:
+      DPRINTLN("Attempting Magiquest decode");
+      return decodeMagiQuest(results, offset);
 #endif
 #if DECODE_LASERTAG
-    DPRINTLN("Attempting Lasertag decode");
-    if (decodeLasertag(results, offset)) return true;
+    case decode_type_t::LASERTAG:
+      DPRINTLN("Attempting Lasertag decode");
+      return decodeLasertag(results, offset);
 #endif
 #if DECODE_GREE
-    // Gree based-devices use a similar code to Kelvinator ones, to avoid false
-    // matches this needs to happen after decodeKelvinator().
-    DPRINTLN("Attempting Gree decode");
-    if (decodeGree(results, offset)) return true;
+    case decode_type_t::GREE:
+      DPRINTLN("Attempting Gree decode");
+      return decodeGree(results, offset);
 #endif
 #if DECODE_HAIER_AC
-    DPRINTLN("Attempting Haier AC decode");
-    if (decodeHaierAC(results, offset)) return true;
+    case decode_type_t::HAIER_AC:
+      DPRINTLN("Attempting Haier AC decode");
+      return decodeHaierAC(results, offset);
 #endif
 #if DECODE_HAIER_AC_YRW02
-    DPRINTLN("Attempting Haier AC YR-W02 decode");
-    if (decodeHaierACYRW02(results, offset)) return true;
+    case decode_type_t::HAIER_AC_YRW02:
+      DPRINTLN("Attempting Haier AC YR-W02 decode");
+      return decodeHaierACYRW02(results, offset);
 #endif
 #if DECODE_HITACHI_AC424
-    // HitachiAc424 should be checked before HitachiAC, HitachiAC2,
-    // & HitachiAC184
-    DPRINTLN("Attempting Hitachi AC 424 decode");
-    if (decodeHitachiAc424(results, offset, kHitachiAc424Bits)) return true;
+    case decode_type_t::HITACHI_AC424:
+      DPRINTLN("Attempting Hitachi AC 424 decode");
+      return decodeHitachiAc424(results, offset, kHitachiAc424Bits);
 #endif  // DECODE_HITACHI_AC424
 #if DECODE_MITSUBISHI136
-    // Needs to happen before HitachiAc3 decode.
-    DPRINTLN("Attempting Mitsubishi136 decode");
-    if (decodeMitsubishi136(results, offset)) return true;
+    case decode_type_t::MITSUBISHI136:
+      DPRINTLN("Attempting Mitsubishi136 decode");
+      return decodeMitsubishi136(results, offset);
 #endif  // DECODE_MITSUBISHI136
 #if DECODE_HITACHI_AC3
-    // HitachiAc3 should be checked before HitachiAC & HitachiAC2
-    // Attempt normal before the short version.
-    DPRINTLN("Attempting Hitachi AC3 decode");
-    // Order these in decreasing bit size, as it is more optimal.
-    if (decodeHitachiAc3(results, offset, kHitachiAc3Bits) ||
-        decodeHitachiAc3(results, offset, kHitachiAc3Bits - 4 * 8) ||
-        decodeHitachiAc3(results, offset, kHitachiAc3Bits - 6 * 8) ||
-        decodeHitachiAc3(results, offset, kHitachiAc3MinBits + 2 * 8) ||
-        decodeHitachiAc3(results, offset, kHitachiAc3MinBits))
-      return true;
+    case decode_type_t::HITACHI_AC3:
+      // Attempt normal before the short version.
+      DPRINTLN("Attempting Hitachi AC3 decode");
+      // Order these in decreasing bit size, as it is more optimal.
+      return decodeHitachiAc3(results, offset, kHitachiAc3Bits) ||
+             decodeHitachiAc3(results, offset, kHitachiAc3Bits - 4 * 8) ||
+             decodeHitachiAc3(results, offset, kHitachiAc3Bits - 6 * 8) ||
+             decodeHitachiAc3(results, offset, kHitachiAc3MinBits + 2 * 8) ||
+             decodeHitachiAc3(results, offset, kHitachiAc3MinBits);
 #endif  // DECODE_HITACHI_AC3
 #if DECODE_HITACHI_AC344
-    // HitachiAC344 should be checked before HitachiAC
-    DPRINTLN("Attempting Hitachi AC344 decode");
-    if (decodeHitachiAC(results, offset, kHitachiAc344Bits, true, false))
-      return true;
+    case decode_type_t::HITACHI_AC344:
+      DPRINTLN("Attempting Hitachi AC344 decode");
+      return decodeHitachiAC(results, offset, kHitachiAc344Bits, true, false);
 #endif  // DECODE_HITACHI_AC344
 #if DECODE_HITACHI_AC2
-    // HitachiAC2 should be checked before HitachiAC
-    DPRINTLN("Attempting Hitachi AC2 decode");
-    if (decodeHitachiAC(results, offset, kHitachiAc2Bits)) return true;
+    case decode_type_t::HITACHI_AC2:
+      DPRINTLN("Attempting Hitachi AC2 decode");
+      return decodeHitachiAC(results, offset, kHitachiAc2Bits);
 #endif  // DECODE_HITACHI_AC2
 #if DECODE_HITACHI_AC
-    DPRINTLN("Attempting Hitachi AC decode");
-    if (decodeHitachiAC(results, offset, kHitachiAcBits)) return true;
+    case decode_type_t::HITACHI_AC:
+      DPRINTLN("Attempting Hitachi AC decode");
+      return decodeHitachiAC(results, offset, kHitachiAcBits);
 #endif
 #if DECODE_HITACHI_AC1
-    DPRINTLN("Attempting Hitachi AC1 decode");
-    if (decodeHitachiAC(results, offset, kHitachiAc1Bits)) return true;
+    case decode_type_t::HITACHI_AC1:
+      DPRINTLN("Attempting Hitachi AC1 decode");
+      return decodeHitachiAC(results, offset, kHitachiAc1Bits);
 #endif
 #if DECODE_WHIRLPOOL_AC
-    DPRINTLN("Attempting Whirlpool AC decode");
-    if (decodeWhirlpoolAC(results, offset)) return true;
+    case decode_type_t::WHIRLPOOL_AC:
+      DPRINTLN("Attempting Whirlpool AC decode");
+      return decodeWhirlpoolAC(results, offset);
 #endif
 #if DECODE_SAMSUNG_AC
-    DPRINTLN("Attempting Samsung AC (extended) decode");
-    // Check the extended size first, as it should fail fast due to longer
-    // length.
-    if (decodeSamsungAC(results, offset, kSamsungAcExtendedBits, false))
-      return true;
-    // Now check for the more common length.
-    DPRINTLN("Attempting Samsung AC decode");
-    if (decodeSamsungAC(results, offset, kSamsungAcBits)) return true;
+    case decode_type_t::SAMSUNG_AC:
+      DPRINTLN("Attempting Samsung AC (extended) decode");
+      // Check the extended size first, as it should fail fast due to longer
+      // length.
+      if (decodeSamsungAC(results, offset, kSamsungAcExtendedBits, false))
+        return true;
+      // Now check for the more common length.
+      DPRINTLN("Attempting Samsung AC decode");
+      return decodeSamsungAC(results, offset, kSamsungAcBits);
 #endif
 #if DECODE_ELECTRA_AC
-    DPRINTLN("Attempting Electra AC decode");
-    if (decodeElectraAC(results, offset)) return true;
+    case decode_type_t::ELECTRA_AC:
+      DPRINTLN("Attempting Electra AC decode");
+      return decodeElectraAC(results, offset);
 #endif
 #if DECODE_PANASONIC_AC
-    DPRINTLN("Attempting Panasonic AC decode");
-    if (decodePanasonicAC(results, offset)) return true;
-    DPRINTLN("Attempting Panasonic AC short decode");
-    if (decodePanasonicAC(results, offset, kPanasonicAcShortBits)) return true;
+    case decode_type_t::PANASONIC_AC:
+      DPRINTLN("Attempting Panasonic AC decode");
+      if (decodePanasonicAC(results, offset)) return true;
+      DPRINTLN("Attempting Panasonic AC short decode");
+      return decodePanasonicAC(results, offset, kPanasonicAcShortBits);
 #endif
 #if DECODE_LUTRON
-    DPRINTLN("Attempting Lutron decode");
-    if (decodeLutron(results, offset)) return true;
+    case decode_type_t::LUTRON:
+      DPRINTLN("Attempting Lutron decode");
+      return decodeLutron(results, offset);
 #endif
 #if DECODE_MWM
-    DPRINTLN("Attempting MWM decode");
-    if (decodeMWM(results, offset)) return true;
+    case decode_type_t::MWM:
+      DPRINTLN("Attempting MWM decode");
+      return decodeMWM(results, offset);
 #endif
 #if DECODE_VESTEL_AC
-    DPRINTLN("Attempting Vestel AC decode");
-    if (decodeVestelAc(results, offset)) return true;
+    case decode_type_t::VESTEL_AC:
+      DPRINTLN("Attempting Vestel AC decode");
+      return decodeVestelAc(results, offset);
 #endif
 #if DECODE_MITSUBISHI112 || DECODE_TCL112AC
-    // Mitsubish112 and Tcl112 share the same decoder.
-    DPRINTLN("Attempting Mitsubishi112/TCL112AC decode");
-    if (decodeMitsubishi112(results, offset)) return true;
+    case decode_type_t::MITSUBISHI112:
+      DPRINTLN("Attempting Mitsubishi112/TCL112AC decode");
+      return decodeMitsubishi112(results, offset);
 #endif  // DECODE_MITSUBISHI112 || DECODE_TCL112AC
 #if DECODE_TECO
-    DPRINTLN("Attempting Teco decode");
-    if (decodeTeco(results, offset)) return true;
+    case decode_type_t::TECO:
+      DPRINTLN("Attempting Teco decode");
+      return decodeTeco(results, offset);
 #endif
 #if DECODE_LEGOPF
-    DPRINTLN("Attempting LEGOPF decode");
-    if (decodeLegoPf(results, offset)) return true;
+    case decode_type_t::LEGOPF:
+      DPRINTLN("Attempting LEGOPF decode");
+      return decodeLegoPf(results, offset);
 #endif
 #if DECODE_MITSUBISHIHEAVY
-    DPRINTLN("Attempting MITSUBISHIHEAVY (152 bit) decode");
-    if (decodeMitsubishiHeavy(results, offset, kMitsubishiHeavy152Bits))
-      return true;
-    DPRINTLN("Attempting MITSUBISHIHEAVY (88 bit) decode");
-    if (decodeMitsubishiHeavy(results, offset, kMitsubishiHeavy88Bits))
-      return true;
+    case decode_type_t::MITSUBISHI_HEAVY_152:
+      DPRINTLN("Attempting MITSUBISHIHEAVY (152 bit) decode");
+      if (decodeMitsubishiHeavy(results, offset, kMitsubishiHeavy152Bits))
+        return true;
+      DPRINTLN("Attempting MITSUBISHIHEAVY (88 bit) decode");
+      return decodeMitsubishiHeavy(results, offset, kMitsubishiHeavy88Bits);
 #endif
 #if DECODE_ARGO
-    DPRINTLN("Attempting Argo decode");
-    if (decodeArgo(results, offset)) return true;
+    case decode_type_t::ARGO:
+      DPRINTLN("Attempting Argo decode");
+      return decodeArgo(results, offset);
 #endif  // DECODE_ARGO
 #if DECODE_SHARP_AC
-    DPRINTLN("Attempting SHARP_AC decode");
-    if (decodeSharpAc(results, offset)) return true;
+    case decode_type_t::SHARP_AC:
+      DPRINTLN("Attempting SHARP_AC decode");
+      return decodeSharpAc(results, offset);
 #endif
 #if DECODE_GOODWEATHER
-    DPRINTLN("Attempting GOODWEATHER decode");
-    if (decodeGoodweather(results, offset)) return true;
+    case decode_type_t::GOODWEATHER:
+      DPRINTLN("Attempting GOODWEATHER decode");
+      return decodeGoodweather(results, offset);
 #endif  // DECODE_GOODWEATHER
 #if DECODE_INAX
-    DPRINTLN("Attempting Inax decode");
-    if (decodeInax(results, offset)) return true;
+    case decode_type_t::INAX:
+      DPRINTLN("Attempting Inax decode");
+      return decodeInax(results, offset);
 #endif  // DECODE_INAX
 #if DECODE_TROTEC
-    DPRINTLN("Attempting Trotec decode");
-    if (decodeTrotec(results, offset)) return true;
+    case decode_type_t::TROTEC:
+      DPRINTLN("Attempting Trotec decode");
+      return decodeTrotec(results, offset);
 #endif  // DECODE_TROTEC
 #if DECODE_DAIKIN160
-    DPRINTLN("Attempting Daikin160 decode");
-    if (decodeDaikin160(results, offset)) return true;
+    case decode_type_t::DAIKIN160:
+      DPRINTLN("Attempting Daikin160 decode");
+      return decodeDaikin160(results, offset);
 #endif  // DECODE_DAIKIN160
 #if DECODE_SOLEUS
-    DPRINTLN("Attempting Soleus decode");
-    if (decodeSoleus(results, offset)) return true;
+    case decode_type_t::SOLEUS:
+      DPRINTLN("Attempting Soleus decode");
+      return decodeSoleus(results, offset);
 #endif  // DECODE_SOLEUS
 #if DECODE_DAIKIN176
-    DPRINTLN("Attempting Daikin176 decode");
-    if (decodeDaikin176(results, offset)) return true;
+    case decode_type_t::DAIKIN176:
+      DPRINTLN("Attempting Daikin176 decode");
+      return decodeDaikin176(results, offset);
 #endif  // DECODE_DAIKIN176
 #if DECODE_DAIKIN128
-    DPRINTLN("Attempting Daikin128 decode");
-    if (decodeDaikin128(results, offset)) return true;
+    case decode_type_t::DAIKIN128:
+      DPRINTLN("Attempting Daikin128 decode");
+      return decodeDaikin128(results, offset);
 #endif  // DECODE_DAIKIN128
 #if DECODE_AMCOR
-    DPRINTLN("Attempting Amcor decode");
-    if (decodeAmcor(results, offset)) return true;
+    case decode_type_t::AMCOR:
+      DPRINTLN("Attempting Amcor decode");
+      return decodeAmcor(results, offset);
 #endif  // DECODE_AMCOR
 #if DECODE_DAIKIN152
-    DPRINTLN("Attempting Daikin152 decode");
-    if (decodeDaikin152(results, offset)) return true;
+    case decode_type_t::DAIKIN152:
+      DPRINTLN("Attempting Daikin152 decode");
+      return decodeDaikin152(results, offset);
 #endif  // DECODE_DAIKIN152
 #if DECODE_SYMPHONY
-    DPRINTLN("Attempting Symphony decode");
-    if (decodeSymphony(results, offset)) return true;
+    case decode_type_t::SYMPHONY:
+      DPRINTLN("Attempting Symphony decode");
+      return decodeSymphony(results, offset);
 #endif  // DECODE_SYMPHONY
 #if DECODE_DAIKIN64
-    DPRINTLN("Attempting Daikin64 decode");
-    if (decodeDaikin64(results, offset)) return true;
+    case decode_type_t::DAIKIN64:
+      DPRINTLN("Attempting Daikin64 decode");
+      return decodeDaikin64(results, offset);
 #endif  // DECODE_DAIKIN64
 #if DECODE_AIRWELL
-    DPRINTLN("Attempting Airwell decode");
-    if (decodeAirwell(results, offset)) return true;
+    case decode_type_t::AIRWELL:
+      DPRINTLN("Attempting Airwell decode");
+      return decodeAirwell(results, offset);
 #endif  // DECODE_AIRWELL
 #if DECODE_DELONGHI_AC
-    DPRINTLN("Attempting Delonghi AC decode");
-    if (decodeDelonghiAc(results, offset)) return true;
+    case decode_type_t::DELONGHI_AC:
+      DPRINTLN("Attempting Delonghi AC decode");
+      return decodeDelonghiAc(results, offset);
 #endif  // DECODE_DELONGHI_AC
 #if DECODE_DOSHISHA
-    DPRINTLN("Attempting Doshisha decode");
-    if (decodeDoshisha(results, offset)) return true;
+    case decode_type_t::DOSHISHA:
+      DPRINTLN("Attempting Doshisha decode");
+      return decodeDoshisha(results, offset);
 #endif  // DECODE_DOSHISHA
 #if DECODE_MULTIBRACKETS
-    DPRINTLN("Attempting Multibrackets decode");
-    if (decodeMultibrackets(results, offset)) return true;
+    case decode_type_t::MULTIBRACKETS:
+      DPRINTLN("Attempting Multibrackets decode");
+      return decodeMultibrackets(results, offset);
 #endif  // DECODE_MULTIBRACKETS
 #if DECODE_CARRIER_AC40
-    DPRINTLN("Attempting Carrier 40bit decode");
-    if (decodeCarrierAC40(results, offset)) return true;
+    case decode_type_t::CARRIER_AC40:
+      DPRINTLN("Attempting Carrier 40bit decode");
+      return decodeCarrierAC40(results, offset);
 #endif  // DECODE_CARRIER_AC40
 #if DECODE_CARRIER_AC64
-    DPRINTLN("Attempting Carrier 64bit decode");
-    if (decodeCarrierAC64(results, offset)) return true;
+    case decode_type_t::CARRIER_AC64:
+      DPRINTLN("Attempting Carrier 64bit decode");
+      return decodeCarrierAC64(results, offset);
 #endif  // DECODE_CARRIER_AC64
 #if DECODE_CORONA_AC
-    DPRINTLN("Attempting CoronaAc decode");
-    if (decodeCoronaAc(results, offset)) return true;
+    case decode_type_t::CORONA_AC:
+      DPRINTLN("Attempting CoronaAc decode");
+      return decodeCoronaAc(results, offset);
 #endif  // DECODE_CORONA_AC
 #if DECODE_MIDEA24
-    DPRINTLN("Attempting Midea-Nec decode");
-    if (decodeMidea24(results, offset)) return true;
+    case decode_type_t::MIDEA24:
+      DPRINTLN("Attempting Midea-Nec decode");
+      return decodeMidea24(results, offset);
 #endif  // DECODE_MIDEA24
 #if DECODE_ZEPEAL
-    DPRINTLN("Attempting Zepeal decode");
-    if (decodeZepeal(results, offset)) return true;
+    case decode_type_t::ZEPEAL:
+      DPRINTLN("Attempting Zepeal decode");
+      return decodeZepeal(results, offset);
 #endif  // DECODE_ZEPEAL
 #if DECODE_SANYO_AC
-    DPRINTLN("Attempting Sanyo AC decode");
-    if (decodeSanyoAc(results, offset)) return true;
+    case decode_type_t::SANYO_AC:
+      DPRINTLN("Attempting Sanyo AC decode");
+      return decodeSanyoAc(results, offset);
 #endif  // DECODE_SANYO_AC
 #if DECODE_VOLTAS
-  DPRINTLN("Attempting Voltas decode");
-  if (decodeVoltas(results)) return true;
+    case decode_type_t::VOLTAS:
+      DPRINTLN("Attempting Voltas decode");
+      return decodeVoltas(results);
 #endif  // DECODE_VOLTAS
 #if DECODE_METZ
-    DPRINTLN("Attempting Metz decode");
-    if (decodeMetz(results, offset)) return true;
+    case decode_type_t::METZ:
+      DPRINTLN("Attempting Metz decode");
+      return decodeMetz(results, offset);
 #endif  // DECODE_METZ
-  // Typically new protocols are added above this line.
+    default:
+      return false;
   }
-#if DECODE_HASH
-  // decodeHash returns a hash on any input.
-  // Thus, it needs to be last in the list.
-  // If you add any decodes, add them before this.
-  if (decodeHash(results)) {
-    return true;
+}
+
+/// Is the start of the captured message possibly a match for an index entry?
+/// i.e. Are the leading mark & space within a (very) generous window of what
+/// the protocol expects. This is used to cheaply rule out decoders before we
+/// try them, so it must never reject something the decoder would accept.
+/// @param[in] entry The decoder dispatch index entry to check against.
+/// @param[in] mark The measured leading mark in uSeconds.
+/// @param[in] space The measured leading space in uSeconds.
+/// @return A boolean. True if the decoder should be attempted, false if not.
+bool IRrecv::_plausibleHeader(const decode_index_t *entry,
+                              const uint32_t mark, const uint32_t space) {
+  if (entry->hdrmark_max == 0) return true;  // No usable header to check.
+  // Integer only. i.e. No floating point maths. This is called a lot.
+  // Note: The lower bounds are tested by adding the slack to the measured
+  //       value, so they can't underflow.
+  const uint32_t markmin = entry->hdrmark_min;
+  const uint32_t markmax = entry->hdrmark_max;
+  const uint32_t spacemin = entry->hdrspace_min;
+  const uint32_t spacemax = entry->hdrspace_max;
+  return (mark + markmin * kDecodeIndexTolerance / 100 + kDecodeIndexDelta >=
+          markmin) &&
+         (mark <= markmax + markmax * kDecodeIndexTolerance / 100 +
+          kDecodeIndexDelta) &&
+         (space + spacemin * kDecodeIndexTolerance / 100 + kDecodeIndexDelta >=
+          spacemin) &&
+         (space <= spacemax + spacemax * kDecodeIndexTolerance / 100 +
+          kDecodeIndexDelta);
+}
+
+#if ENABLE_PULSE_CLASSIFICATION
+/// Could a decoder without a usable header match a capture, given the class of
+/// its leading mark? i.e. Could any of the marks the protocol can start with
+/// (e.g. a header mark, or a data bit mark) be measured in that class, with
+/// the same (very) generous window as `_plausibleHeader()` uses.
+/// Like it, this must never reject something the decoder would accept.
+/// @param[in] type The protocol of the decoder.
+/// @param[in] lead The class of the leading mark, as a bit mask.
+///   i.e. `1 << pulseClass(ticks)`
+/// @return A boolean. True if the decoder should be attempted, false if not.
+bool IRrecv::_plausibleLead(const decode_type_t type, const uint32_t lead) {
+  // Note: The classes are all worked out at compile time.
+  switch (type) {
+    case decode_type_t::DENON:  // Sharp style, or a Panasonic or legacy header.
+      return lead & (pulseClassesNear(260, 263) | pulseClassesNear(3456, 3456));
+    case decode_type_t::SHARP:
+      return lead & pulseClassesNear(260, 260);
+    case decode_type_t::JVC:  // A header, or a data bit mark for repeats.
+      return lead & (pulseClassesNear(8400, 8400) | pulseClassesNear(525, 525));
+    case decode_type_t::DAIKIN:  // A data bit mark of the preamble.
+      return lead & pulseClassesNear(428, 428);
+    case decode_type_t::DAIKIN152:  // A data bit mark of the leader.
+      return lead & pulseClassesNear(433, 433);
+    case decode_type_t::SYMPHONY:  // A zero or a one data bit mark.
+      return lead & pulseClassesNear(400, 1250);
+    case decode_type_t::AIRWELL:  // A header, maybe with a half period merged.
+      return lead & pulseClassesNear(2850, 2850 + 950);
+    // Manchester encoded. A mark of one or two half clock periods.
+    case decode_type_t::LASERTAG:
+      return lead & pulseClassesNear(333, 2 * 333);
+    case decode_type_t::RC5:
+      return lead & pulseClassesNear(889, 2 * 889);
+    case decode_type_t::MWM:  // Up to kMWMMaxWidth (9) ticks.
+      return lead & pulseClassesNear(417, 9 * 417);
+    // Not checked. e.g. Voltas ignores the offset, MagiQuest only matches the
+    // ratio of each mark to its space, & Lutron & Multibrackets use
+    // `matchAtLeast()`, which also accepts an empty mark, & is capped by the
+    // capture timeout.
+    default:
+      return true;
   }
-#endif  // DECODE_HASH
-  // Throw away and start over
-  if (!resumed)  // Check if we have already resumed.
-    resume();
-  return false;
 }
+#endif  // ENABLE_PULSE_CLASSIFICATION
+
 
 /// Convert the tolerance percentage into something valid.
 /// @param[in] percentage An integer percentage.
@@ -895,12 +2101,15 @@ uint8_t IRrecv::_validTolerance(const uint8_t percentage) {
 /// @param[in] tolerance Percent as an integer. e.g. 10 is 10%
 /// @param[in] delta A non-scaling amount to reduce usecs by.
 /// @return Nr. of ticks.
+/// @note Integer maths only, as it is called a lot and the ESP8266 has no FPU.
 uint32_t IRrecv::ticksLow(const uint32_t usecs, const uint8_t tolerance,
                           const uint16_t delta) {
-  // max() used to ensure the result can't drop below 0 before the cast.
-  return ((uint32_t)std::max(
-      (int32_t)(usecs * (1.0 - _validTolerance(tolerance) / 100.0) - delta),
-      0));
+  const uint32_t percent = 100 - _validTolerance(tolerance);
+  // i.e. usecs * percent / 100, but without the chance of overflowing.
+  const uint32_t scaled = (usecs / 100) * percent +
+      (usecs % 100) * percent / 100;
+  // Ensure the result can't drop below 0.
+  return (scaled > delta) ? scaled - delta : 0;
 }
 
 /// Calculate the upper bound of the nr. of ticks.
@@ -908,10 +2117,41 @@ uint32_t IRrecv::ticksLow(const uint32_t usecs, const uint8_t tolerance,
 /// @param[in] tolerance Percent as an integer. e.g. 10 is 10%
 /// @param[in] delta A non-scaling amount to increase usecs by.
 /// @return Nr. of ticks.
+/// @note Integer maths only, as it is called a lot and the ESP8266 has no FPU.
 uint32_t IRrecv::ticksHigh(const uint32_t usecs, const uint8_t tolerance,
                            const uint16_t delta) {
-  return ((uint32_t)(usecs * (1.0 + _validTolerance(tolerance) / 100.0)) + 1 +
-          delta);
+  const uint32_t percent = 100 + _validTolerance(tolerance);
+  // i.e. usecs * percent / 100, but without the chance of overflowing.
+  return (usecs / 100) * percent + (usecs % 100) * percent / 100 + 1 + delta;
+}
+
+/// Calculate the window of capture buffer values that match a desired period.
+/// i.e. Do the tolerance calculations once, so a value can be checked against
+///   it many times with `matchWindow()` with only a pair of comparisons.
+/// @param[in] desired The expected period (in usecs) we are matching against.
+/// @param[in] tolerance A percentage expressed as an integer. e.g. 10 is 10%.
+/// @param[in] delta A non-scaling (+/-) error margin (in useconds).
+/// @return The window, in capture buffer (kRawTick) units.
+match_window_t IRrecv::tickWindow(const uint32_t desired,
+                                  const uint8_t tolerance,
+                                  const uint16_t delta) {
+  match_window_t window;
+  // Round the lower bound up, & the upper down, so the result is identical to
+  // comparing the value after it has been converted to uSeconds.
+  window.low = (ticksLow(desired, tolerance, delta) + kRawTick - 1) / kRawTick;
+  window.high = ticksHigh(desired, tolerance, delta) / kRawTick;
+#if ENABLE_DECODE_SCORING
+  window.desired = desired;
+#endif  // ENABLE_DECODE_SCORING
+  return window;
+}
+
+/// Check if a capture buffer value is within a precomputed window.
+/// @param[in] measured The recorded period of the signal pulse.
+/// @param[in] window The window to check against. See `tickWindow()`.
+/// @return A Boolean. true if it matches, false if it doesn't.
+bool IRrecv::matchWindow(const uint32_t measured, const match_window_t window) {
+  return measured >= window.low && measured <= window.high;
 }
 
 /// Check if we match a pulse(measured) with the desired within
@@ -924,25 +2164,34 @@ uint32_t IRrecv::ticksHigh(const uint32_t usecs, const uint8_t tolerance,
 bool IRrecv::match(uint32_t measured, uint32_t desired, uint8_t tolerance,
                    uint16_t delta) {
   measured *= kRawTick;  // Convert to uSecs.
+  const uint32_t low = ticksLow(desired, tolerance, delta);
+  const uint32_t high = ticksHigh(desired, tolerance, delta);
   DPRINT("Matching: ");
-  DPRINT(ticksLow(desired, tolerance, delta));
+  DPRINT(low);
   DPRINT(" <= ");
   DPRINT(measured);
   DPRINT(" <= ");
-  DPRINTLN(ticksHigh(desired, tolerance, delta));
+  DPRINTLN(high);
 #ifdef UNIT_TEST
   // Sanity checks that we don't have values that cause integer over/underflow.
   // Only performed during testing so there is no performance hit in normal
   // operation.
-  assert(ticksLow(desired, tolerance, delta) <= desired);
+  assert(low <= desired);
   // Check if we overflowed.  (UINT32_MAX >> 3 is approx 9 minutes!)
-  assert(ticksHigh(desired, tolerance, delta) < UINT32_MAX >> 3);
+  assert(high < UINT32_MAX >> 3);
   // Check if our high mark is below where we started. This could happen.
   // If there is a legit case, then this should be removed.
-  assert(ticksHigh(desired, tolerance, delta) >= desired);
+  assert(high >= desired);
 #endif  // UNIT_TEST
-  return (measured >= ticksLow(desired, tolerance, delta) &&
-          measured <= ticksHigh(desired, tolerance, delta));
+#if ENABLE_DECODE_SCORING
+  if (measured >= low && measured <= high) {
+    _scoreTiming(measured, desired);
+    return true;
+  }
+  return false;
+#else  // ENABLE_DECODE_SCORING
+  return (measured >= low && measured <= high);
+#endif  // ENABLE_DECODE_SCORING
 }
 
 /// Check if we match a pulse(measured) of at least desired within
@@ -1074,6 +2323,56 @@ bool IRrecv::decodeHash(decode_results *results) {
 }
 #endif  // DECODE_HASH
 
+/// Precompute the acceptable values for the marks & spaces of the data bits.
+/// Same as matchMark() & matchSpace() do, but only once per message, rather
+/// than for every bit.
+/// @param[in] onemark Nr. of uSeconds in an expected mark signal for a '1' bit.
+/// @param[in] onespace Nr. of uSecs in an expected space signal for a '1' bit.
+/// @param[in] zeromark Nr. of uSecs in an expected mark signal for a '0' bit.
+/// @param[in] zerospace Nr. of uSecs in an expected space signal for a '0' bit.
+/// @param[in] tolerance Percentage error margin to allow. (Default: kUseDefTol)
+/// @param[in] excess Nr. of uSeconds. (Def: kMarkExcess)
+/// @return The windows to use with `_matchBit()`.
+bit_windows_t IRrecv::_bitWindows(const uint16_t onemark,
+                                  const uint32_t onespace,
+                                  const uint16_t zeromark,
+                                  const uint32_t zerospace,
+                                  const uint8_t tolerance,
+                                  const int16_t excess) {
+  bit_windows_t windows;
+  windows.one_mark = tickWindow((uint32_t)onemark + excess, tolerance);
+  windows.one_space = tickWindow(onespace - excess, tolerance);
+  windows.zero_mark = tickWindow((uint32_t)zeromark + excess, tolerance);
+  windows.zero_space = tickWindow(zerospace - excess, tolerance);
+  return windows;
+}
+
+/// Classify a single mark & space pair as a data bit.
+/// @param[in] data_ptr A pointer to the mark in the capture buffer.
+/// @param[in] windows The precomputed bit windows. See `_bitWindows()`.
+/// @return 1 for a '1' bit, 0 for a '0' bit, or -1 if it is neither.
+int8_t IRrecv::_matchBit(volatile uint16_t *data_ptr,
+                         const bit_windows_t *windows) {
+  const uint16_t mark = *data_ptr;
+  const uint16_t space = *(data_ptr + 1);
+  int8_t bit;
+  if (matchWindow(mark, windows->one_mark) &&
+      matchWindow(space, windows->one_space))
+    bit = 1;
+  else if (matchWindow(mark, windows->zero_mark) &&
+           matchWindow(space, windows->zero_space))
+    bit = 0;
+  else
+    return -1;  // It's neither.
+#if ENABLE_DECODE_SCORING
+  _scoreTiming(mark * kRawTick, bit ? windows->one_mark.desired
+                                    : windows->zero_mark.desired);
+  _scoreTiming(space * kRawTick, bit ? windows->one_space.desired
+                                     : windows->zero_space.desired);
+#endif  // ENABLE_DECODE_SCORING
+  return bit;
+}
+
 /// Match & decode the typical data section of an IR message.
 /// The data value is stored in the least significant bits reguardless of the
 /// bit ordering requested.
@@ -1093,22 +2392,20 @@ match_result_t IRrecv::matchData(
     volatile uint16_t *data_ptr, const uint16_t nbits, const uint16_t onemark,
     const uint32_t onespace, const uint16_t zeromark, const uint32_t zerospace,
     const uint8_t tolerance, const int16_t excess, const bool MSBfirst) {
+  const bit_windows_t windows = _bitWindows(onemark, onespace,
+                                            zeromark, zerospace,
+                                            tolerance, excess);
   match_result_t result;
   result.success = false;  // Fail by default.
   result.data = 0;
   for (result.used = 0; result.used < nbits * 2;
        result.used += 2, data_ptr += 2) {
-    // Is the bit a '1'?
-    if (matchMark(*data_ptr, onemark, tolerance, excess) &&
-        matchSpace(*(data_ptr + 1), onespace, tolerance, excess)) {
-      result.data = (result.data << 1) | 1;
-    } else if (matchMark(*data_ptr, zeromark, tolerance, excess) &&
-               matchSpace(*(data_ptr + 1), zerospace, tolerance, excess)) {
-      result.data <<= 1;  // The bit is a '0'.
-    } else {
+    const int8_t bit = _matchBit(data_ptr, &windows);
+    if (bit < 0) {
       if (!MSBfirst) result.data = reverseBits(result.data, result.used / 2);
       return result;  // It's neither, so fail.
     }
+    result.data = (result.data << 1) | bit;
   }
   result.success = true;
   if (!MSBfirst) result.data = reverseBits(result.data, nbits);
@@ -1139,16 +2436,25 @@ uint16_t IRrecv::matchBytes(volatile uint16_t *data_ptr, uint8_t *result_ptr,
                             const bool MSBfirst) {
   // Check if there is enough capture buffer to possibly have the desired bytes.
   if (remaining < nbytes * 8 * 2) return 0;  // Nope, so abort.
-  uint16_t offset = 0;
+  // The windows are the same for every byte, so only work them out once.
+  const bit_windows_t windows = _bitWindows(onemark, onespace,
+                                            zeromark, zerospace,
+                                            tolerance, excess);
   for (uint16_t byte_pos = 0; byte_pos < nbytes; byte_pos++) {
-    match_result_t result = matchData(data_ptr + offset, 8, onemark, onespace,
-                                      zeromark, zerospace, tolerance, excess,
-                                      MSBfirst);
-    if (result.success == false) return 0;  // Fail
-    result_ptr[byte_pos] = (uint8_t)result.data;
-    offset += result.used;
+    uint8_t byte = 0;
+    for (uint8_t i = 0; i < 8; i++, data_ptr += 2) {
+      const int8_t bit = _matchBit(data_ptr, &windows);
+      if (bit < 0) return 0;  // Fail
+      // Shift each bit in from the appropriate end, so the byte never needs
+      // to be reversed afterwards.
+      if (MSBfirst)
+        byte = (byte << 1) | bit;
+      else
+        byte = (byte >> 1) | (bit << 7);
+    }
+    result_ptr[byte_pos] = byte;
   }
-  return offset;
+  return nbytes * 8 * 2;
 }
 
 /// Match & decode a generic/typical IR message.
@@ -1350,6 +2656,92 @@ uint16_t IRrecv::matchGeneric(volatile uint16_t *data_ptr,
                        tolerance, excess, MSBfirst);
 }
 
+/// Match & decode a generic/typical <= 64bit IR message, from a descriptor.
+/// The data is stored at result_ptr.
+/// @param[in] data_ptr A pointer to where we are at in the capture buffer.
+/// @note `data_ptr` is assumed to be pointing to a "Mark", not a "Space".
+/// @param[out] result_ptr A ptr to where to start storing the bits we decoded.
+/// @param[in] remaining The size of the capture buffer remaining.
+/// @param[in] nbits Nr. of data bits we expect.
+/// @param[in] timing A ptr to the descriptor of the protocol's timings etc.
+/// @return If successful, how many buffer entries were used. Otherwise 0.
+/// @note The gap is matched as a minimum. i.e. `matchAtLeast()`.
+uint16_t IRrecv::matchGeneric(volatile uint16_t *data_ptr,
+                              uint64_t *result_ptr,
+                              const uint16_t remaining,
+                              const uint16_t nbits,
+                              const protocol_timing_t *timing) {
+  return _matchGeneric(data_ptr, result_ptr, NULL, true, remaining, nbits,
+                       timing->hdrmark, timing->hdrspace,
+                       timing->onemark, timing->onespace,
+                       timing->zeromark, timing->zerospace,
+                       timing->footermark, timing->gap, true,
+                       timing->tolerance, kMarkExcess, timing->MSBfirst);
+}
+
+/// Match & decode a generic/typical > 64bit IR message, from a descriptor.
+/// The bytes are stored at result_ptr. The first byte in the result equates to
+/// the first byte encountered, and so on.
+/// @param[in] data_ptr A pointer to where we are at in the capture buffer.
+/// @note `data_ptr` is assumed to be pointing to a "Mark", not a "Space".
+/// @param[out] result_ptr A ptr to where to start storing the bytes we decoded.
+/// @param[in] remaining The size of the capture buffer remaining.
+/// @param[in] nbits Nr. of data bits we expect.
+/// @param[in] timing A ptr to the descriptor of the protocol's timings etc.
+/// @return If successful, how many buffer entries were used. Otherwise 0.
+/// @note The gap is matched as a minimum. i.e. `matchAtLeast()`.
+uint16_t IRrecv::matchGeneric(volatile uint16_t *data_ptr,
+                              uint8_t *result_ptr,
+                              const uint16_t remaining,
+                              const uint16_t nbits,
+                              const protocol_timing_t *timing) {
+  return _matchGeneric(data_ptr, NULL, result_ptr, false, remaining, nbits,
+                       timing->hdrmark, timing->hdrspace,
+                       timing->onemark, timing->onespace,
+                       timing->zeromark, timing->zerospace,
+                       timing->footermark, timing->gap, true,
+                       timing->tolerance, kMarkExcess, timing->MSBfirst);
+}
+
+/// Decode the supplied message of a protocol described by a descriptor.
+/// @param[in,out] results Ptr to the data to decode & where to store the result
+/// @param[in] offset The starting index to use when attempting to decode the
+///   raw data. Typically/Defaults to kStartOffset.
+/// @param[in] timing A ptr to the descriptor of the protocol's timings etc.
+/// @param[in] nbits The number of data bits to expect.
+///   Messages over 64 bits must be a whole nr. of bytes, & are stored in
+///   `results->state`.
+/// @param[in] strict Flag indicating if we should perform strict matching.
+///   i.e. Only accept the descriptor's nr. of bits.
+/// @return True if it can decode it, false if it can't.
+bool IRrecv::decodeGeneric(decode_results *results, uint16_t offset,
+                           const protocol_timing_t *timing,
+                           const uint16_t nbits, const bool strict) {
+  if (strict && nbits != timing->bits)
+    return false;  // Not strictly the expected size of message.
+  if (results->rawlen < 2 * nbits + offset)
+    return false;  // Can't possibly be a valid message.
+
+  if (nbits > sizeof(results->value) * 8) {
+    if (nbits % 8 || nbits / 8 > kStateSizeMax) return false;
+    // Match Header + Data + Footer
+    if (!matchGeneric(results->rawbuf + offset, results->state,
+                      results->rawlen - offset, nbits, timing)) return false;
+  } else {
+    uint64_t data = 0;
+    // Match Header + Data + Footer
+    if (!matchGeneric(results->rawbuf + offset, &data,
+                      results->rawlen - offset, nbits, timing)) return false;
+    results->value = data;
+    results->command = 0;
+    results->address = 0;
+  }
+  // Success
+  results->bits = nbits;
+  results->decode_type = timing->protocol;
+  return true;
+}
+
 /// Match & decode a generic/typical constant bit time <= 64bit IR message.
 /// The data is stored at result_ptr.
 /// @note Values of 0 for hdrmark, hdrspace, footermark, or footerspace mean
@@ -1436,6 +2828,117 @@ uint16_t IRrecv::matchGenericConstBitTime(volatile uint16_t *data_ptr,
   return offset;
 }
 
+/// Precompute everything needed to decode a Manchester/bi-phase coded message.
+/// i.e. The acceptable range of a pulse of each nr. of half-periods, so each
+/// pulse can be quantised into half-periods with only a few comparisons.
+/// @param[in] half_period Nr. of uSeconds for half the clock's period.
+/// @param[in] tolerance Percentage error margin to allow. (Default: kUseDefTol)
+/// @param[in] excess Extra uSeconds to add to Marks & removed from Spaces.
+/// @param[in] delta A non-scaling (+/-) error margin (in uSeconds).
+/// @param[in] maxwidth Max. nr. of half-periods in a single pulse.
+///   Capped at kManchesterMaxWidth.
+/// @return The timings to use with `_manchesterLevel()` etc.
+manchester_timing_t IRrecv::_manchesterTiming(const uint16_t half_period,
+                                              const uint8_t tolerance,
+                                              const int16_t excess,
+                                              const uint16_t delta,
+                                              const uint8_t maxwidth) {
+  manchester_timing_t timing;
+  timing.half_period = half_period;
+  timing.excess = excess;
+  timing.maxwidth = std::min(maxwidth, kManchesterMaxWidth);
+  for (uint8_t i = 0; i < timing.maxwidth; i++) {
+    const int32_t period = (int32_t)(i + 1) * half_period;
+    const match_window_t mark = tickWindow(period + excess, tolerance, delta);
+    const match_window_t space = tickWindow(period - excess, tolerance, delta);
+    timing.low[kMark][i] = std::min(mark.low, (uint32_t)UINT16_MAX);
+    timing.high[kMark][i] = std::min(mark.high, (uint32_t)UINT16_MAX);
+    timing.low[kSpace][i] = std::min(space.low, (uint32_t)UINT16_MAX);
+    timing.high[kSpace][i] = std::min(space.high, (uint32_t)UINT16_MAX);
+  }
+  // A space longer than 20ms, or than the widest allowed, is a message gap.
+  timing.gap = std::min((int32_t)20000 - delta,
+                        (int32_t)timing.maxwidth * half_period + delta);
+  return timing;
+}
+
+/// Does a pulse last a given nr. of half-periods?
+/// @param[in] ticks The recorded period of the pulse. (kRawTicks)
+/// @param[in] count The nr. of half-periods to check for.
+/// @param[in] level Is the pulse a kMark or a kSpace?
+/// @param[in] timing The precomputed timings. See `_manchesterTiming()`.
+/// @return A Boolean. true if it matches, false if it doesn't.
+bool IRrecv::_matchHalfPeriods(const uint32_t ticks, const uint8_t count,
+                               const int16_t level,
+                               const manchester_timing_t *timing) {
+  if (count == 0 || count > timing->maxwidth) return false;
+  if (ticks < timing->low[level][count - 1] ||
+      ticks > timing->high[level][count - 1]) return false;
+#if ENABLE_DECODE_SCORING
+  _scoreTiming(ticks * kRawTick, count * timing->half_period +
+               ((level == kMark) ? timing->excess : -timing->excess));
+#endif  // ENABLE_DECODE_SCORING
+  return true;
+}
+
+/// Quantise a pulse into a nr. of half-periods.
+/// @param[in] ticks The recorded period of the pulse. (kRawTicks)
+/// @param[in] level Is the pulse a kMark or a kSpace?
+/// @param[in] timing The precomputed timings. See `_manchesterTiming()`.
+/// @return The nr. of half-periods, or 0 if it isn't a multiple of one.
+/// @note We match in greedy (widest first) order, as the other way leads to
+///   mismatches due to overlaps induced by the excess & tolerance values.
+uint8_t IRrecv::_halfPeriods(const uint32_t ticks, const int16_t level,
+                             const manchester_timing_t *timing) {
+  for (uint8_t count = timing->maxwidth; count > 0; count--)
+    if (_matchHalfPeriods(ticks, count, level, timing)) return count;
+  return 0;
+}
+
+/// Gets one undecoded level (half-period) at a time from the raw buffer.
+/// E.g. if the buffer has MARK for 2 half-periods and SPACE for 1,
+/// successive calls will return MARK, MARK, SPACE.
+/// offset and used are updated to keep track of the current position.
+/// @param[in] results Ptr to the data to decode.
+/// @param[in,out] offset Ptr to the currect offset to the rawbuf.
+/// @param[in,out] used Ptr to the nr. of half-periods of the current pulse
+///   already returned.
+/// @param[in] timing The precomputed timings. See `_manchesterTiming()`.
+/// @return kMark, kSpace, or -1 for error.
+///   (The measured time interval is not a multiple of the half-period.)
+int16_t IRrecv::_manchesterLevel(decode_results *results, uint16_t *offset,
+                                 uint16_t *used,
+                                 const manchester_timing_t *timing) {
+  // After end of recorded buffer, assume SPACE.
+  if (*offset >= results->rawlen) return kSpace;
+  const uint16_t width = results->rawbuf[*offset];
+  //  If the value of offset is odd, it's a MARK. Even, it's a SPACE.
+  const int16_t level = ((*offset) % 2) ? kMark : kSpace;
+  // Check to see if we have hit an inter-message gap.
+  if (level == kSpace && width > timing->gap) return kSpace;
+  const uint8_t avail = _halfPeriods(width, level, timing);
+  if (!avail) return -1;  // The width is not what we expected.
+  (*used)++;             // Count another one of the avail slots as used.
+  if (*used >= avail) {  // Are we out of look-ahead/avail slots?
+    // Yes, so reset the used counter, and move the offset ahead.
+    *used = 0;
+    (*offset)++;
+  }
+  return level;
+}
+
+/// Convert a pair of Manchester coded half-periods into a data bit.
+/// @param[in] first The level of the first half of the bit.
+/// @param[in] second The level of the second half of the bit.
+/// @param[in] GEThomas Use G.E. Thomas (true) or IEEE 802.3 (false) convention?
+///   i.e. Is a MARK then a SPACE a '1' (G.E. Thomas) or a '0' (IEEE)?
+/// @return 1 or 0 for the bit value, or -1 if it isn't a valid transition.
+int8_t IRrecv::_manchesterBit(const int16_t first, const int16_t second,
+                              const bool GEThomas) {
+  if (first < 0 || second < 0 || first == second) return -1;
+  return (first == kMark) == GEThomas;
+}
+
 /// Match & decode a Manchester Code <= 64bit IR message.
 /// The data is stored at result_ptr.
 /// @note Values of 0 for hdrmark, hdrspace, footermark, or footerspace mean
@@ -1568,7 +3071,6 @@ uint16_t IRrecv::matchManchester(volatile const uint16_t *data_ptr,
 /// @return If successful, how many buffer entries were used. Otherwise 0.
 /// @see https://en.wikipedia.org/wiki/Manchester_code
 /// @see http://ww1.microchip.com/downloads/en/AppNotes/Atmel-9164-Manchester-Coding-Basics_Application-Note.pdf
-/// @todo Clean up and optimise this. It is just "get it working code" atm.
 uint16_t IRrecv::matchManchesterData(volatile const uint16_t *data_ptr,
                                      uint64_t *result_ptr,
                                      const uint16_t remaining,
@@ -1583,6 +3085,9 @@ uint16_t IRrecv::matchManchesterData(volatile const uint16_t *data_ptr,
   uint64_t data = 0;
   uint16_t nr_half_periods = 0;
   const uint16_t expected_half_periods = nbits * 2;
+  // Marks & spaces are matched the same way here. `excess` is just a delta.
+  const manchester_timing_t timing = _manchesterTiming(half_period, tolerance,
+                                                       0, excess, 2);
   // Flip the bit if we have a starting balance. ie. Carry over from the header.
   bool currentBit = starting_balance ? !GEThomas : GEThomas;
   const uint16_t raw_half_period = half_period / kRawTick;
@@ -1617,7 +3122,7 @@ uint16_t IRrecv::matchManchesterData(volatile const uint16_t *data_ptr,
     // Get the next entry if we haven't anything existing to process.
     if (!bank) bank = *(data_ptr + offset++);
     // Check if we don't have a short interval.
-    if (!match(bank, half_period, tolerance, excess))  return 0;  // Not valid.
+    if (!_matchHalfPeriods(bank, 1, kMark, &timing)) return 0;  // Not valid.
     // We've succeeded in matching half a period, so count it.
     nr_half_periods++;
     // We've now used up our bank, so refill it with the next item, unless we
@@ -1635,12 +3140,12 @@ uint16_t IRrecv::matchManchesterData(volatile const uint16_t *data_ptr,
     data |= currentBit;
 
     // Check if we have a long interval.
-    if (match(bank, half_period * 2, tolerance, excess)) {
+    if (_matchHalfPeriods(bank, 2, kMark, &timing)) {
       // It is, so flip the bit we need to append, and remove a half_period of
       // time from the bank.
       currentBit = !currentBit;
       bank -= raw_half_period;
-    } else if (match(bank, half_period, tolerance, excess)) {
+    } else if (_matchHalfPeriods(bank, 1, kMark, &timing)) {
       // It is a short interval, so eat up all the time and move on.
       bank = 0;
     } else if (nr_half_periods == expected_half_periods - 1 &&
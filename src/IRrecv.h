@@ -13,6 +13,7 @@
 #define __STDC_LIMIT_MACROS
 #include <stdint.h>
 #include "IRremoteESP8266.h"
+#include "IRtimer.h"
 
 // Constants
 const uint16_t kHeader = 2;        // Usual nr. of header entries.
@@ -52,9 +53,62 @@ const uint16_t kMaxTimeoutMs = kRawTick * (UINT16_MAX / MS_TO_USEC(1));
 const uint32_t kFnvPrime32 = 16777619UL;
 const uint32_t kFnvBasis32 = 2166136261UL;
 
+// A suggested quiet time (uSeconds) before trying to decode a message early.
+// i.e. Longer than the spaces within most protocols' messages. See:
+// `IRrecv::setEarlyDecodeGap()`
+const uint16_t kEarlyDecodeGap = 5000;
+
+// Compact capture format. See `irutils::compactRaw()`.
+// Most entries take 1 byte, in units of 2^kCompactShift kRawTicks. i.e. 8us.
+// Anything too big for that (> ~2ms) is stored exactly, using 3 bytes.
+const uint8_t kCompactShift = 2;
+const uint8_t kCompactEscape = 0xFF;  // Followed by 2 bytes of kRawTicks.
+// How many entries per long (3 byte) entry to allow for in a compact capture.
+const uint8_t kCompactLongRatio = 8;
+
 // Which of the ESP32 timers to use by default. (0-3)
 const uint8_t kDefaultESP32Timer = 3;
 
+// Decoder dispatch index.
+// A captured message's leading mark & space are compared against a very
+// generous window around what each protocol expects, to cheaply rule out the
+// decoders that can't possibly match before we run them.
+const uint8_t kDecodeIndexTolerance = 50;  // Percent of the nominal value.
+const uint16_t kDecodeIndexDelta = 100;  // uSeconds. Covers mark excess etc.
+// Above this tolerance a decoder could accept something outside the index's
+// window, so the index is bypassed and every decoder is attempted.
+const uint8_t kDecodeIndexMaxTolerance = 40;  // Percent.
+
+#if ENABLE_PULSE_CLASSIFICATION
+// Nr. of classes pulse durations are put into. See `IRrecv::_plausibleLead()`.
+const uint8_t kPulseClasses = 32;  // Nr. of bits in a `uint32_t`.
+#endif  // ENABLE_PULSE_CLASSIFICATION
+
+#if ENABLE_DECODE_PROFILING
+// Nr. of log2 buckets in the decode latency histogram.
+// i.e. Bucket `n` counts decodes taking [2^n, 2^(n+1)) uSeconds. The first
+//      bucket also holds 0 & 1 uSecond, and the last everything larger.
+const uint8_t kDecodeLatencyBuckets = 20;
+#endif  // ENABLE_DECODE_PROFILING
+
+// Manchester/bi-phase decoding. See `IRrecv::_manchesterTiming()`.
+const uint8_t kManchesterMaxWidth = 9;  // Max. nr. of half-periods in a pulse.
+// Levels of a Manchester coded signal. See `IRrecv::getRClevel()`.
+const int16_t kMark = 0;
+const int16_t kSpace = 1;
+
+// Decode scoring. See `ENABLE_DECODE_SCORING` & `IRrecv::setBestMatch()`.
+const uint16_t kNoScore = UINT16_MAX;  // Not scored. e.g. UNKNOWN messages.
+const uint8_t kDecodeCandidates = 3;  // Max. nr. of runners-up reported.
+
+#if DECODE_MEMO_SLOTS
+// Decode memoisation. See `DECODE_MEMO_SLOTS` & `IRrecv::_fingerprint()`.
+// How long (mSecs) after it was last seen a remembered decode is still used.
+const uint16_t kDecodeMemoTimeoutMs = 250;
+// How close the leading mark & space need to be to the remembered ones.
+const uint8_t kDecodeMemoTolerance = 25;  // Percent.
+#endif  // DECODE_MEMO_SLOTS
+
 #if DECODE_AC
 // Hitachi AC is the current largest state size.
 const uint16_t kStateSizeMax = kHitachiAc2StateLength;
@@ -77,8 +131,32 @@ typedef struct {
   uint16_t rawlen;   // counter of entries in rawbuf.
   uint8_t overflow;  // Buffer overflow indicator.
   uint8_t timeout;   // Nr. of milliSeconds before we give up.
+#if ENABLE_COMPACT_CAPTURE
+  uint8_t *compact;      // Compact capture data. See irutils::compactRaw()
+  uint16_t compactsize;  // Max. nr. of bytes in the compact buffer.
+  uint16_t compactlen;   // Nr. of bytes used in the compact buffer.
+#endif  // ENABLE_COMPACT_CAPTURE
 } irparams_t;
 
+#if CAPTURE_RING_SLOTS && ENABLE_COMPACT_CAPTURE
+#error "CAPTURE_RING_SLOTS & ENABLE_COMPACT_CAPTURE can't be used together."
+#endif
+
+#if CAPTURE_RING_SLOTS
+/// A single-producer (interrupt handler), single-consumer (decode()) ring of
+/// capture buffers. Slots `tail` up to (but not including) `head` hold
+/// completed messages; the interrupt handler captures into slot `head`.
+typedef struct {
+  uint16_t *buffer;  // All the slots. `bufsize` entries per slot.
+  uint16_t rawlen[CAPTURE_RING_SLOTS];   // Nr. of entries in each slot.
+  uint8_t overflow[CAPTURE_RING_SLOTS];  // Buffer overflow indicators.
+  uint8_t head;      // Slot being captured into. Only the ISR changes it.
+  uint8_t tail;      // Oldest completed slot. Only the consumer changes it.
+  bool held;         // Is the `tail` slot in use by the consumer?
+  uint32_t dropped;  // Nr. of completed messages lost due to a full ring.
+} capture_ring_t;
+#endif  // CAPTURE_RING_SLOTS
+
 /// Results from a data match
 typedef struct {
   bool success;   // Was the match successful?
@@ -86,6 +164,74 @@ typedef struct {
   uint16_t used;  // How many buffer positions were used.
 } match_result_t;
 
+/// Strategies for dealing with pulses that are too short. See `noiseFilter()`.
+enum noise_filter_t {
+  kNoiseFilterMerge = 0,  // Merge them into the previous pulse. (Default)
+  kNoiseFilterDrop,       // Remove them.
+  kNoiseFilterMedian,     // Smooth them with a median of 3 filter.
+};
+
+/// A precomputed range of matching capture buffer values. See `tickWindow()`.
+typedef struct {
+  uint32_t low;   // Smallest acceptable value. (in kRawTick units)
+  uint32_t high;  // Largest acceptable value. (in kRawTick units)
+#if ENABLE_DECODE_SCORING
+  uint32_t desired;  // The nominal value. (uSeconds)
+#endif  // ENABLE_DECODE_SCORING
+} match_window_t;
+
+/// The precomputed windows for matching each data bit. See `matchData()`.
+typedef struct {
+  match_window_t one_mark;
+  match_window_t one_space;
+  match_window_t zero_mark;
+  match_window_t zero_space;
+} bit_windows_t;
+
+/// The precomputed timings for decoding a Manchester/bi-phase coded message.
+/// See `IRrecv::_manchesterTiming()`.
+typedef struct {
+  // The acceptable range (in kRawTicks) of a pulse of `n + 1` half-periods,
+  // for each level. i.e. `low[kMark][0]` is for a mark of one half-period.
+  uint16_t low[2][kManchesterMaxWidth];
+  uint16_t high[2][kManchesterMaxWidth];
+  int32_t gap;           // Spaces longer than this end the message. uSeconds.
+  uint16_t half_period;  // uSeconds.
+  int16_t excess;        // uSeconds added to marks & removed from spaces.
+  uint8_t maxwidth;      // Max. nr. of half-periods in a single pulse.
+} manchester_timing_t;
+
+/// An entry in the decoder dispatch index.
+/// @note `type` is a `decode_type_t`, stored in a byte to keep the index small.
+typedef struct {
+  uint8_t type;           // Which decoder(s) to attempt.
+  uint16_t hdrmark_min;   // Shortest nominal leading mark. (uSeconds)
+  uint16_t hdrmark_max;   // Longest nominal leading mark. 0 means always try.
+  uint16_t hdrspace_min;  // Shortest nominal leading space. (uSeconds)
+  uint16_t hdrspace_max;  // Longest nominal leading space. (uSeconds)
+} decode_index_t;
+
+#if ENABLE_DECODE_PROFILING
+/// Decode profiling statistics. Per-protocol arrays are indexed by
+/// `decode_type_t`. e.g. `profile.matches[decode_type_t::NEC]`
+typedef struct {
+  uint32_t attempts[kLastDecodeType + 1];  // Nr. of times a decoder was tried.
+  uint32_t matches[kLastDecodeType + 1];   // Nr. of times it was successful.
+  uint32_t usecs[kLastDecodeType + 1];     // Cumulative time spent in it.
+  uint32_t captures;  // Nr. of captures `decode()` has processed.
+  uint32_t latency[kDecodeLatencyBuckets];  // Histogram of total decode time.
+} decode_profile_t;
+#endif  // ENABLE_DECODE_PROFILING
+
+#if ENABLE_DECODE_SCORING
+/// A protocol that also matched a message, but wasn't the best match.
+typedef struct {
+  decode_type_t decode_type;  // UNKNOWN means an unused entry.
+  uint16_t bits;
+  uint16_t score;  // See `decode_results::score`.
+} decode_candidate_t;
+#endif  // ENABLE_DECODE_SCORING
+
 // Classes
 
 /// Results returned from the decoder
@@ -108,8 +254,24 @@ class decode_results {
   uint16_t rawlen;            // Number of records in rawbuf.
   bool overflow;
   bool repeat;  // Is the result a repeat code?
+#if ENABLE_DECODE_SCORING
+  uint16_t score;  // Mean timing error (0.1% units) of the match. See decode()
+  decode_candidate_t candidates[kDecodeCandidates];  // Runners-up, best first.
+#endif  // ENABLE_DECODE_SCORING
 };
 
+#if DECODE_MEMO_SLOTS
+/// A remembered successful decode. See `IRrecv::_recallDecode()`.
+typedef struct {
+  uint32_t fingerprint;  // See `IRrecv::_fingerprint()`. 0 means unused.
+  uint16_t rawlen;       // Nr. of entries in the capture.
+  uint16_t mark;         // Leading mark of the capture, in kRawTicks.
+  uint16_t space;        // Leading space of the capture, in kRawTicks.
+  TimerMs seen;          // Time since a capture like it was last seen.
+  decode_results result;
+} decode_memo_t;
+#endif  // DECODE_MEMO_SLOTS
+
 /// Class for receiving IR messages.
 class IRrecv {
  public:
@@ -126,6 +288,16 @@ class IRrecv {
   ~IRrecv(void);                                                  // Destructor
   void setTolerance(const uint8_t percent = kTolerance);
   uint8_t getTolerance(void);
+  void setEarlyDecodeGap(const uint16_t usecs);
+  uint16_t getEarlyDecodeGap(void);
+  void setSkipScan(const bool enable);
+  bool getSkipScan(void);
+#if ENABLE_NOISE_FILTER_OPTION
+  uint16_t noiseFilter(decode_results *results, const uint16_t floor,
+                       const noise_filter_t mode = kNoiseFilterMerge);
+  void setNoiseFilter(const noise_filter_t mode);
+  noise_filter_t getNoiseFilter(void);
+#endif  // ENABLE_NOISE_FILTER_OPTION
   bool decode(decode_results *results, irparams_t *save = NULL,
               uint8_t max_skip = 0, uint16_t noise_floor = 0);
   void enableIRIn(const bool pullup = false);
@@ -135,6 +307,30 @@ class IRrecv {
 #if DECODE_HASH
   void setUnknownThreshold(const uint16_t length);
 #endif
+#if CAPTURE_RING_SLOTS
+  bool popCapture(decode_results *results);
+  uint32_t getDroppedCount(void);
+#endif  // CAPTURE_RING_SLOTS
+#if ENABLE_DECODE_PROFILING
+  const decode_profile_t &getProfile(void);
+  void resetProfile(void);
+#endif  // ENABLE_DECODE_PROFILING
+#if ENABLE_DECODE_SCORING
+  void setBestMatch(const bool enable);
+  bool getBestMatch(void);
+#endif  // ENABLE_DECODE_SCORING
+#if DECODE_MEMO_SLOTS
+  void setDecodeMemo(const bool enable);
+  bool getDecodeMemo(void);
+  void clearDecodeMemo(void);
+#endif  // DECODE_MEMO_SLOTS
+#if CUSTOM_PROTOCOL_SLOTS
+  bool addProtocol(const protocol_timing_t *timing);
+  void clearProtocols(void);
+#endif  // CUSTOM_PROTOCOL_SLOTS
+  bool decodeGeneric(decode_results *results, uint16_t offset,
+                     const protocol_timing_t *timing, const uint16_t nbits,
+                     const bool strict = true);
   bool match(const uint32_t measured, const uint32_t desired,
              const uint8_t tolerance = kUseDefTol,
              const uint16_t delta = 0);
@@ -150,22 +346,77 @@ class IRrecv {
 #endif
   irparams_t *irparams_save;
   uint8_t _tolerance;
+  uint16_t _early_gap;
+  uint16_t _early_rawlen;  // Capture length of the last early decode attempt.
+  bool _skip_scan;
+#if ENABLE_NOISE_FILTER_OPTION
+  noise_filter_t _noise_filter;
+#endif  // ENABLE_NOISE_FILTER_OPTION
 #if defined(ESP32)
   uint8_t _timer_num;
 #endif  // defined(ESP32)
 #if DECODE_HASH
   uint16_t _unknown_threshold;
 #endif
+#if ENABLE_DECODE_PROFILING
+  decode_profile_t _profile;
+  void _profileAttempt(const decode_type_t type, const bool matched,
+                       const uint32_t usecs);
+  void _profileCapture(const uint32_t usecs);
+#endif  // ENABLE_DECODE_PROFILING
+#if CAPTURE_RING_SLOTS
+  static void _ringPublish(void);
+#endif  // CAPTURE_RING_SLOTS
+#if CUSTOM_PROTOCOL_SLOTS
+  const protocol_timing_t *_protocols[CUSTOM_PROTOCOL_SLOTS];
+#endif  // CUSTOM_PROTOCOL_SLOTS
+#if DECODE_MEMO_SLOTS
+  bool _use_memo;
+  decode_memo_t _memo[DECODE_MEMO_SLOTS];
+  uint32_t _fingerprint(const decode_results *results);
+  bool _recallDecode(decode_results *results, const uint32_t fingerprint);
+  void _rememberDecode(const decode_results *results,
+                       const uint32_t fingerprint);
+#endif  // DECODE_MEMO_SLOTS
+#if ENABLE_DECODE_SCORING
+  bool _best_match;
+  uint32_t _score_sum;    // Total error (0.1% units) of the current attempt.
+  uint16_t _score_count;  // Nr. of timings scored in the current attempt.
+  void _scoreTiming(const uint32_t measured, const uint32_t desired);
+  bool _rankMatch(decode_results *results, decode_results *best,
+                  const bool found);
+#endif  // ENABLE_DECODE_SCORING
   // These are called by decode
   uint8_t _validTolerance(const uint8_t percentage);
   void copyIrParams(volatile irparams_t *src, irparams_t *dst);
   uint16_t compare(const uint16_t oldval, const uint16_t newval);
+  bool _plausibleHeader(const decode_index_t *entry,
+                        const uint32_t mark, const uint32_t space);
+  bool _tryDecoders(decode_results *results, const uint8_t max_skip);
+#if ENABLE_PULSE_CLASSIFICATION
+  bool _plausibleLead(const decode_type_t type, const uint32_t lead);
+#endif  // ENABLE_PULSE_CLASSIFICATION
+  bool _decodeEarly(decode_results *results, irparams_t *save,
+                    const uint8_t max_skip, const uint16_t noise_floor,
+                    const uint32_t quiet);
+  bool _endCaptureEarly(const uint16_t rawlen, const bool end);
+  bool _decodeIndexed(const decode_type_t type, decode_results *results,
+                      const uint16_t offset);
   uint32_t ticksLow(const uint32_t usecs,
                     const uint8_t tolerance = kUseDefTol,
                     const uint16_t delta = 0);
   uint32_t ticksHigh(const uint32_t usecs,
                      const uint8_t tolerance = kUseDefTol,
                      const uint16_t delta = 0);
+  match_window_t tickWindow(const uint32_t desired,
+                            const uint8_t tolerance = kUseDefTol,
+                            const uint16_t delta = 0);
+  bool matchWindow(const uint32_t measured, const match_window_t window);
+  bit_windows_t _bitWindows(const uint16_t onemark, const uint32_t onespace,
+                            const uint16_t zeromark, const uint32_t zerospace,
+                            const uint8_t tolerance = kUseDefTol,
+                            const int16_t excess = kMarkExcess);
+  int8_t _matchBit(volatile uint16_t *data_ptr, const bit_windows_t *windows);
   bool matchAtLeast(const uint32_t measured, const uint32_t desired,
                     const uint8_t tolerance = kUseDefTol,
                     const uint16_t delta = 0);
@@ -222,6 +473,12 @@ class IRrecv {
                         const uint8_t tolerance = kUseDefTol,
                         const int16_t excess = kMarkExcess,
                         const bool MSBfirst = true);
+  uint16_t matchGeneric(volatile uint16_t *data_ptr, uint64_t *result_ptr,
+                        const uint16_t remaining, const uint16_t nbits,
+                        const protocol_timing_t *timing);
+  uint16_t matchGeneric(volatile uint16_t *data_ptr, uint8_t *result_ptr,
+                        const uint16_t remaining, const uint16_t nbits,
+                        const protocol_timing_t *timing);
   uint16_t matchGenericConstBitTime(volatile uint16_t *data_ptr,
                                     uint64_t *result_ptr,
                                     const uint16_t remaining,
@@ -260,7 +517,6 @@ class IRrecv {
                            const int16_t excess = kMarkExcess,
                            const bool MSBfirst = true,
                            const bool GEThomas = true);
-  void crudeNoiseFilter(decode_results *results, const uint16_t floor = 0);
   bool decodeHash(decode_results *results);
 #if DECODE_VOLTAS
   bool decodeVoltas(decode_results *results,
@@ -332,7 +588,21 @@ class IRrecv {
                              const uint16_t nbits = kMitsubishiHeavy152Bits,
                              const bool strict = true);
 #endif
-#if (DECODE_RC5 || DECODE_R6 || DECODE_LASERTAG || DECODE_MWM)
+  manchester_timing_t _manchesterTiming(const uint16_t half_period,
+                                        const uint8_t tolerance = kUseDefTol,
+                                        const int16_t excess = kMarkExcess,
+                                        const uint16_t delta = 0,
+                                        const uint8_t maxwidth = 3);
+  bool _matchHalfPeriods(const uint32_t ticks, const uint8_t count,
+                         const int16_t level,
+                         const manchester_timing_t *timing);
+  uint8_t _halfPeriods(const uint32_t ticks, const int16_t level,
+                       const manchester_timing_t *timing);
+  int16_t _manchesterLevel(decode_results *results, uint16_t *offset,
+                           uint16_t *used, const manchester_timing_t *timing);
+  int8_t _manchesterBit(const int16_t first, const int16_t second,
+                        const bool GEThomas);
+#if (DECODE_RC5 || DECODE_RC6 || DECODE_LASERTAG || DECODE_MWM)
   int16_t getRClevel(decode_results *results, uint16_t *offset, uint16_t *used,
                      uint16_t bitTime, const uint8_t tolerance = kUseDefTol,
                      const int16_t excess = kMarkExcess,
@@ -729,6 +729,130 @@
 #define ENABLE_NOISE_FILTER_OPTION true
 #endif  // ENABLE_NOISE_FILTER_OPTION
 
+// Collect per-protocol decode statistics in `IRrecv::decode()`.
+// i.e. How often each decoder was attempted & matched, how long (uSeconds) was
+// spent in each, and a histogram of the total decode time per capture.
+// Useful for working out which `DECODE_*` options are worth disabling, and the
+// real cost of a `max_skip` value, on your hardware.
+// Note: It costs RAM (~1.2kB per `IRrecv` object) & a little cpu time, so it is
+//       off by default. When disabled, it costs nothing at all.
+// See: `IRrecv::getProfile()` & `IRrecv::resetProfile()`.
+#ifndef ENABLE_DECODE_PROFILING
+#define ENABLE_DECODE_PROFILING false
+#endif  // ENABLE_DECODE_PROFILING
+
+// Nr. of capture buffers (slots) in the IR capture ring. 0 disables it.
+// With it, the interrupt handler keeps capturing new messages into the free
+// slots while earlier ones are waiting to be decoded, instead of ignoring
+// everything until `IRrecv::decode()`/`resume()` is called. e.g. The 2nd & 3rd
+// frames of multi-frame A/C messages, or fast repeats, when the main loop is
+// busy with WiFi etc. Messages that arrive when every slot is full are counted.
+// A ring of `n` slots can hold `n - 1` waiting messages, and costs `n - 1`
+// extra capture buffers of RAM. It replaces the `save_buffer` option.
+// See: `IRrecv::popCapture()` & `IRrecv::getDroppedCount()`.
+#ifndef CAPTURE_RING_SLOTS
+#define CAPTURE_RING_SLOTS 0
+#endif  // CAPTURE_RING_SLOTS
+
+// Have the IR capture interrupt handler store messages in a compact format.
+// Most entries take 1 byte, rather than 2, at a precision of 8us rather than
+// 2us, which is well within what any protocol needs. The capture is unpacked
+// into the normal capture buffer when `IRrecv::decode()` is called, so the
+// interrupt handler can carry on capturing straight away, like it does with
+// the `save_buffer` option. It replaces that option, saving ~0.75 bytes of
+// RAM per capture buffer entry. e.g. ~600 bytes for a 800 entry buffer.
+// Note: Can't be used together with `CAPTURE_RING_SLOTS`.
+// See: `irutils::compactRaw()` & `irutils::expandRaw()`.
+#ifndef ENABLE_COMPACT_CAPTURE
+#define ENABLE_COMPACT_CAPTURE false
+#endif  // ENABLE_COMPACT_CAPTURE
+
+// Nr. of protocols that can be added to an `IRrecv` object at run-time, from a
+// `protocol_timing_t` descriptor. e.g. One loaded from flash/a config file, to
+// support a new simple remote without recompiling. 0 disables the feature.
+// Each slot costs the size of a pointer in RAM. The descriptors aren't copied,
+// so they must be kept in RAM (i.e. Not PROGMEM) by the caller.
+// See: `IRrecv::addProtocol()` & `IRsend::sendGeneric()`.
+#ifndef CUSTOM_PROTOCOL_SLOTS
+#define CUSTOM_PROTOCOL_SLOTS 0  // Off by default.
+#endif  // CUSTOM_PROTOCOL_SLOTS
+
+// Score how well each decoded message fits its protocol's nominal timings.
+// `decode_results::score` is the mean error (in 0.1% units) of the measured
+// mark & space times the decoder matched against. i.e. Lower is better, so
+// marginal/low-confidence decodes can be dropped cheaply.
+// It also allows `IRrecv::setBestMatch()` mode, where every plausible decoder
+// is tried, & the best scoring match (not the first) wins. The runners-up are
+// listed in `decode_results::candidates`.
+// Note: It costs a little cpu time for every timing matched, & some RAM.
+// See: `IRrecv::setBestMatch()`.
+#ifndef ENABLE_DECODE_SCORING
+#define ENABLE_DECODE_SCORING false
+#endif  // ENABLE_DECODE_SCORING
+
+// Classify the leading mark at each offset `decode()` tries, by its duration.
+// The decoders without a usable header (e.g. Sharp, Daikin) are then skipped
+// when they can't start with a mark of that class, rather than trying a full
+// match of them. It costs no RAM, & a few cycles per offset.
+#ifndef ENABLE_PULSE_CLASSIFICATION
+#define ENABLE_PULSE_CLASSIFICATION true
+#endif  // ENABLE_PULSE_CLASSIFICATION
+
+// Nr. of recent successful decodes to remember. 0 disables it.
+// Remotes resend the same message while a key is held down, & A/C remotes
+// often send each message 2-3 times. When turned on at run-time (See
+// `IRrecv::setDecodeMemo()`), a capture that looks the same as one decoded in
+// the last `kDecodeMemoTimeoutMs` mSecs is given that decode's result, with
+// `repeat` set, instead of running the decoders on it again.
+// Captures are compared via a cheap, jitter tolerant fingerprint of their
+// timings. See `IRrecv::_fingerprint()`.
+// Note: Costs a `decode_results` (~100 bytes) of RAM per slot.
+#ifndef DECODE_MEMO_SLOTS
+#define DECODE_MEMO_SLOTS 0
+#endif  // DECODE_MEMO_SLOTS
+
+// Nr. of messages the non-blocking transmit queue can hold. 0 disables it.
+// Messages are rendered (See `IRsend::render()`) into the queue by
+// `IRsend::queue()`, & then sent by calling `IRsend::poll()` from `loop()`
+// etc. The frames of each message are still sent in one go, but the gaps
+// between them, their repeats, & the queued messages don't block.
+// e.g. Sending a Daikin message only blocks for the longest of its frames,
+// rather than for ~0.5 seconds.
+// Note: Costs `kSendQueueBufSize` * 4 bytes of heap per slot, per `IRsend`
+//   object that uses it. It's only allocated on first use.
+#ifndef SEND_QUEUE_SLOTS
+#define SEND_QUEUE_SLOTS 0
+#endif  // SEND_QUEUE_SLOTS
+
+// Max. nr. of GPIOs an `IRsend` object can send on at the same time. (<= 16)
+// 0 disables it. With it, one message can be sent on all of them at once, or
+// different (rendered) messages on each of them, in the time of the longest.
+// e.g. To send a command to the A/Cs in every room at the same time.
+// The GPIOs are switched together by a single GPIO register write, so they
+// must all be in it. i.e. GPIO0-15 on an ESP8266, GPIO0-33 on an ESP32.
+// See: `IRsend::setPins()` & `IRsend::sendMerged()`.
+#ifndef SEND_MULTI_PINS
+#define SEND_MULTI_PINS 0
+#endif  // SEND_MULTI_PINS
+
+// Nr. of protocol specific A/C objects (e.g. `IRDaikinESP`) an `IRac` object
+// keeps for reuse. 0 disables it, i.e. `IRac::sendAc()` makes a new one on the
+// stack every time. With it, they are made on the heap on first use, one per
+// protocol & model, & the least recently used one is replaced when it's full.
+// Saves the cost of making one (& its `IRsend`) for every message sent.
+#ifndef IRAC_POOL_SLOTS
+#define IRAC_POOL_SLOTS 0
+#endif  // IRAC_POOL_SLOTS
+
+// Nr. of rendered A/C messages an `IRac` object keeps, so sending the same
+// A/C state again is just a playback of the marks & spaces. 0 disables it.
+// See: `IRac::setCache()`.
+// Note: Costs `kIRacCacheBufSize` * 4 bytes of heap per slot, per `IRac`
+//   object that uses it. It's only allocated on first use.
+#ifndef IRAC_CACHE_SLOTS
+#define IRAC_CACHE_SLOTS 0
+#endif  // IRAC_CACHE_SLOTS
+
 /// Enumerator for defining and numbering of supported IR protocol.
 /// @note Always add to the end of the list and should never remove entries
 ///  or change order. Projects may save the type number for later usage
@@ -831,6 +955,32 @@ enum decode_type_t {
   kLastDecodeType = METZ,
 };
 
+/// Structure to describe the timings of a simple (pulse distance/width)
+/// protocol. i.e. A header, data bits, a footer mark, & a gap, optionally
+/// repeated. One descriptor drives both `IRsend::sendGeneric()` &
+/// `IRrecv::matchGeneric()`, rather than passing the same values to each.
+/// @note Times are in uSeconds. A zero header mark/space means there isn't one.
+/// @note Protocols added at run-time that have no `decode_type_t` of their own
+///   should use a value greater than `kLastDecodeType`.
+typedef struct {
+  decode_type_t protocol;  // The protocol this describes.
+  uint16_t bits;           // Nr. of data bits in a message.
+  uint16_t hdrmark;
+  uint32_t hdrspace;
+  uint16_t onemark;
+  uint32_t onespace;
+  uint16_t zeromark;
+  uint32_t zerospace;
+  uint16_t footermark;
+  uint32_t gap;            // Minimum gap/space after the footer mark.
+  uint32_t mesgtime;       // Min. total message time incl. the gap. 0 = None.
+  uint16_t frequency;      // Modulation frequency. kHz, or Hz if > 1000.
+  uint8_t dutycycle;       // Percentage.
+  bool MSBfirst;           // Data bit order.
+  uint16_t repeat;         // Nr. of repeats (of the entire message) by default.
+  uint8_t tolerance;       // Matching tolerance (%). kUseDefTol for default.
+} protocol_timing_t;
+
 // Message lengths & required repeat values
 const uint16_t kNoRepeat = 0;
 const uint16_t kSingleRepeat = 1;
@@ -10,10 +10,15 @@
 #include <stdint.h>
 #endif
 #include <algorithm>
+#include <cstring>
+#include <new>
 #ifdef UNIT_TEST
 #include <cmath>
 #endif
 #include "IRtimer.h"
+#if (defined(ESP32) && SEND_MULTI_PINS && !defined(UNIT_TEST))
+#include <soc/gpio_struct.h>
+#endif
 
 /// Constructor for an IRsend object.
 /// @param[in] IRsendPin Which GPIO pin to use when sending an IR command.
@@ -26,7 +31,23 @@
 ///  i.e. If not, assume a 100% duty cycle. Ignore attempts to change the
 ///  duty cycle etc.
 IRsend::IRsend(uint16_t IRsendPin, bool inverted, bool use_modulation)
-    : IRpin(IRsendPin), periodOffset(kPeriodOffset) {
+    : IRpin(IRsendPin), periodOffset(kPeriodOffset), _render(NULL) {
+#ifdef UNIT_TEST
+  _freq_unittest = 0;  // Unknown until `enableIROut()` is called.
+#endif  // UNIT_TEST
+#if SEND_MULTI_PINS
+  _npins = 0;
+  _active = 0;
+  _gpio_all = 0;
+  _gpio_active = 0;
+#endif  // SEND_MULTI_PINS
+#if SEND_QUEUE_SLOTS
+  _queue.buffer = NULL;  // Only allocated if the queue is used.
+  _queue.tail = 0;
+  _queue.count = 0;
+  _queue.index = 0;
+  _queue.waiting = false;
+#endif  // SEND_QUEUE_SLOTS
   if (inverted) {
     outputOn = LOW;
     outputOff = HIGH;
@@ -41,6 +62,12 @@ IRsend::IRsend(uint16_t IRsendPin, bool inverted, bool use_modulation)
     _dutycycle = kDutyMax;
 }
 
+#if SEND_QUEUE_SLOTS
+/// Class destructor.
+/// Cleans up the transmit queue's memory.
+IRsend::~IRsend(void) { delete[] _queue.buffer; }
+#endif  // SEND_QUEUE_SLOTS
+
 /// Enable the pin for output.
 void IRsend::begin() {
 #ifndef UNIT_TEST
@@ -49,16 +76,59 @@ void IRsend::begin() {
   ledOff();  // Ensure the LED is in a known safe state when we start.
 }
 
+#if (SEND_MULTI_PINS && !defined(UNIT_TEST))
+/// Change a group of GPIOs at the same time. i.e. With a single write to the
+/// GPIO set (or clear) register, rather than one `digitalWrite()` per GPIO.
+/// @param[in] mask Bit mask of the GPIO nrs. to change.
+/// @param[in] level What to change them to. `HIGH` or `LOW`.
+static void gpioWriteMask(const uint64_t mask, const uint8_t level) {
+#if defined(ESP8266)
+  if (level == HIGH)
+    GPOS = (uint32_t)mask;
+  else
+    GPOC = (uint32_t)mask;
+#elif defined(ESP32)
+  // GPIOs 32 & 33 are in a second register.
+  const uint32_t low = mask;
+  const uint32_t high = mask >> 32;
+  if (level == HIGH) {
+    if (low) GPIO.out_w1ts = low;
+    if (high) GPIO.out1_w1ts.val = high;
+  } else {
+    if (low) GPIO.out_w1tc = low;
+    if (high) GPIO.out1_w1tc.val = high;
+  }
+#else  // Unknown platform. Slower, & the GPIOs change one after another.
+  for (uint8_t pin = 0; pin <= kSendMultiMaxGpio; pin++)
+    if (mask & (1ULL << pin)) digitalWrite(pin, level);
+#endif
+}
+#endif  // (SEND_MULTI_PINS && !defined(UNIT_TEST))
+
 /// Turn off the IR LED.
 void IRsend::ledOff() {
+  if (_render != NULL) return;  // Rendering never touches the GPIO.
 #ifndef UNIT_TEST
+#if SEND_MULTI_PINS
+  if (_npins) {
+    gpioWriteMask(_gpio_all, outputOff);
+    return;
+  }
+#endif  // SEND_MULTI_PINS
   digitalWrite(IRpin, outputOff);
 #endif
 }
 
 /// Turn on the IR LED.
 void IRsend::ledOn() {
+  if (_render != NULL) return;  // Rendering never touches the GPIO.
 #ifndef UNIT_TEST
+#if SEND_MULTI_PINS
+  if (_npins) {
+    gpioWriteMask(_gpio_active, outputOn);
+    return;
+  }
+#endif  // SEND_MULTI_PINS
   digitalWrite(IRpin, outputOn);
 #endif
 }
@@ -101,6 +171,10 @@ void IRsend::enableIROut(uint32_t freq, uint8_t duty) {
 #ifdef UNIT_TEST
   _freq_unittest = freq;
 #endif  // UNIT_TEST
+  if (_render != NULL) {
+    _render->frequency = freq;
+    _render->dutycycle = _dutycycle;
+  }
   uint32_t period = calcUSecPeriod(freq);
   // Nr. of uSeconds the LED will be on per pulse.
   onTimePeriod = (period * _dutycycle) / kDutyMax;
@@ -155,6 +229,10 @@ void IRsend::_delayMicroseconds(uint32_t usec) {
 /// Ref:
 ///   https://www.analysir.com/blog/2017/01/29/updated-esp8266-nodemcu-backdoor-upwm-hack-for-ir-signals/
 uint16_t IRsend::mark(uint16_t usec) {
+  if (_render != NULL) {  // Rendering, not sending.
+    _renderPulse(true, usec);
+    return 0;
+  }
   // Handle the simple case of no required frequency modulation.
   if (!modulation || _dutycycle >= 100) {
     ledOn();
@@ -192,6 +270,10 @@ uint16_t IRsend::mark(uint16_t usec) {
 /// A space is no output, so the PWM output is disabled.
 /// @param[in] time Time in microseconds (us).
 void IRsend::space(uint32_t time) {
+  if (_render != NULL) {  // Rendering, not sending.
+    _renderPulse(false, time);
+    return;
+  }
   ledOff();
   if (time == 0) return;
   _delayMicroseconds(time);
@@ -356,7 +438,7 @@ void IRsend::sendGeneric(const uint16_t headermark, const uint32_t headerspace,
                          const uint8_t dutycycle) {
   // Setup
   enableIROut(frequency, dutycycle);
-  IRtimer usecs = IRtimer();
+  IRtimer usecs = _timer();
 
   // We always send a message, even for repeat=0, hence '<= repeat'.
   for (uint16_t r = 0; r <= repeat; r++) {
@@ -432,6 +514,40 @@ void IRsend::sendGeneric(const uint16_t headermark, const uint32_t headerspace,
   }
 }
 
+/// Generic method for sending simple protocol messages, from a descriptor.
+/// @param[in] timing A ptr to the descriptor of the protocol's timings etc.
+/// @param[in] data The data to be transmitted.
+/// @param[in] nbits Nr. of bits of data to be sent.
+/// @param[in] repeat Nr. of extra times the message will be sent.
+///   e.g. 0 = 1 message sent, 1 = 1 initial + 1 repeat = 2 messages
+void IRsend::sendGeneric(const protocol_timing_t *timing, const uint64_t data,
+                         const uint16_t nbits, const uint16_t repeat) {
+  sendGeneric(timing->hdrmark, timing->hdrspace,
+              timing->onemark, timing->onespace,
+              timing->zeromark, timing->zerospace,
+              timing->footermark, timing->gap, timing->mesgtime,
+              data, nbits, timing->frequency, timing->MSBfirst, repeat,
+              timing->dutycycle);
+}
+
+/// Generic method for sending simple protocol messages, from a descriptor.
+/// @param[in] timing A ptr to the descriptor of the protocol's timings etc.
+/// @param[in] dataptr Pointer to the data to be transmitted.
+/// @param[in] nbytes Nr. of bytes of data to be sent.
+/// @param[in] repeat Nr. of extra times the message will be sent.
+///   e.g. 0 = 1 message sent, 1 = 1 initial + 1 repeat = 2 messages
+/// @note The descriptor's `mesgtime` isn't supported for byte arrays.
+void IRsend::sendGeneric(const protocol_timing_t *timing,
+                         const uint8_t *dataptr, const uint16_t nbytes,
+                         const uint16_t repeat) {
+  sendGeneric(timing->hdrmark, timing->hdrspace,
+              timing->onemark, timing->onespace,
+              timing->zeromark, timing->zerospace,
+              timing->footermark, timing->gap,
+              dataptr, nbytes, timing->frequency, timing->MSBfirst, repeat,
+              timing->dutycycle);
+}
+
 /// Generic method for sending Manchester code data.
 /// Will send leading or trailing 0's if the nbits is larger than the number
 /// of bits in data.
@@ -1203,3 +1319,568 @@ bool IRsend::send(const decode_type_t type, const uint8_t *state,
   }
   return true;
 }
+
+/// Start rendering messages into a buffer, rather than sending them.
+/// Every `send*()` call after it (e.g. `sendRaw()`, `sendNEC()`) adds its
+/// marks & spaces to the buffer, & never touches the GPIO, until
+/// `endRender()` is called. Consecutive marks (or spaces) are combined, &
+/// any leading spaces are skipped. The frequency & duty cycle recorded are the
+/// last ones used.
+/// @param[in,out] output Ptr to where to render to. Its `buffer16` or
+///   `buffer32`, & `size` must be set. The other fields are reset.
+///   NULL is the same as `endRender()`.
+/// @note Handy for caching pre-rendered messages, converting them to other
+///   formats (e.g. Pronto), or playing them back by other means.
+void IRsend::beginRender(render_buffer_t *output) {
+  if (output == NULL) {
+    endRender();
+    return;
+  }
+  output->length = 0;
+  output->usecs = 0;
+  output->frequency = 0;
+  output->dutycycle = _dutycycle;
+  output->overflow = false;
+  _render = output;
+}
+
+/// Stop rendering messages. i.e. Go back to sending them.
+/// @return true if everything rendered fitted in the buffer, false if not.
+bool IRsend::endRender(void) {
+  if (_render == NULL) return false;
+  const bool success = !_render->overflow;
+  _render = NULL;
+  return success;
+}
+
+/// Render a simple (<= 64 bits) IR message of a given type into a buffer.
+/// @param[in,out] output Ptr to where to render to. See `beginRender()`.
+/// @param[in] type Protocol number/type of the message.
+/// @param[in] data The data for the message.
+/// @param[in] nbits How many bits of `data` are in the message.
+/// @param[in] repeat How many times to repeat the message.
+/// @return true if it could be rendered, & fitted in the buffer.
+bool IRsend::render(render_buffer_t *output, const decode_type_t type,
+                    const uint64_t data, const uint16_t nbits,
+                    const uint16_t repeat) {
+  beginRender(output);
+  const bool supported = send(type, data, nbits, repeat);
+  return endRender() && supported;
+}
+
+/// Render a complex (>= 64 bits) IR message of a given type into a buffer.
+/// @param[in,out] output Ptr to where to render to. See `beginRender()`.
+/// @param[in] type Protocol number/type of the message.
+/// @param[in] state A pointer to the array of bytes that make up the state[].
+/// @param[in] nbytes How many bytes are in the state.
+/// @return true if it could be rendered, & fitted in the buffer.
+bool IRsend::render(render_buffer_t *output, const decode_type_t type,
+                    const uint8_t *state, const uint16_t nbytes) {
+  beginRender(output);
+  const bool supported = send(type, state, nbytes);
+  return endRender() && supported;
+}
+
+/// Get an entry of a rendered message.
+/// @param[in] message A ptr to the rendered message.
+/// @param[in] index Which entry.
+/// @return The duration of the entry, in uSeconds.
+static uint32_t renderedEntry(const render_buffer_t *message,
+                              const uint16_t index) {
+  if (message->buffer32 != NULL) return message->buffer32[index];
+  return message->buffer16[index];
+}
+
+/// Send a message that was rendered earlier. e.g. By `render()`.
+/// @param[in] message A ptr to the rendered message.
+void IRsend::sendRendered(const render_buffer_t *message) {
+  enableIROut(message->frequency, message->dutycycle);
+  for (uint16_t i = 0; i < message->length; i++) {
+    uint32_t usecs = renderedEntry(message, i);
+    if (i & 1) {  // A space.
+      space(usecs);
+    } else {  // A mark. They are limited to 16 bits.
+      for (; usecs > UINT16_MAX; usecs -= UINT16_MAX) mark(UINT16_MAX);
+      mark(usecs);
+    }
+  }
+}
+
+/// Add a mark or space to the buffer being rendered to.
+/// @param[in] is_mark Is it a mark (true), or a space (false)?
+/// @param[in] usecs The duration of it, in uSeconds.
+void IRsend::_renderPulse(const bool is_mark, const uint32_t usecs) {
+  _render->usecs += usecs;
+  if (!usecs || _render->overflow) return;
+  uint16_t i = _render->length;
+  if (!i && !is_mark) return;  // A leading space. i.e. Nothing to send.
+  if (is_mark != (bool)(i & 1)) {  // A new entry. Marks are the even ones.
+    if (i >= _render->size) {
+      _render->overflow = true;
+      return;
+    }
+    _render->length++;
+    if (_render->buffer32 != NULL)
+      _render->buffer32[i] = usecs;
+    else
+      _render->buffer16[i] = std::min(usecs, (uint32_t)UINT16_MAX);
+  } else {  // Add to the previous entry.
+    i--;
+    if (_render->buffer32 != NULL)
+      _render->buffer32[i] += usecs;
+    else
+      _render->buffer16[i] = std::min(_render->buffer16[i] + usecs,
+                                      (uint32_t)UINT16_MAX);
+  }
+}
+
+#if SEND_QUEUE_SLOTS
+/// Get the next free slot in the transmit queue.
+/// @return A ptr to the slot, or NULL if the queue is full, or has no memory.
+render_buffer_t *IRsend::_queueSlot(void) {
+  if (_queue.count >= SEND_QUEUE_SLOTS) return NULL;
+  if (_queue.buffer == NULL) {
+    _queue.buffer = new (std::nothrow) uint32_t[kSendQueueBufSize *
+                                                 SEND_QUEUE_SLOTS];
+    if (_queue.buffer == NULL) return NULL;
+  }
+  const uint8_t slot = (_queue.tail + _queue.count) % SEND_QUEUE_SLOTS;
+  render_buffer_t *message = &_queue.message[slot];
+  message->buffer16 = NULL;
+  message->buffer32 = _queue.buffer + slot * kSendQueueBufSize;
+  message->size = kSendQueueBufSize;
+  return message;
+}
+
+/// Add the message in the next free slot (See `_queueSlot()`) to the queue.
+/// @param[in] callback The function to call once it is sent. NULL for none.
+/// @param[in] tag A value to pass to the `callback`.
+void IRsend::_queueAdd(send_callback_t callback, const uint32_t tag) {
+  const uint8_t slot = (_queue.tail + _queue.count) % SEND_QUEUE_SLOTS;
+  _queue.callback[slot] = callback;
+  _queue.tag[slot] = tag;
+  _queue.count++;
+}
+
+/// Remove the oldest message from the queue, & let its owner know.
+/// @param[in] sent Was it sent?
+void IRsend::_queueRemove(const bool sent) {
+  const uint8_t slot = _queue.tail;
+  _queue.tail = (_queue.tail + 1) % SEND_QUEUE_SLOTS;
+  _queue.count--;
+  _queue.index = 0;
+  _queue.waiting = false;
+  if (_queue.callback[slot] != NULL)
+    _queue.callback[slot](_queue.tag[slot], sent);
+}
+
+/// Add a simple (<= 64 bits) IR message to the non-blocking transmit queue.
+/// It is rendered now, & sent by later calls to `poll()`.
+/// @param[in] type Protocol number/type of the message.
+/// @param[in] data The data for the message.
+/// @param[in] nbits How many bits of `data` are in the message.
+/// @param[in] repeat How many times to repeat the message.
+/// @param[in] callback The function to call once it is sent. NULL for none.
+/// @param[in] tag A value to pass to the `callback`. e.g. A message id.
+/// @return true if it was queued. false if the queue is full, the message is
+///   too big, or the protocol isn't supported.
+bool IRsend::queue(const decode_type_t type, const uint64_t data,
+                   const uint16_t nbits, const uint16_t repeat,
+                   send_callback_t callback, const uint32_t tag) {
+  render_buffer_t *message = _queueSlot();
+  if (message == NULL || !render(message, type, data, nbits, repeat))
+    return false;
+  _queueAdd(callback, tag);
+  return true;
+}
+
+/// Add a complex (>= 64 bits) IR message to the non-blocking transmit queue.
+/// It is rendered now, & sent by later calls to `poll()`.
+/// @param[in] type Protocol number/type of the message.
+/// @param[in] state A pointer to the array of bytes that make up the state[].
+/// @param[in] nbytes How many bytes are in the state.
+/// @param[in] callback The function to call once it is sent. NULL for none.
+/// @param[in] tag A value to pass to the `callback`. e.g. A message id.
+/// @return true if it was queued. false if the queue is full, the message is
+///   too big, or the protocol isn't supported.
+bool IRsend::queue(const decode_type_t type, const uint8_t *state,
+                   const uint16_t nbytes, send_callback_t callback,
+                   const uint32_t tag) {
+  render_buffer_t *message = _queueSlot();
+  if (message == NULL || !render(message, type, state, nbytes)) return false;
+  _queueAdd(callback, tag);
+  return true;
+}
+
+/// Add a copy of an already rendered message to the non-blocking transmit
+/// queue. e.g. One rendered earlier by `render()`.
+/// @param[in] message A ptr to the rendered message.
+/// @param[in] callback The function to call once it is sent. NULL for none.
+/// @param[in] tag A value to pass to the `callback`. e.g. A message id.
+/// @return true if it was queued. false if the queue is full, or the message
+///   is too big.
+bool IRsend::queue(const render_buffer_t *message, send_callback_t callback,
+                   const uint32_t tag) {
+  render_buffer_t *slot = _queueSlot();
+  if (slot == NULL || message->length > slot->size) return false;
+  for (uint16_t i = 0; i < message->length; i++)
+    slot->buffer32[i] = renderedEntry(message, i);
+  slot->length = message->length;
+  slot->usecs = message->usecs;
+  slot->frequency = message->frequency;
+  slot->dutycycle = message->dutycycle;
+  slot->overflow = message->overflow;
+  _queueAdd(callback, tag);
+  return true;
+}
+
+/// Send as much of the queued messages as can be sent without waiting.
+/// i.e. Send any frames that are due, & return during the long spaces between
+/// them. Call it often, e.g. from `loop()`, while it returns true.
+/// @return true if there is more to send, false if the queue is empty.
+/// @note A space may end up longer than it should be if `poll()` isn't called
+///   soon enough, but never shorter. Gaps are minimums, so that is fine.
+bool IRsend::poll(void) {
+  while (_queue.count) {
+    const render_buffer_t *message = &_queue.message[_queue.tail];
+    if (_queue.waiting) {  // Still in a long space?
+      if (_queue.timer.elapsed() < message->buffer32[_queue.index])
+        return true;  // Come back later.
+      _queue.waiting = false;
+      _queue.index++;
+    }
+    // (Re)set the modulation each time we (re)start sending, as `queue()`ing
+    // another message while we were waiting will have changed it.
+    enableIROut(message->frequency, message->dutycycle);
+    while (_queue.index < message->length) {
+      const uint32_t usecs = message->buffer32[_queue.index];
+      if (!(_queue.index & 1)) {  // A mark.
+        mark(std::min(usecs, (uint32_t)UINT16_MAX));
+      } else if (usecs >= kSendQueueYieldGap) {  // Long enough to not block.
+        ledOff();
+        _queue.timer.reset();
+        _queue.waiting = true;
+        return true;
+      } else {  // A space within a frame.
+        space(usecs);
+      }
+      _queue.index++;
+    }
+    _queueRemove(true);  // All sent.
+  }
+  return false;
+}
+
+/// Get the nr. of messages in the transmit queue. Including any being sent.
+/// @return The nr. of messages.
+uint8_t IRsend::getQueueDepth(void) { return _queue.count; }
+
+/// Remove all the messages from the transmit queue, without sending them.
+/// Any message part way through being sent is stopped.
+void IRsend::clearQueue(void) {
+  if (_queue.index) ledOff();
+  while (_queue.count) _queueRemove(false);
+}
+#endif  // SEND_QUEUE_SLOTS
+
+#if SEND_MULTI_PINS
+/// Send on several GPIOs at the same time, instead of the one given to the
+/// constructor. Every `send*()` call then sends the same message on all of
+/// them, & `sendMerged()` can send a different message on each of them.
+/// @param[in] pins An array of the GPIOs to use.
+/// @param[in] count The nr. of GPIOs in `pins`. 0 goes back to using the
+///   constructor's GPIO.
+/// @return true if successful, false if there are too many pins, or a pin is
+///   above `kSendMultiMaxGpio`.
+bool IRsend::setPins(const uint16_t pins[], const uint8_t count) {
+  if (count > SEND_MULTI_PINS) return false;
+  for (uint8_t i = 0; i < count; i++)
+    if (pins[i] > kSendMultiMaxGpio) return false;
+  ledOff();  // Stop using the current pins.
+  _gpio_all = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    _pins[i] = pins[i];
+    _gpio_all |= 1ULL << pins[i];
+#ifndef UNIT_TEST
+    pinMode(_pins[i], OUTPUT);
+#endif
+  }
+  _npins = count;
+  _setActive((1UL << count) - 1);  // All of them.
+  ledOff();  // Ensure the new LEDs are in a known safe state.
+  return true;
+}
+
+/// Choose which of the `setPins()` GPIOs `ledOn()` turns on.
+/// @param[in] active Bit mask of the GPIOs, in `setPins()` order.
+/// @note Works out the GPIO register mask now, so `ledOn()` doesn't have to.
+void IRsend::_setActive(const uint16_t active) {
+  _active = active;
+  _gpio_active = 0;
+  for (uint8_t i = 0; i < _npins; i++)
+    if (active & (1 << i)) _gpio_active |= 1ULL << _pins[i];
+}
+
+/// Get the nr. of GPIOs set by `setPins()`.
+/// @return The nr. of GPIOs. 0 means just the constructor's GPIO is used.
+uint8_t IRsend::getPinCount(void) { return _npins; }
+
+/// Send a mark on some of the `setPins()` GPIOs, or a space on all of them.
+/// @param[in] active Bit mask of the GPIOs (`setPins()` order) to send a mark
+///   on. 0 means send a space.
+/// @param[in] usecs The duration of the mark or space, in uSeconds.
+void IRsend::_sendSegment(const uint16_t active, uint32_t usecs) {
+  if (!active) {
+    space(usecs);
+    return;
+  }
+  _setActive(active);
+  for (; usecs > UINT16_MAX; usecs -= UINT16_MAX) mark(UINT16_MAX);
+  mark(usecs);
+}
+
+/// Send different rendered messages on each of the `setPins()` GPIOs at the
+/// same time. i.e. The messages are merged by time, & sent by a single timing
+/// loop. It takes as long as the longest message does.
+/// @param[in] streams An array of ptrs to rendered messages. See `render()`.
+///   The 1st message is sent on the 1st GPIO, the 2nd on the 2nd, etc.
+/// @param[in] count The nr. of messages in `streams`.
+/// @return true if they were sent, false if there are more messages than pins.
+/// @note They are all modulated with the 1st message's frequency & duty cycle.
+bool IRsend::sendMerged(const render_buffer_t *streams[], const uint8_t count) {
+  if (!count || count > _npins) return false;
+  enableIROut(streams[0]->frequency, streams[0]->dutycycle);
+  uint16_t index[SEND_MULTI_PINS];  // Entry of each message we are up to.
+  uint32_t left[SEND_MULTI_PINS];   // Time left in that entry.
+  for (uint8_t i = 0; i < count; i++) {
+    index[i] = 0;
+    left[i] = streams[i]->length ? renderedEntry(streams[i], 0) : 0;
+  }
+  uint16_t pending_active = 0;  // The segment waiting to be sent.
+  uint32_t pending = 0;  // Its duration.
+  while (true) {
+    // Work out which GPIOs are in a mark, & for how long nothing changes.
+    uint16_t active = 0;
+    uint32_t step = UINT32_MAX;
+    for (uint8_t i = 0; i < count; i++) {
+      if (index[i] >= streams[i]->length) continue;  // Finished.
+      step = std::min(step, left[i]);
+      if (!(index[i] & 1)) active |= (1 << i);  // Marks are the even entries.
+    }
+    if (step == UINT32_MAX) break;  // They have all finished.
+    if (active != pending_active && pending) {
+      _sendSegment(pending_active, pending);
+      pending = 0;
+    }
+    pending_active = active;
+    pending += step;
+    for (uint8_t i = 0; i < count; i++) {
+      if (index[i] >= streams[i]->length) continue;
+      left[i] -= step;
+      if (!left[i] && ++index[i] < streams[i]->length)
+        left[i] = renderedEntry(streams[i], index[i]);
+    }
+  }
+  if (pending) _sendSegment(pending_active, pending);
+  _setActive((1UL << _npins) - 1);  // Back to all of them.
+  return true;
+}
+#endif  // SEND_MULTI_PINS
+
+/// Get a timer for measuring the duration of a message.
+/// @return A timer that is based on the time rendered when rendering, or the
+///   system time when sending.
+IRtimer IRsend::_timer(void) {
+  return IRtimer(_render != NULL ? &_render->usecs : NULL);
+}
+
+/// Class constructor.
+/// @param[in] irsend A ptr to the IRsend object to render & send with.
+/// @param[in] size Max. nr. of mark & space entries the whole sequence can
+///   be rendered into.
+/// @note If the buffer can't be allocated, `render()` & `send()` always fail.
+IRsendSequence::IRsendSequence(IRsend *irsend, const uint16_t size) {
+  _irsend = irsend;
+  _rendered.buffer16 = NULL;
+  _rendered.buffer32 = new (std::nothrow) uint32_t[size];
+  _rendered.size = (_rendered.buffer32 != NULL) ? size : 0;
+  clear();
+}
+
+/// Class destructor.
+IRsendSequence::~IRsendSequence(void) { delete[] _rendered.buffer32; }
+
+/// Set an entry of the sequence, & note if that changes it.
+/// @param[in] index Which entry.
+/// @param[in] type Protocol number/type of the message.
+/// @param[in] is_state Is it a complex (`state`) message?
+/// @param[in] data The data for a simple message.
+/// @param[in] state A pointer to the state[] of a complex message.
+/// @param[in] nbits How many bits of `data`, or bytes of `state`.
+/// @param[in] repeat How many times to repeat a simple message.
+/// @param[in] gap Min. nr. of uSecs of space after the message.
+/// @return true if successful, false if it is too big.
+bool IRsendSequence::_set(const uint8_t index, const decode_type_t type,
+                          const bool is_state, const uint64_t data,
+                          const uint8_t *state, const uint16_t nbits,
+                          const uint16_t repeat, const uint32_t gap) {
+  if (index >= kSequenceMaxEntries) return false;
+  if (is_state && nbits > kSequenceStateSize) return false;
+  sequence_entry_t *entry = &_entries[index];
+  if (entry->type != type || entry->is_state != is_state ||
+      entry->nbits != nbits || entry->gap != gap ||
+      (is_state && std::memcmp(entry->state, state, nbits)) ||
+      (!is_state && (entry->data != data || entry->repeat != repeat))) {
+    entry->type = type;
+    entry->is_state = is_state;
+    entry->data = is_state ? 0 : data;
+    if (is_state) std::memcpy(entry->state, state, nbits);
+    entry->nbits = nbits;
+    entry->repeat = is_state ? kNoRepeat : repeat;
+    entry->gap = gap;
+    _dirty = true;
+  }
+  return true;
+}
+
+/// Add a simple (<= 64 bits) IR message to the end of the sequence.
+/// @param[in] type Protocol number/type of the message.
+/// @param[in] data The data for the message.
+/// @param[in] nbits How many bits of `data` are in the message.
+/// @param[in] repeat How many times to repeat the message.
+/// @param[in] gap Min. nr. of uSecs of space after the message. The
+///   protocol's own gap (e.g. `kNecMinGap`) is used if it is longer.
+/// @return true if successful, false if the sequence is full.
+bool IRsendSequence::add(const decode_type_t type, const uint64_t data,
+                         const uint16_t nbits, const uint16_t repeat,
+                         const uint32_t gap) {
+  if (!_set(_count, type, false, data, NULL, nbits, repeat, gap)) return false;
+  _count++;
+  _dirty = true;
+  return true;
+}
+
+/// Add a complex (>= 64 bits) IR message to the end of the sequence.
+/// @param[in] type Protocol number/type of the message.
+/// @param[in] state A pointer to the array of bytes that make up the state[].
+///   It is copied.
+/// @param[in] nbytes How many bytes are in the state.
+/// @param[in] gap Min. nr. of uSecs of space after the message. The
+///   protocol's own gap is used if it is longer.
+/// @return true if successful, false if the sequence is full, or the state
+///   is too big.
+bool IRsendSequence::add(const decode_type_t type, const uint8_t *state,
+                         const uint16_t nbytes, const uint32_t gap) {
+  if (!_set(_count, type, true, 0, state, nbytes, kNoRepeat, gap))
+    return false;
+  _count++;
+  _dirty = true;
+  return true;
+}
+
+/// Change an existing simple (<= 64 bits) IR message in the sequence.
+/// @param[in] index Which message. The first is 0.
+/// @param[in] type Protocol number/type of the message.
+/// @param[in] data The data for the message.
+/// @param[in] nbits How many bits of `data` are in the message.
+/// @param[in] repeat How many times to repeat the message.
+/// @param[in] gap Min. nr. of uSecs of space after the message.
+/// @return true if successful, false if there is no such message.
+/// @note The sequence is only rendered again if the message is different.
+bool IRsendSequence::set(const uint8_t index, const decode_type_t type,
+                         const uint64_t data, const uint16_t nbits,
+                         const uint16_t repeat, const uint32_t gap) {
+  if (index >= _count) return false;
+  return _set(index, type, false, data, NULL, nbits, repeat, gap);
+}
+
+/// Change an existing complex (>= 64 bits) IR message in the sequence.
+/// @param[in] index Which message. The first is 0.
+/// @param[in] type Protocol number/type of the message.
+/// @param[in] state A pointer to the array of bytes that make up the state[].
+/// @param[in] nbytes How many bytes are in the state.
+/// @param[in] gap Min. nr. of uSecs of space after the message.
+/// @return true if successful, false if there is no such message, or the
+///   state is too big.
+/// @note The sequence is only rendered again if the message is different.
+bool IRsendSequence::set(const uint8_t index, const decode_type_t type,
+                         const uint8_t *state, const uint16_t nbytes,
+                         const uint32_t gap) {
+  if (index >= _count) return false;
+  return _set(index, type, true, 0, state, nbytes, kNoRepeat, gap);
+}
+
+/// Remove all the messages from the sequence.
+void IRsendSequence::clear(void) {
+  _count = 0;
+  _rendered.length = 0;
+  _dirty = true;
+  _valid = false;
+}
+
+/// Get the nr. of messages in the sequence.
+/// @return The nr. of messages.
+uint8_t IRsendSequence::length(void) { return _count; }
+
+/// Get a message in the sequence, & where it is in the rendered sequence.
+/// @param[in] index Which message. The first is 0.
+/// @return A ptr to the message, or NULL if there is no such message.
+/// @note `start`, `length`, `frequency`, & `dutycycle` are only valid after
+///   `render()`.
+const sequence_entry_t *IRsendSequence::getEntry(const uint8_t index) {
+  if (index >= _count) return NULL;
+  return &_entries[index];
+}
+
+/// Render the sequence into a single stream of marks & spaces, if it has
+/// changed since it was last rendered.
+/// Each message is followed by a space of at least its `gap`, or the
+/// protocol's own gap (e.g. `kNecMinGap`), whichever is longer.
+/// @return A ptr to the rendered sequence, or NULL if it didn't fit, or has
+///   an unsupported message.
+/// @note The `frequency` & `dutycycle` of the result are those of the last
+///   message. Use `getEntry()` for those of each message if they differ.
+const render_buffer_t *IRsendSequence::render(void) {
+  if (_rendered.buffer32 == NULL) return NULL;  // No buffer to render to.
+  if (!_dirty) return _valid ? &_rendered : NULL;
+  bool success = true;
+  _irsend->beginRender(&_rendered);
+  for (uint8_t i = 0; i < _count; i++) {
+    sequence_entry_t *entry = &_entries[i];
+    entry->start = _rendered.length;
+    if (entry->is_state)
+      success &= _irsend->send(entry->type, entry->state, entry->nbits);
+    else
+      success &= _irsend->send(entry->type, entry->data, entry->nbits,
+                               entry->repeat);
+    // Make the trailing space long enough. Always have one, so the next
+    // message's first mark stays separate from this message's last one.
+    const uint32_t trailing = (_rendered.length && !(_rendered.length & 1)) ?
+        _rendered.buffer32[_rendered.length - 1] : 0;
+    if (entry->gap > trailing)
+      _irsend->space(entry->gap - trailing);
+    else if (!trailing && !entry->gap)
+      _irsend->space(kDefaultMessageGap);
+    entry->length = _rendered.length - entry->start;
+    entry->frequency = _rendered.frequency;
+    entry->dutycycle = _rendered.dutycycle;
+  }
+  _valid = _irsend->endRender() && success;
+  _dirty = false;
+  return _valid ? &_rendered : NULL;
+}
+
+/// Send the whole sequence. It is rendered first, if it has changed.
+/// @return true if it was sent, false if it couldn't be rendered.
+bool IRsendSequence::send(void) {
+  if (render() == NULL) return false;
+  for (uint8_t i = 0; i < _count; i++) {
+    render_buffer_t message = _rendered;
+    message.buffer32 += _entries[i].start;
+    message.length = _entries[i].length;
+    message.frequency = _entries[i].frequency;
+    message.dutycycle = _entries[i].dutycycle;
+    _irsend->sendRendered(&message);
+  }
+  return true;
+}
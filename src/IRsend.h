@@ -7,6 +7,7 @@
 #define __STDC_LIMIT_MACROS
 #include <stdint.h>
 #include "IRremoteESP8266.h"
+#include "IRtimer.h"
 
 // Originally from https://github.com/shirriff/Arduino-IRremote/
 // Updated by markszabo (https://github.com/crankyoldgit/IRremoteESP8266) for
@@ -40,6 +41,87 @@ const uint16_t kMaxAccurateUsecDelay = 16383;
 //  Usecs to wait between messages we don't know the proper gap time.
 const uint32_t kDefaultMessageGap = 100000;
 
+/// Where `IRsend::render()` puts the timings of a message, instead of sending
+/// it. Set one of the buffers, & its `size`, before use. See `beginRender()`.
+typedef struct {
+  uint16_t *buffer16;  // Durations in uSecs. Longer than 65535us are clipped.
+  uint32_t *buffer32;  // Durations in uSecs. Used instead, if not NULL.
+  uint16_t size;       // Max. nr. of entries the buffer can hold.
+  uint16_t length;     // Nr. of entries rendered. The 1st, 3rd etc. are marks.
+  uint32_t usecs;      // Total time rendered so far.
+  uint32_t frequency;  // Modulation frequency, in Hz.
+  uint8_t dutycycle;   // Modulation duty cycle, in percent.
+  bool overflow;       // Was the buffer too small for the message?
+} render_buffer_t;
+
+// Default max. nr. of mark & space entries an `IRsendSequence` can render.
+const uint16_t kSequenceBufSize = 1024;
+// Max. nr. of entries (messages) in an `IRsendSequence`.
+const uint8_t kSequenceMaxEntries = 8;
+// Max. size of the state[] of an `IRsendSequence` entry. (See `kStateSizeMax`)
+const uint16_t kSequenceStateSize = kHitachiAc2StateLength;
+
+/// A message in an `IRsendSequence`.
+typedef struct {
+  decode_type_t type;  // Protocol number/type of the message.
+  bool is_state;       // Is it a complex (`state`) one, or a simple one?
+  uint64_t data;       // The data, if a simple message.
+  uint8_t state[kSequenceStateSize];  // The state[], if a complex message.
+  uint16_t nbits;      // Nr. of bits in `data`, or bytes in `state`.
+  uint16_t repeat;     // How many times to repeat a simple message.
+  uint32_t gap;        // Min. nr. of uSecs of space after it.
+  // Set by `IRsendSequence::render()`.
+  uint16_t start;      // Where in the rendered buffer the message starts.
+  uint16_t length;     // Nr. of mark & space entries rendered for it.
+  uint32_t frequency;  // Modulation frequency, in Hz.
+  uint8_t dutycycle;   // Modulation duty cycle, in percent.
+} sequence_entry_t;
+
+#if SEND_MULTI_PINS > 16
+#error "SEND_MULTI_PINS can't be more than 16."
+#endif
+
+#if SEND_MULTI_PINS
+// The highest GPIO `IRsend::setPins()` accepts. All the pins are switched at
+// once, by a single write to the GPIO set (or clear) register, so they must be
+// in it.
+#if defined(ESP8266)
+const uint8_t kSendMultiMaxGpio = 15;  // GPIO16 isn't in the GPIO registers.
+#elif defined(ESP32)
+const uint8_t kSendMultiMaxGpio = 33;  // The highest output capable GPIO.
+#else
+const uint8_t kSendMultiMaxGpio = 63;
+#endif
+#endif  // SEND_MULTI_PINS
+
+#if SEND_QUEUE_SLOTS
+// Max. nr. of mark & space entries in a message in the transmit queue.
+const uint16_t kSendQueueBufSize = 1024;
+// Spaces at least this long (uSecs) are waited for without blocking. Shorter
+// ones are part of a frame, so are sent in one go with the rest of it.
+const uint32_t kSendQueueYieldGap = 10000;
+
+/// Called when a queued message has been sent, or removed from the queue.
+/// @param[in] tag The value given to `IRsend::queue()` for the message.
+/// @param[in] sent true if it was sent, false if it was removed unsent.
+typedef void (*send_callback_t)(const uint32_t tag, const bool sent);
+
+/// The non-blocking transmit queue. See `IRsend::queue()` & `IRsend::poll()`.
+/// Slots `tail` onwards (`count` of them) hold the messages to send, oldest
+/// first.
+typedef struct {
+  uint32_t *buffer;  // All the slots' entries. `kSendQueueBufSize` per slot.
+  render_buffer_t message[SEND_QUEUE_SLOTS];
+  send_callback_t callback[SEND_QUEUE_SLOTS];
+  uint32_t tag[SEND_QUEUE_SLOTS];
+  uint8_t tail;      // The message being sent.
+  uint8_t count;     // Nr. of messages in the queue.
+  uint16_t index;    // Entry of the `tail` message to send next.
+  bool waiting;      // Are we waiting for a long space to finish?
+  IRtimer timer;     // How long we've waited for it.
+} send_queue_t;
+#endif  // SEND_QUEUE_SLOTS
+
 /// Enumerators and Structures for the Common A/C API.
 namespace stdAc {
   /// Common A/C settings for A/C operating modes.
@@ -114,6 +196,34 @@ namespace stdAc {
     int16_t sleep;
     int16_t clock;
   } state_t;
+
+  /// A bit-packed (8 byte) form of a `state_t`. e.g. For keeping lots of them,
+  /// storing them in RTC memory/flash, or comparing/hashing them quickly.
+  /// Temperatures are in half degrees. Values out of range are clamped.
+  /// See `IRac::packState()` & `IRac::unpackState()`.
+  union packed_state_t {
+    uint64_t raw;  ///< The whole state as a single integer.
+    struct {
+      uint64_t protocol:8;  // `decode_type_t` + 1.
+      uint64_t model:5;  // + 1. i.e. -1 to 30.
+      uint64_t power:1;
+      uint64_t mode:3;  // `opmode_t` + 1.
+      uint64_t degrees:8;  // Half degrees. i.e. 0 to 127.5 degrees.
+      uint64_t celsius:1;
+      uint64_t fanspeed:3;
+      uint64_t swingv:3;  // `swingv_t` + 1.
+      uint64_t swingh:3;  // `swingh_t` + 1.
+      uint64_t quiet:1;
+      uint64_t turbo:1;
+      uint64_t econo:1;
+      uint64_t light:1;
+      uint64_t filter:1;
+      uint64_t clean:1;
+      uint64_t beep:1;
+      uint64_t sleep:11;  // + 1. i.e. -1 to 2046.
+      uint64_t clock:11;  // + 1. i.e. -1 to 2046.
+    };
+  };
 };  // namespace stdAc
 
 /// Fujitsu A/C model numbers
@@ -171,6 +281,12 @@ class IRsend {
  public:
   explicit IRsend(uint16_t IRsendPin, bool inverted = false,
                   bool use_modulation = true);
+#if SEND_QUEUE_SLOTS
+  ~IRsend(void);
+  // The transmit queue's memory is owned by the object, so it can't be copied.
+  IRsend(const IRsend &) = delete;
+  IRsend &operator=(const IRsend &) = delete;
+#endif  // SEND_QUEUE_SLOTS
   void begin();
   void enableIROut(uint32_t freq, uint8_t duty = kDutyDefault);
   VIRTUAL void _delayMicroseconds(uint32_t usec);
@@ -214,12 +330,42 @@ class IRsend {
                    const uint8_t *dataptr, const uint16_t nbytes,
                    const uint16_t frequency, const bool MSBfirst,
                    const uint16_t repeat, const uint8_t dutycycle);
+  void sendGeneric(const protocol_timing_t *timing, const uint64_t data,
+                   const uint16_t nbits, const uint16_t repeat);
+  void sendGeneric(const protocol_timing_t *timing, const uint8_t *dataptr,
+                   const uint16_t nbytes, const uint16_t repeat);
   static uint16_t minRepeats(const decode_type_t protocol);
   static uint16_t defaultBits(const decode_type_t protocol);
   bool send(const decode_type_t type, const uint64_t data,
             const uint16_t nbits, const uint16_t repeat = kNoRepeat);
   bool send(const decode_type_t type, const uint8_t *state,
             const uint16_t nbytes);
+  void sendRendered(const render_buffer_t *message);
+  void beginRender(render_buffer_t *output);
+  bool endRender(void);
+  bool render(render_buffer_t *output, const decode_type_t type,
+              const uint64_t data, const uint16_t nbits,
+              const uint16_t repeat = kNoRepeat);
+  bool render(render_buffer_t *output, const decode_type_t type,
+              const uint8_t *state, const uint16_t nbytes);
+#if SEND_QUEUE_SLOTS
+  bool queue(const decode_type_t type, const uint64_t data,
+             const uint16_t nbits, const uint16_t repeat = kNoRepeat,
+             send_callback_t callback = NULL, const uint32_t tag = 0);
+  bool queue(const decode_type_t type, const uint8_t *state,
+             const uint16_t nbytes, send_callback_t callback = NULL,
+             const uint32_t tag = 0);
+  bool queue(const render_buffer_t *message, send_callback_t callback = NULL,
+             const uint32_t tag = 0);
+  bool poll(void);
+  uint8_t getQueueDepth(void);
+  void clearQueue(void);
+#endif  // SEND_QUEUE_SLOTS
+#if SEND_MULTI_PINS
+  bool setPins(const uint16_t pins[], const uint8_t count);
+  uint8_t getPinCount(void);
+  bool sendMerged(const render_buffer_t *streams[], const uint8_t count);
+#endif  // SEND_MULTI_PINS
 #if (SEND_NEC || SEND_SHERWOOD || SEND_AIWA_RC_T501 || SEND_SANYO || \
      SEND_MIDEA24)
   void sendNEC(uint64_t data, uint16_t nbits = kNECBits,
@@ -673,11 +819,72 @@ class IRsend {
   int8_t periodOffset;
   uint8_t _dutycycle;
   bool modulation;
+  render_buffer_t *_render;  // Where to render to, or NULL to transmit.
+#if SEND_QUEUE_SLOTS
+  send_queue_t _queue;
+  render_buffer_t *_queueSlot(void);
+  void _queueAdd(send_callback_t callback, const uint32_t tag);
+  void _queueRemove(const bool sent);
+#endif  // SEND_QUEUE_SLOTS
+#if SEND_MULTI_PINS
+  uint16_t _pins[SEND_MULTI_PINS];  // The GPIOs to use instead of `IRpin`.
+  uint8_t _npins;   // Nr. of them. 0 means just use `IRpin`.
+  uint16_t _active;  // Bit mask of the `_pins` that `ledOn()` turns on.
+  uint64_t _gpio_all;     // Bit mask of the GPIO nrs. of all the `_pins`.
+  uint64_t _gpio_active;  // Ditto, for just the `_active` ones.
+  void _setActive(const uint16_t active);
+  void _sendSegment(const uint16_t active, uint32_t usecs);
+#endif  // SEND_MULTI_PINS
   uint32_t calcUSecPeriod(uint32_t hz, bool use_offset = true);
+  void _renderPulse(const bool is_mark, const uint32_t usecs);
+  IRtimer _timer(void);
 #if SEND_SONY
   void _sendSony(const uint64_t data, const uint16_t nbits,
                  const uint16_t repeat, const uint16_t freq);
 #endif  // SEND_SONY
 };
 
+/// Class for sending a sequence of IR messages, e.g. "TV on", "HDMI 2",
+/// "Vol up", with precise gaps between them.
+/// The sequence is rendered once into a single stream of marks & spaces, & is
+/// only rendered again after it is changed.
+class IRsendSequence {
+ public:
+  explicit IRsendSequence(IRsend *irsend,
+                          const uint16_t size = kSequenceBufSize);
+  ~IRsendSequence(void);
+  // It owns its render buffer, so it can't be copied.
+  IRsendSequence(const IRsendSequence &) = delete;
+  IRsendSequence &operator=(const IRsendSequence &) = delete;
+  bool add(const decode_type_t type, const uint64_t data,
+           const uint16_t nbits, const uint16_t repeat = kNoRepeat,
+           const uint32_t gap = 0);
+  bool add(const decode_type_t type, const uint8_t *state,
+           const uint16_t nbytes, const uint32_t gap = 0);
+  bool set(const uint8_t index, const decode_type_t type,
+           const uint64_t data, const uint16_t nbits,
+           const uint16_t repeat = kNoRepeat, const uint32_t gap = 0);
+  bool set(const uint8_t index, const decode_type_t type,
+           const uint8_t *state, const uint16_t nbytes,
+           const uint32_t gap = 0);
+  void clear(void);
+  uint8_t length(void);
+  const sequence_entry_t *getEntry(const uint8_t index);
+  const render_buffer_t *render(void);
+  bool send(void);
+#ifndef UNIT_TEST
+
+ private:
+#endif  // UNIT_TEST
+  IRsend *_irsend;
+  sequence_entry_t _entries[kSequenceMaxEntries];
+  uint8_t _count;  // Nr. of `_entries` in use.
+  render_buffer_t _rendered;
+  bool _dirty;  // Has it changed since it was last rendered?
+  bool _valid;  // Did it render okay?
+  bool _set(const uint8_t index, const decode_type_t type, const bool is_state,
+            const uint64_t data, const uint8_t *state, const uint16_t nbits,
+            const uint16_t repeat, const uint32_t gap);
+};
+
 #endif  // IRSEND_H_
@@ -7,34 +7,42 @@
 
 #ifdef UNIT_TEST
 // Used to help simulate elapsed time in unit tests.
-uint32_t _IRtimer_unittest_now = 0;
-uint32_t _TimerMs_unittest_now = 0;
+// Per-thread, so host tools can simulate sending on several threads at once.
+thread_local uint32_t _IRtimer_unittest_now = 0;
+thread_local uint32_t _TimerMs_unittest_now = 0;
 #endif  // UNIT_TEST
 
 /// Class constructor.
-IRtimer::IRtimer() { reset(); }
+IRtimer::IRtimer() : source(NULL) { reset(); }
 
-/// Resets the IRtimer object. I.e. The counter starts again from now.
-void IRtimer::reset() {
+/// Class constructor for a timer that uses a different time source.
+/// e.g. The time rendered so far by `IRsend::render()`.
+/// @param[in] source Ptr to the current time, in uSeconds.
+///   NULL means use the system time.
+IRtimer::IRtimer(const uint32_t *source) : source(source) { reset(); }
+
+/// Get the current time of the timer's time source.
+/// @return The time in uSeconds.
+uint32_t IRtimer::now() {
+  if (source != NULL) return *source;
 #ifndef UNIT_TEST
-  start = micros();
+  return micros();
 #else
-  start = _IRtimer_unittest_now;
+  return _IRtimer_unittest_now;
 #endif
 }
 
+/// Resets the IRtimer object. I.e. The counter starts again from now.
+void IRtimer::reset() { start = now(); }
+
 /// Calculate how many microseconds have elapsed since the timer was started.
 /// @return Nr. of microseconds.
 uint32_t IRtimer::elapsed() {
-#ifndef UNIT_TEST
-  uint32_t now = micros();
-#else
-  uint32_t now = _IRtimer_unittest_now;
-#endif
-  if (start <= now)      // Check if the system timer has wrapped.
-    return now - start;  // No wrap.
+  uint32_t current = now();
+  if (start <= current)      // Check if the system timer has wrapped.
+    return current - start;  // No wrap.
   else
-    return UINT32_MAX - start + now;  // Has wrapped.
+    return UINT32_MAX - start + current;  // Has wrapped.
 }
 
 /// Add time to the timer to simulate elapsed time.
@@ -74,5 +82,5 @@ uint32_t TimerMs::elapsed() {
 /// @param[in] msecs Nr. of mSeconds to be added.
 /// @note Only used in unit testing.
 #ifdef UNIT_TEST
-void TimerMs::add(uint32_t msecs) { _IRtimer_unittest_now += msecs; }
+void TimerMs::add(uint32_t msecs) { _TimerMs_unittest_now += msecs; }
 #endif  // UNIT_TEST
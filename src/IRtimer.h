@@ -3,6 +3,7 @@
 #ifndef IRTIMER_H_
 #define IRTIMER_H_
 
+#include <stddef.h>
 #define __STDC_LIMIT_MACROS
 #include <stdint.h>
 
@@ -13,6 +14,7 @@
 class IRtimer {
  public:
   IRtimer();
+  explicit IRtimer(const uint32_t *source);
   void reset();
   uint32_t elapsed();
 #ifdef UNIT_TEST
@@ -21,6 +23,8 @@ class IRtimer {
 
  private:
   uint32_t start;  ///< Time in uSeconds when the class was instantiated/reset.
+  const uint32_t *source;  ///< Time (uSecs) to use instead of the system's.
+  uint32_t now();
 };
 
 /// This class offers a simple counter in milli-seconds since instantiated.
@@ -949,6 +949,60 @@ namespace irutils {
     return true;
   }
 
+  /// Encode capture buffer entries into the compact capture format.
+  /// Each entry takes 1 byte, quantised to units of `kCompactShift` kRawTicks,
+  /// or 3 bytes (`kCompactEscape`, then the exact value, MSB first) if it is
+  /// too large for that.
+  /// @param[in] rawbuf A ptr to the capture buffer entries to encode.
+  /// @param[in] rawlen The nr. of entries to encode.
+  /// @param[out] out A ptr to where to store the compact data.
+  /// @param[in] size The byte size of the `out` array.
+  /// @return The nr. of bytes used, or 0 if it didn't fit.
+  /// @see expandRaw()
+  uint16_t compactRaw(const volatile uint16_t * const rawbuf,
+                      const uint16_t rawlen, uint8_t * const out,
+                      const uint16_t size) {
+    uint16_t pos = 0;
+    for (uint16_t i = 0; i < rawlen; i++) {
+      const uint16_t ticks = rawbuf[i];
+      const uint32_t units = (ticks + (1U << (kCompactShift - 1))) >>
+          kCompactShift;
+      if (units < kCompactEscape) {
+        if (pos + 1 > size) return 0;
+        out[pos++] = units;
+      } else {
+        if (pos + 3 > size) return 0;
+        out[pos++] = kCompactEscape;
+        out[pos++] = ticks >> 8;
+        out[pos++] = ticks;
+      }
+    }
+    return pos;
+  }
+
+  /// Decode compact capture format data back into capture buffer entries.
+  /// @param[in] in A ptr to the compact data.
+  /// @param[in] size The nr. of bytes of compact data.
+  /// @param[out] rawbuf A ptr to where to store the capture buffer entries.
+  /// @param[in] bufsize The max nr. of entries to store in `rawbuf`.
+  /// @return The nr. of entries stored.
+  /// @note A truncated escape sequence at the end of the data is ignored.
+  /// @see compactRaw()
+  uint16_t expandRaw(const uint8_t * const in, const uint16_t size,
+                     volatile uint16_t * const rawbuf, const uint16_t bufsize) {
+    uint16_t rawlen = 0;
+    for (uint16_t pos = 0; pos < size && rawlen < bufsize; rawlen++) {
+      if (in[pos] != kCompactEscape) {
+        rawbuf[rawlen] = (uint16_t)in[pos++] << kCompactShift;
+      } else {
+        if (pos + 3 > size) break;
+        rawbuf[rawlen] = ((uint16_t)in[pos + 1] << 8) | in[pos + 2];
+        pos += 3;
+      }
+    }
+    return rawlen;
+  }
+
   /// Perform a low lovel bit manipulation sanity check for the given cpu
   /// architecture and the compiler operation. Calls to this should return
   /// 0 if everything is as expected, anything else means the library won't work
@@ -109,6 +109,11 @@ namespace irutils {
                const uint64_t data);
   uint8_t * invertBytePairs(uint8_t *ptr, const uint16_t length);
   bool checkInvertedBytePairs(const uint8_t * const ptr, const uint16_t length);
+  uint16_t compactRaw(const volatile uint16_t * const rawbuf,
+                      const uint16_t rawlen, uint8_t * const out,
+                      const uint16_t size);
+  uint16_t expandRaw(const uint8_t * const in, const uint16_t size,
+                     volatile uint16_t * const rawbuf, const uint16_t bufsize);
   uint8_t lowLevelSanityCheck(void);
 }  // namespace irutils
 #endif  // IRUTILS_H_
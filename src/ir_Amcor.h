@@ -91,6 +91,11 @@ class IRAmcorAc {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif  // SEND_AMCOR
   void begin();
   static uint8_t calcChecksum(const uint8_t state[],
@@ -130,6 +130,7 @@ class IRArgoAC {
  public:
   explicit IRArgoAC(const uint16_t pin, const bool inverted = false,
                     const bool use_modulation = true);
+  void stateReset(void);
 
 #if SEND_ARGO
   void send(const uint16_t repeat = kArgoDefaultRepeat);
@@ -138,6 +139,11 @@ class IRArgoAC {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif  // SEND_ARGO
   void begin(void);
   void on(void);
@@ -195,7 +201,6 @@ class IRArgoAC {
 #endif
   // # of bytes per command
   uint8_t argo[kArgoStateLength];  // Defined in IRremoteESP8266.h
-  void stateReset(void);
   void checksum(void);
 
   // Attributes
@@ -527,6 +527,7 @@ class IRDaikinESP {
  public:
   explicit IRDaikinESP(const uint16_t pin, const bool inverted = false,
                        const bool use_modulation = true);
+  void stateReset(void);
 
 #if SEND_DAIKIN
   void send(const uint16_t repeat = kDaikinDefaultRepeat);
@@ -535,6 +536,11 @@ class IRDaikinESP {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif
   void begin(void);
   void on(void);
@@ -599,7 +605,6 @@ class IRDaikinESP {
 #endif
   // # of bytes per command
   uint8_t remote[kDaikinStateLength];  ///< The state of the IR remote.
-  void stateReset(void);
   void checksum(void);
 };
 
@@ -609,6 +614,7 @@ class IRDaikin2 {
  public:
   explicit IRDaikin2(const uint16_t pin, const bool inverted = false,
                      const bool use_modulation = true);
+  void stateReset();
 
 #if SEND_DAIKIN2
   void send(const uint16_t repeat = kDaikin2DefaultRepeat);
@@ -617,6 +623,11 @@ class IRDaikin2 {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif
   void begin();
   void on();
@@ -694,7 +705,6 @@ class IRDaikin2 {
 #endif
   // # of bytes per command
   uint8_t remote_state[kDaikin2StateLength];  ///< The state of the IR remote.
-  void stateReset();
   void checksum();
   void clearOnTimerFlag();
   void clearSleepTimerFlag();
@@ -705,6 +715,7 @@ class IRDaikin216 {
  public:
   explicit IRDaikin216(const uint16_t pin, const bool inverted = false,
                        const bool use_modulation = true);
+  void stateReset();
 
 #if SEND_DAIKIN216
   void send(const uint16_t repeat = kDaikin216DefaultRepeat);
@@ -713,6 +724,11 @@ class IRDaikin216 {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif
   void begin();
   uint8_t* getRaw();
@@ -752,7 +768,6 @@ class IRDaikin216 {
 #endif
   // # of bytes per command
   uint8_t remote_state[kDaikin216StateLength];  ///< The state of the IR remote.
-  void stateReset();
   void checksum();
 };
 
@@ -761,6 +776,7 @@ class IRDaikin160 {
  public:
   explicit IRDaikin160(const uint16_t pin, const bool inverted = false,
                        const bool use_modulation = true);
+  void stateReset();
 
 #if SEND_DAIKIN160
   void send(const uint16_t repeat = kDaikin160DefaultRepeat);
@@ -769,6 +785,11 @@ class IRDaikin160 {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif
   void begin();
   uint8_t* getRaw();
@@ -804,7 +825,6 @@ class IRDaikin160 {
 #endif
   // # of bytes per command
   uint8_t remote_state[kDaikin160StateLength];  ///< The state of the IR remote.
-  void stateReset();
   void checksum();
 };
 
@@ -813,6 +833,7 @@ class IRDaikin176 {
  public:
   explicit IRDaikin176(const uint16_t pin, const bool inverted = false,
                        const bool use_modulation = true);
+  void stateReset();
 
 #if SEND_DAIKIN176
   void send(const uint16_t repeat = kDaikin176DefaultRepeat);
@@ -821,6 +842,11 @@ class IRDaikin176 {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif
   void begin();
   uint8_t* getRaw();
@@ -860,7 +886,6 @@ class IRDaikin176 {
   // # of bytes per command
   uint8_t remote_state[kDaikin176StateLength];  ///< The state of the IR remote.
   uint8_t _saved_temp;
-  void stateReset();
   void checksum();
 };
 
@@ -870,6 +895,7 @@ class IRDaikin128 {
  public:
   explicit IRDaikin128(const uint16_t pin, const bool inverted = false,
                        const bool use_modulation = true);
+  void stateReset(void);
 #if SEND_DAIKIN128
   void send(const uint16_t repeat = kDaikin128DefaultRepeat);
   /// Run the calibration to calculate uSec timing offsets for this platform.
@@ -877,6 +903,11 @@ class IRDaikin128 {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif  // SEND_DAIKIN128
   void begin();
   void setPowerToggle(const bool toggle);
@@ -929,7 +960,6 @@ class IRDaikin128 {
 #endif
   // # of bytes per command
   uint8_t remote_state[kDaikin128StateLength];  ///< The state of the IR remote.
-  void stateReset(void);
   static uint8_t calcFirstChecksum(const uint8_t state[]);
   static uint8_t calcSecondChecksum(const uint8_t state[]);
   static void setTimer(uint8_t *ptr, const uint16_t mins_since_midnight);
@@ -944,6 +974,7 @@ class IRDaikin152 {
  public:
   explicit IRDaikin152(const uint16_t pin, const bool inverted = false,
                        const bool use_modulation = true);
+  void stateReset();
 
 #if SEND_DAIKIN152
   void send(const uint16_t repeat = kDaikin152DefaultRepeat);
@@ -952,6 +983,11 @@ class IRDaikin152 {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif
   void begin();
   uint8_t* getRaw();
@@ -995,7 +1031,6 @@ class IRDaikin152 {
 #endif
   // # of bytes per command
   uint8_t remote_state[kDaikin152StateLength];  ///< The state of the IR remote.
-  void stateReset();
   void checksum();
 };
 
@@ -1004,6 +1039,7 @@ class IRDaikin64 {
  public:
   explicit IRDaikin64(const uint16_t pin, const bool inverted = false,
                        const bool use_modulation = true);
+  void stateReset();
 
 #if SEND_DAIKIN64
   void send(const uint16_t repeat = kDaikin64DefaultRepeat);
@@ -1012,6 +1048,11 @@ class IRDaikin64 {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif  // SEND_DAIKIN64
   void begin();
   uint64_t getRaw();
@@ -1060,7 +1101,6 @@ class IRDaikin64 {
   /// @endcond
 #endif
   uint64_t remote_state;  ///< The state of the IR remote.
-  void stateReset();
   void checksum();
 };
 #endif  // IR_DAIKIN_H_
@@ -229,6 +229,7 @@ class IRHaierAC {
  public:
   explicit IRHaierAC(const uint16_t pin, const bool inverted = false,
                      const bool use_modulation = true);
+  void stateReset(void);
 #if SEND_HAIER_AC
   void send(const uint16_t repeat = kHaierAcDefaultRepeat);
   /// Run the calibration to calculate uSec timing offsets for this platform.
@@ -236,6 +237,11 @@ class IRHaierAC {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif  // SEND_HAIER_AC
   void begin(void);
 
@@ -290,7 +296,6 @@ class IRHaierAC {
   /// @endcond
 #endif
   HaierProtocol _;
-  void stateReset(void);
   void checksum(void);
 };
 
@@ -299,6 +304,7 @@ class IRHaierACYRW02 {
  public:
   explicit IRHaierACYRW02(const uint16_t pin, const bool inverted = false,
                           const bool use_modulation = true);
+  void stateReset(void);
 #if SEND_HAIER_AC_YRW02
   void send(const uint16_t repeat = kHaierAcYrw02DefaultRepeat);
   /// Run the calibration to calculate uSec timing offsets for this platform.
@@ -306,6 +312,11 @@ class IRHaierACYRW02 {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif  // SEND_HAIER_AC_YRW02
   void begin(void);
 
@@ -359,7 +370,6 @@ class IRHaierACYRW02 {
   /// @endcond
 #endif  // UNIT_TEST
   uint8_t remote_state[kHaierACYRW02StateLength];  ///< The state in native form
-  void stateReset(void);
   void checksum(void);
 };
 #endif  // IR_HAIER_H_
@@ -197,6 +197,11 @@ class IRHitachiAc {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif  // SEND_HITACHI_AC
   void begin(void);
   void on(void);
@@ -255,6 +260,11 @@ class IRHitachiAc1 {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif  // SEND_HITACHI_AC1
   void begin(void);
   void on(void);
@@ -315,6 +325,7 @@ class IRHitachiAc424 {
  public:
   explicit IRHitachiAc424(const uint16_t pin, const bool inverted = false,
                        const bool use_modulation = true);
+  virtual ~IRHitachiAc424(void) {}
   virtual void stateReset(void);
 #if SEND_HITACHI_AC424
   virtual void send(const uint16_t repeat = kHitachiAcDefaultRepeat);
@@ -323,6 +334,11 @@ class IRHitachiAc424 {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif  // SEND_HITACHI_AC424
   void begin(void);
   void on(void);
@@ -47,7 +47,7 @@ void IRsend::sendJVC(uint64_t data, uint16_t nbits, uint16_t repeat) {
   // Set 38kHz IR carrier frequency & a 1/3 (33%) duty cycle.
   enableIROut(38, 33);
 
-  IRtimer usecs = IRtimer();
+  IRtimer usecs = _timer();
   // Header
   // Only sent for the first message.
   mark(kJvcHdrMark);
@@ -19,8 +19,6 @@ const uint32_t kLasertagMinGap = kDefaultMessageGap;  // Just a guess.
 const uint8_t kLasertagTolerance = 0;     // Percentage error margin.
 const uint16_t kLasertagExcess = 0;       // See kMarkExcess.
 const uint16_t kLasertagDelta = 150;  // Use instead of Excess and Tolerance.
-const int16_t kSpace = 1;
-const int16_t kMark = 0;
 
 #if SEND_LASERTAG
 /// Send a Lasertag packet/message.
@@ -77,26 +75,19 @@ bool IRrecv::decodeLasertag(decode_results *results, uint16_t offset,
   uint16_t used = 0;
   uint64_t data = 0;
   uint16_t actual_bits = 0;
+  const manchester_timing_t timing = _manchesterTiming(
+      kLasertagTick, kLasertagTolerance, kLasertagExcess, kLasertagDelta);
 
   // No Header
 
   // Data
   for (; offset <= results->rawlen; actual_bits++) {
-    int16_t levelA =
-        getRClevel(results, &offset, &used, kLasertagTick, kLasertagTolerance,
-                   kLasertagExcess, kLasertagDelta);
-    int16_t levelB =
-        getRClevel(results, &offset, &used, kLasertagTick, kLasertagTolerance,
-                   kLasertagExcess, kLasertagDelta);
-    if (levelA == kSpace && levelB == kMark) {
-      data = (data << 1) | 1;  // 1
-    } else {
-      if (levelA == kMark && levelB == kSpace) {
-        data <<= 1;  // 0
-      } else {
-        break;
-      }
-    }
+    int16_t levelA = _manchesterLevel(results, &offset, &used, &timing);
+    int16_t levelB = _manchesterLevel(results, &offset, &used, &timing);
+    // IEEE 802.3 convention. i.e. A space then a mark is a 1.
+    const int8_t bit = _manchesterBit(levelA, levelB, false);
+    if (bit < 0) break;
+    data = (data << 1) | bit;
   }
   // Footer (None)
 
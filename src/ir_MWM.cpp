@@ -23,8 +23,6 @@ const uint16_t kMWMExcess = 0;      // See kMarkExcess.
 const uint16_t kMWMDelta = 150;     // Use instead of Excess and Tolerance.
 const uint8_t kMWMMaxWidth = 9;     // Maximum number of successive bits at a
                                     // single level - worst case
-const int16_t kSpace = 1;
-const int16_t kMark = 0;
 
 #if SEND_MWM
 /// Send a MWM packet/message.
@@ -92,6 +90,8 @@ bool IRrecv::decodeMWM(decode_results *results, uint16_t offset,
   uint64_t data = 0;
   uint16_t frame_bits = 0;
   uint16_t data_bits = 0;
+  const manchester_timing_t timing = _manchesterTiming(
+      kMWMTick, kMWMTolerance, kMWMExcess, kMWMDelta, kMWMMaxWidth);
 
   // No Header
 
@@ -101,10 +101,9 @@ bool IRrecv::decodeMWM(decode_results *results, uint16_t offset,
        frame_bits++) {
     DPRINT("DEBUG: decodeMWM: offset = ");
     DPRINTLN(offset);
-    int16_t level = getRClevel(results, &offset, &used, kMWMTick, kMWMTolerance,
-                               kMWMExcess, kMWMDelta, kMWMMaxWidth);
+    int16_t level = _manchesterLevel(results, &offset, &used, &timing);
     if (level < 0) {
-      DPRINTLN("DEBUG: decodeMWM: getRClevel returned error");
+      DPRINTLN("DEBUG: decodeMWM: _manchesterLevel returned error");
       break;
     }
     switch (frame_bits % bits_per_frame) {
@@ -28,6 +28,14 @@ const uint16_t kNikaiZeroSpace = kNikaiZeroSpaceTicks * kNikaiTick;
 const uint16_t kNikaiMinGapTicks = 17;
 const uint16_t kNikaiMinGap = kNikaiMinGapTicks * kNikaiTick;
 
+const protocol_timing_t kNikaiTiming = {
+    decode_type_t::NIKAI, kNikaiBits,
+    kNikaiHdrMark, kNikaiHdrSpace,
+    kNikaiBitMark, kNikaiOneSpace,
+    kNikaiBitMark, kNikaiZeroSpace,
+    kNikaiBitMark, kNikaiMinGap, 0,
+    38, 33, true, kNoRepeat, kUseDefTol};
+
 #if SEND_NIKAI
 /// Send a Nikai formatted message.
 /// Status: STABLE / Working.
@@ -35,9 +43,7 @@ const uint16_t kNikaiMinGap = kNikaiMinGapTicks * kNikaiTick;
 /// @param[in] nbits The number of bits of message to be sent.
 /// @param[in] repeat The number of times the command is to be repeated.
 void IRsend::sendNikai(uint64_t data, uint16_t nbits, uint16_t repeat) {
-  sendGeneric(kNikaiHdrMark, kNikaiHdrSpace, kNikaiBitMark, kNikaiOneSpace,
-              kNikaiBitMark, kNikaiZeroSpace, kNikaiBitMark, kNikaiMinGap, data,
-              nbits, 38, true, repeat, 33);
+  sendGeneric(&kNikaiTiming, data, nbits, repeat);
 }
 #endif  // SEND_NIKAI
 
@@ -51,24 +57,7 @@ void IRsend::sendNikai(uint64_t data, uint16_t nbits, uint16_t repeat) {
 /// @param[in] strict Flag indicating if we should perform strict matching.
 bool IRrecv::decodeNikai(decode_results *results, uint16_t offset,
                          const uint16_t nbits, const bool strict) {
-  if (strict && nbits != kNikaiBits)
-    return false;  // We expect Nikai to be a certain sized message.
-
-  uint64_t data = 0;
-
-  // Match Header + Data + Footer
-  if (!matchGeneric(results->rawbuf + offset, &data,
-                    results->rawlen - offset, nbits,
-                    kNikaiHdrMark, kNikaiHdrSpace,
-                    kNikaiBitMark, kNikaiOneSpace,
-                    kNikaiBitMark, kNikaiZeroSpace,
-                    kNikaiBitMark, kNikaiMinGap, true)) return false;
-  // Success
-  results->bits = nbits;
-  results->value = data;
-  results->decode_type = NIKAI;
-  results->command = 0;
-  results->address = 0;
-  return true;
+  // We expect Nikai to be a certain sized message.
+  return decodeGeneric(results, offset, &kNikaiTiming, nbits, strict);
 }
 #endif  // DECODE_NIKAI
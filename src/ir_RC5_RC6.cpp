@@ -43,10 +43,6 @@ const uint32_t kRc6RptLength = kRc6RptLengthTicks * kRc6Tick;
 const uint32_t kRc6ToggleMask = 0x10000UL;  // The 17th bit.
 const uint16_t kRc6_36ToggleMask = 0x8000;  // The 16th bit.
 
-// Common (getRClevel())
-const int16_t kMark = 0;
-const int16_t kSpace = 1;
-
 #if SEND_RC5
 /// Send a Philips RC-5/RC-5X packet.
 /// Status: RC-5 (stable), RC-5X (alpha)
@@ -72,7 +68,7 @@ void IRsend::sendRC5(const uint64_t data, uint16_t nbits,
     nbits--;
   }
 
-  IRtimer usecTimer = IRtimer();
+  IRtimer usecTimer = _timer();
   for (uint16_t i = 0; i <= repeat; i++) {
     usecTimer.reset();
 
@@ -221,7 +217,7 @@ void IRsend::sendRC6(const uint64_t data, const uint16_t nbits,
 }
 #endif  // SEND_RC6
 
-#if (DECODE_RC5 || DECODE_RC6 || DECODE_LASERTAG)
+#if (DECODE_RC5 || DECODE_RC6 || DECODE_LASERTAG || DECODE_MWM)
 /// Gets one undecoded level at a time from the raw buffer.
 /// The RC5/6 decoding is easier if the data is broken into time intervals.
 /// E.g. if the buffer has MARK for 2 time intervals and SPACE for 1,
@@ -239,60 +235,18 @@ void IRsend::sendRC6(const uint64_t data, const uint16_t nbits,
 ///   level (default is 3)
 /// @return MARK, SPACE, or -1 for error.
 ///   (The measured time interval is not a  multiple of t1.)
+/// @note Decoders should use `_manchesterLevel()` with timings computed once
+///   by `_manchesterTiming()`, rather than this, as it is much faster.
 /// @see https://en.wikipedia.org/wiki/Manchester_code
 int16_t IRrecv::getRClevel(decode_results *results, uint16_t *offset,
                            uint16_t *used, const uint16_t bitTime,
                            const uint8_t tolerance, const int16_t excess,
                            const uint16_t delta, const uint8_t maxwidth) {
-  DPRINT("DEBUG: getRClevel: offset = ");
-  DPRINTLN(uint64ToString(*offset));
-  DPRINT("DEBUG: getRClevel: rawlen = ");
-  DPRINTLN(uint64ToString(results->rawlen));
-  if (*offset >= results->rawlen) {
-    DPRINTLN("DEBUG: getRClevel: SPACE, past end of rawbuf");
-    return kSpace;  // After end of recorded buffer, assume SPACE.
-  }
-  uint16_t width = results->rawbuf[*offset];
-  //  If the value of offset is odd, it's a MARK. Even, it's a SPACE.
-  uint16_t val = ((*offset) % 2) ? kMark : kSpace;
-  // Check to see if we have hit an inter-message gap (> 20ms).
-  if (val == kSpace &&
-      (width > 20000 - delta || width > maxwidth * bitTime + delta)) {
-    DPRINTLN("DEBUG: getRClevel: SPACE, hit end of mesg gap.");
-    return kSpace;
-  }
-  int16_t correction = (val == kMark) ? excess : -excess;
-
-  // Calculate the look-ahead for our current position in the buffer.
-  uint16_t avail;
-  // Note: We want to match in greedy order as the other way leads to
-  //       mismatches due to overlaps induced by the correction and tolerance
-  //       values.
-  for (avail = maxwidth; avail > 0; avail--) {
-    if (match(width, avail * bitTime + correction, tolerance, delta)) {
-      break;
-    }
-  }
-  if (!avail) {
-    DPRINTLN("DEBUG: getRClevel: Unexpected width. Exiting.");
-    return -1;  // The width is not what we expected.
-  }
-
-  (*used)++;             // Count another one of the avail slots as used.
-  if (*used >= avail) {  // Are we out of look-ahead/avail slots?
-    // Yes, so reset the used counter, and move the offset ahead.
-    *used = 0;
-    (*offset)++;
-  }
-  if (val == kMark) {
-    DPRINTLN("DEBUG: getRClevel: MARK");
-  } else {
-    DPRINTLN("DEBUG: getRClevel: SPACE");
-  }
-
-  return val;
+  const manchester_timing_t timing = _manchesterTiming(bitTime, tolerance,
+                                                       excess, delta, maxwidth);
+  return _manchesterLevel(results, offset, used, &timing);
 }
-#endif  // (DECODE_RC5 || DECODE_RC6 || DECODE_LASERTAG)
+#endif  // (DECODE_RC5 || DECODE_RC6 || DECODE_LASERTAG || DECODE_MWM)
 
 #if DECODE_RC5
 /// Decode the supplied RC-5/RC5X message.
@@ -317,34 +271,36 @@ bool IRrecv::decodeRC5(decode_results *results, uint16_t offset,
   uint16_t used = 0;
   bool is_rc5x = false;
   uint64_t data = 0;
+  const manchester_timing_t timing = _manchesterTiming(kRc5T1);
 
   // Header
   // Get start bit #1.
-  if (getRClevel(results, &offset, &used, kRc5T1) != kMark) return false;
+  if (_manchesterLevel(results, &offset, &used, &timing) != kMark)
+    return false;
   // Get field/start bit #2 (inverted bit-7 of the command if RC-5X protocol)
   uint16_t actual_bits = 1;
-  int16_t levelA = getRClevel(results, &offset, &used, kRc5T1);
-  int16_t levelB = getRClevel(results, &offset, &used, kRc5T1);
-  if (levelA == kSpace && levelB == kMark) {  // Matched a 1.
-    is_rc5x = false;
-  } else if (levelA == kMark && levelB == kSpace) {  // Matched a 0.
-    if (nbits <= kRC5Bits) return false;  // Field bit must be '1' for RC5.
-    is_rc5x = true;
-    data = 1;
-  } else {
-    return false;  // Not what we expected.
+  int16_t levelA = _manchesterLevel(results, &offset, &used, &timing);
+  int16_t levelB = _manchesterLevel(results, &offset, &used, &timing);
+  switch (_manchesterBit(levelA, levelB, false)) {  // IEEE 802.3 convention.
+    case 1:
+      is_rc5x = false;
+      break;
+    case 0:
+      if (nbits <= kRC5Bits) return false;  // Field bit must be '1' for RC5.
+      is_rc5x = true;
+      data = 1;
+      break;
+    default:
+      return false;  // Not what we expected.
   }
 
   // Data
   for (; offset < results->rawlen; actual_bits++) {
-    int16_t levelA = getRClevel(results, &offset, &used, kRc5T1);
-    int16_t levelB = getRClevel(results, &offset, &used, kRc5T1);
-    if (levelA == kSpace && levelB == kMark)
-      data = (data << 1) | 1;  // 1
-    else if (levelA == kMark && levelB == kSpace)
-      data <<= 1;  // 0
-    else
-      break;
+    levelA = _manchesterLevel(results, &offset, &used, &timing);
+    levelB = _manchesterLevel(results, &offset, &used, &timing);
+    const int8_t bit = _manchesterBit(levelA, levelB, false);
+    if (bit < 0) break;
+    data = (data << 1) | bit;
   }
   // Footer (None)
 
@@ -412,10 +368,13 @@ bool IRrecv::decodeRC6(decode_results *results, uint16_t offset,
     return false;
 
   uint16_t used = 0;
+  const manchester_timing_t timing = _manchesterTiming(tick);
 
   // Get the start bit. e.g. 1.
-  if (getRClevel(results, &offset, &used, tick) != kMark) return false;
-  if (getRClevel(results, &offset, &used, tick) != kSpace) return false;
+  if (_manchesterLevel(results, &offset, &used, &timing) != kMark)
+    return false;
+  if (_manchesterLevel(results, &offset, &used, &timing) != kSpace)
+    return false;
 
   uint16_t actual_bits;
   uint64_t data = 0;
@@ -423,20 +382,20 @@ bool IRrecv::decodeRC6(decode_results *results, uint16_t offset,
   // Data (Warning: Here be dragons^Wpointers!!)
   for (actual_bits = 0; offset < results->rawlen; actual_bits++) {
     int16_t levelA, levelB;  // Next two levels
-    levelA = getRClevel(results, &offset, &used, tick);
+    levelA = _manchesterLevel(results, &offset, &used, &timing);
     // T bit is double wide; make sure second half matches
-    if (actual_bits == 3 && levelA != getRClevel(results, &offset, &used, tick))
+    if (actual_bits == 3 &&
+        levelA != _manchesterLevel(results, &offset, &used, &timing))
       return false;
-    levelB = getRClevel(results, &offset, &used, tick);
+    levelB = _manchesterLevel(results, &offset, &used, &timing);
     // T bit is double wide; make sure second half matches
-    if (actual_bits == 3 && levelB != getRClevel(results, &offset, &used, tick))
+    if (actual_bits == 3 &&
+        levelB != _manchesterLevel(results, &offset, &used, &timing))
       return false;
-    if (levelA == kMark && levelB == kSpace)  // reversed compared to RC5
-      data = (data << 1) | 1;                 // 1
-    else if (levelA == kSpace && levelB == kMark)
-      data <<= 1;  // 0
-    else
-      break;
+    // G.E. Thomas convention. i.e. Reversed compared to RC5.
+    const int8_t bit = _manchesterBit(levelA, levelB, true);
+    if (bit < 0) break;
+    data = (data << 1) | bit;
   }
 
   // More compliance
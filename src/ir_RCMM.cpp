@@ -46,7 +46,7 @@ const uint16_t kRcmmExcess = 50;
 void IRsend::sendRCMM(uint64_t data, uint16_t nbits, uint16_t repeat) {
   // Set 36kHz IR carrier frequency & a 1/3 (33%) duty cycle.
   enableIROut(36, 33);
-  IRtimer usecs = IRtimer();
+  IRtimer usecs = _timer();
 
   for (uint16_t r = 0; r <= repeat; r++) {
     usecs.reset();
@@ -109,6 +109,7 @@ class IRSharpAc {
  public:
   explicit IRSharpAc(const uint16_t pin, const bool inverted = false,
                      const bool use_modulation = true);
+  void stateReset(void);
 #if SEND_SHARP_AC
   void send(const uint16_t repeat = kSharpAcDefaultRepeat);
   /// Run the calibration to calculate uSec timing offsets for this platform.
@@ -116,6 +117,11 @@ class IRSharpAc {
   /// @note This will produce a 65ms IR signal pulse at 38kHz.
   ///   Only ever needs to be run once per object instantiation, if at all.
   int8_t calibrate(void) { return _irsend.calibrate(); }
+#if IRAC_CACHE_SLOTS
+  /// Render messages into a buffer, rather than sending them. For `IRac`.
+  /// @param[in,out] output Where to render to, or NULL to send them again.
+  void renderTo(render_buffer_t *output) { _irsend.beginRender(output); }
+#endif  // IRAC_CACHE_SLOTS
 #endif  // SEND_SHARP_AC
   void begin(void);
   void on(void);
@@ -169,7 +175,6 @@ class IRSharpAc {
   uint8_t _temp;  ///< Saved copy of the desired temp.
   uint8_t _mode;  ///< Saved copy of the desired mode.
   uint8_t _fan;  ///< Saved copy of the desired fan speed.
-  void stateReset(void);
   void checksum(void);
   static uint8_t calcChecksum(uint8_t state[],
                               const uint16_t length = kSharpAcStateLength);
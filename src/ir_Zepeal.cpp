@@ -27,6 +27,14 @@ const uint16_t kZepealGap = 6750;
 
 const uint8_t  kZepealTolerance = 40;
 
+const protocol_timing_t kZepealTiming = {
+    decode_type_t::ZEPEAL, kZepealBits,
+    kZepealHdrMark, kZepealHdrSpace,
+    kZepealOneMark, kZepealOneSpace,
+    kZepealZeroMark, kZepealZeroSpace,
+    kZepealFooterMark, kZepealGap, 0,
+    38, kDutyDefault, true, kZepealMinRepeat, kZepealTolerance};
+
 // Signature limits possible false possitvies,
 // but might need change (removal) if more devices are detected
 const uint8_t kZepealSignature = 0x6C;
@@ -46,11 +54,7 @@ const uint16_t kZepealCommandOnTimer =  0x6CC3;
 /// @param[in] repeat The number of times the message is to be repeated.
 void IRsend::sendZepeal(const uint64_t data, const uint16_t nbits,
                         const uint16_t repeat) {
-  sendGeneric(kZepealHdrMark, kZepealHdrSpace,
-              kZepealOneMark, kZepealOneSpace,
-              kZepealZeroMark, kZepealZeroSpace,
-              kZepealFooterMark, kZepealGap,
-              data, nbits, 38, true, repeat, kDutyDefault);
+  sendGeneric(&kZepealTiming, data, nbits, repeat);
 }
 #endif  // SEND_ZEPEAL
 
@@ -72,15 +76,9 @@ bool IRrecv::decodeZepeal(decode_results *results, uint16_t offset,
     return false;  // Not strictly a message.
 
   uint64_t data = 0;
-  uint16_t used;
-  used = matchGeneric(results->rawbuf + offset, &data,
-                      results->rawlen - offset, nbits,
-                      kZepealHdrMark, kZepealHdrSpace,
-                      kZepealOneMark, kZepealOneSpace,
-                      kZepealZeroMark, kZepealZeroSpace,
-                      kZepealFooterMark, kZepealGap, true,
-                      kZepealTolerance);
-  if (!used) return false;
+  if (!matchGeneric(results->rawbuf + offset, &data,
+                    results->rawlen - offset, nbits, &kZepealTiming))
+    return false;
   if (strict && (data >> 8) != kZepealSignature) return false;
 
   // Success
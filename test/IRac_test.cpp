@@ -1623,6 +1623,50 @@ TEST(TestIRac, cmpStates) {
   ASSERT_TRUE(IRac::cmpStates(a, b));
 }
 
+TEST(TestIRac, PackedState) {
+  EXPECT_EQ(8, sizeof(stdAc::packed_state_t));
+  stdAc::state_t a;
+  IRac::initState(&a, decode_type_t::PANASONIC_AC,
+                  panasonic_ac_remote_model_t::kPanasonicRkr, true,
+                  stdAc::opmode_t::kHeat, 22.5, true,
+                  stdAc::fanspeed_t::kMax, stdAc::swingv_t::kLowest,
+                  stdAc::swingh_t::kWide, true, false, true, false, true,
+                  false, true, 1439, 1439);
+  stdAc::packed_state_t packed = IRac::packState(a);
+  stdAc::state_t b = IRac::unpackState(packed);
+  EXPECT_FALSE(IRac::cmpStates(a, b));
+  EXPECT_EQ(a.clock, b.clock);
+
+  // The lowest values.
+  IRac::initState(&a, decode_type_t::UNKNOWN, -1, false,
+                  stdAc::opmode_t::kOff, 0, false, stdAc::fanspeed_t::kAuto,
+                  stdAc::swingv_t::kOff, stdAc::swingh_t::kOff, false, false,
+                  false, false, false, false, false, -1, -1);
+  b = IRac::unpackState(IRac::packState(a));
+  EXPECT_FALSE(IRac::cmpStates(a, b));
+  EXPECT_EQ(-1, b.clock);
+
+  // Half degree steps, & values out of range are clamped.
+  a.degrees = 72.3;
+  a.sleep = 3000;
+  b = IRac::unpackState(IRac::packState(a));
+  EXPECT_EQ(72.5, b.degrees);
+  EXPECT_EQ(2046, b.sleep);
+
+  // Comparing them matches comparing state_t's. i.e. Excludes the clock.
+  a.degrees = 24;
+  b = a;
+  b.clock = 600;
+  EXPECT_FALSE(IRac::cmpStates(IRac::packState(a), IRac::packState(b)));
+  EXPECT_NE(IRac::packState(a).raw, IRac::packState(b).raw);
+  b.econo = true;
+  EXPECT_TRUE(IRac::cmpStates(IRac::packState(a), IRac::packState(b)));
+  EXPECT_NE(IRac::hashState(IRac::packState(a)),
+            IRac::hashState(IRac::packState(b)));
+  EXPECT_EQ(IRac::hashState(IRac::packState(a)),
+            IRac::hashState(IRac::packState(a)));
+}
+
 TEST(TestIRac, handleToggles) {
   stdAc::state_t desired, prev, result;
   desired.protocol = decode_type_t::COOLIX;
@@ -2072,3 +2116,311 @@ TEST(TestIRac, Issue1035) {
   ASSERT_TRUE(IRAcUtils::decodeToState(&ac._irsend.capture, &result, &prev));
   ASSERT_FALSE(result.power);
 }
+
+#if IRAC_POOL_SLOTS
+TEST(TestIRac, ObjectPool) {
+  IRac irac(kGpioUnused);
+#if IRAC_CACHE_SLOTS
+  irac.setCache(false);  // So the objects send, rather than render.
+#endif  // IRAC_CACHE_SLOTS
+  stdAc::state_t state;
+  IRac::initState(&state);
+  state.protocol = decode_type_t::DAIKIN;
+  state.power = true;
+  state.mode = stdAc::opmode_t::kCool;
+  state.degrees = 24;
+  EXPECT_EQ(NULL, irac._poolGet(decode_type_t::DAIKIN, state.model));
+  ASSERT_TRUE(irac.sendAc(state));
+  IRDaikinESP *daikin = static_cast<IRDaikinESP *>(
+      irac._poolGet(decode_type_t::DAIKIN, state.model));
+  ASSERT_NE(nullptr, daikin);
+  const std::string first = daikin->_irsend.outputStr();
+  EXPECT_NE("", first);
+
+  // The same object is reused, & nothing carries over from the last use.
+  state.degrees = 20;
+  state.turbo = true;
+  ASSERT_TRUE(irac.sendAc(state));
+  EXPECT_EQ(daikin, irac._poolGet(decode_type_t::DAIKIN, state.model));
+  daikin->_irsend.reset();
+  state.degrees = 24;
+  state.turbo = false;
+  ASSERT_TRUE(irac.sendAc(state));
+  EXPECT_EQ(first, daikin->_irsend.outputStr());
+
+  // Stateful objects too. e.g. Coolix's extra messages for turbo.
+  IRac fresh(kGpioUnused);
+#if IRAC_CACHE_SLOTS
+  fresh.setCache(false);
+#endif  // IRAC_CACHE_SLOTS
+  state.protocol = decode_type_t::COOLIX;
+  ASSERT_TRUE(fresh.sendAc(state));
+  IRCoolixAC *coolix = static_cast<IRCoolixAC *>(
+      fresh._poolGet(decode_type_t::COOLIX, state.model));
+  ASSERT_NE(nullptr, coolix);
+  state.turbo = true;
+  ASSERT_TRUE(irac.sendAc(state));
+  state.turbo = false;
+  coolix = static_cast<IRCoolixAC *>(
+      irac._poolGet(decode_type_t::COOLIX, state.model));
+  ASSERT_NE(nullptr, coolix);
+  coolix->_irsend.reset();
+  ASSERT_TRUE(irac.sendAc(state));
+  EXPECT_EQ(static_cast<IRCoolixAC *>(fresh._poolGet(
+                decode_type_t::COOLIX, state.model))->_irsend.outputStr(),
+            coolix->_irsend.outputStr());
+
+  // One object per protocol & model. The least recently used is replaced.
+  state.protocol = decode_type_t::FUJITSU_AC;
+  state.model = fujitsu_ac_remote_model_t::ARRAH2E;
+  ASSERT_TRUE(irac.sendAc(state));
+  state.model = fujitsu_ac_remote_model_t::ARDB1;
+  ASSERT_TRUE(irac.sendAc(state));
+  EXPECT_NE(irac._poolGet(decode_type_t::FUJITSU_AC,
+                          fujitsu_ac_remote_model_t::ARRAH2E),
+            irac._poolGet(decode_type_t::FUJITSU_AC,
+                          fujitsu_ac_remote_model_t::ARDB1));
+  for (uint8_t i = 0; i < IRAC_POOL_SLOTS; i++)
+    EXPECT_NE(nullptr, irac._pool[i].ac);
+  // Daikin is now the oldest.
+  state.protocol = decode_type_t::GREE;
+  state.model = gree_ac_remote_model_t::YAW1F;
+  ASSERT_TRUE(irac.sendAc(state));
+  EXPECT_EQ(NULL, irac._poolGet(decode_type_t::DAIKIN, -1));
+  EXPECT_NE(nullptr, irac._poolGet(decode_type_t::COOLIX, -1));
+  EXPECT_NE(nullptr, irac._poolGet(decode_type_t::GREE, state.model));
+
+  // A failed allocation isn't added, & doesn't push anything out.
+  EXPECT_FALSE(irac._poolAdd(decode_type_t::DAIKIN, -1, NULL,
+                             [](void *ac) { (void)ac; }));
+  EXPECT_NE(nullptr, irac._poolGet(decode_type_t::COOLIX, -1));
+  EXPECT_NE(nullptr, irac._poolGet(decode_type_t::GREE, state.model));
+
+  irac.clearPool();
+  for (uint8_t i = 0; i < IRAC_POOL_SLOTS; i++)
+    EXPECT_EQ(nullptr, irac._pool[i].ac);
+}
+#endif  // IRAC_POOL_SLOTS
+
+#if IRAC_CACHE_SLOTS
+TEST(TestIRac, FrameCache) {
+  IRac irac(kGpioUnused);
+  EXPECT_TRUE(irac.getCache());
+  stdAc::state_t state;
+  IRac::initState(&state);
+  state.protocol = decode_type_t::DAIKIN;
+  state.power = true;
+  state.mode = stdAc::opmode_t::kCool;
+  state.degrees = 24;
+  IRDaikinESP ac(kGpioUnused);
+  ac.begin();
+  irac.daikin(&ac, state.power, state.mode, state.degrees, state.fanspeed,
+              state.swingv, state.swingh, state.quiet, state.turbo,
+              state.econo, state.clean);
+  const std::string expected = ac._irsend.outputStr();
+
+  // The first time it is made, & the rest are played back from the cache.
+  ASSERT_TRUE(irac.sendAc(state));
+  EXPECT_EQ(0, irac.getCacheHits());
+  EXPECT_EQ(1, irac.getCacheMisses());
+  EXPECT_EQ(expected, irac._irsend.outputStr());
+  irac._irsend.reset();
+  ASSERT_TRUE(irac.sendAc(state));
+  EXPECT_EQ(1, irac.getCacheHits());
+  EXPECT_EQ(1, irac.getCacheMisses());
+  EXPECT_EQ(expected, irac._irsend.outputStr());
+
+#if IRAC_POOL_SLOTS
+  // The A/C object rendered into the cache via its own IRsend, & only sends
+  // when the cache isn't used.
+  IRDaikinESP *daikin = static_cast<IRDaikinESP *>(
+      irac._poolGet(decode_type_t::DAIKIN, state.model));
+  ASSERT_NE(nullptr, daikin);
+  EXPECT_EQ("", daikin->_irsend.outputStr());
+  irac.setCache(false);
+  ASSERT_TRUE(irac.sendAc(state));
+  EXPECT_EQ(expected, daikin->_irsend.outputStr());
+  irac.setCache(true);
+#endif  // IRAC_POOL_SLOTS
+
+  // The least recently used message is replaced when it's full.
+  stdAc::state_t other = state;
+  other.degrees = 20;
+  ASSERT_TRUE(irac.sendAc(other));
+  ASSERT_TRUE(irac.sendAc(state));
+  EXPECT_EQ(2, irac.getCacheHits());
+  EXPECT_EQ(2, irac.getCacheMisses());
+  other.power = false;
+  ASSERT_TRUE(irac.sendAc(other));  // Replaces the 20C one.
+  ASSERT_TRUE(irac.sendAc(state));
+  EXPECT_EQ(3, irac.getCacheHits());
+  other.power = true;
+  ASSERT_TRUE(irac.sendAc(other));
+  EXPECT_EQ(3, irac.getCacheHits());
+  EXPECT_EQ(4, irac.getCacheMisses());
+
+  // Toggles are handled before looking in the cache. e.g. Coolix's turbo
+  // is only sent when it changes.
+  irac.clearCache();
+  EXPECT_EQ(0, irac.getCacheHits());
+  EXPECT_EQ(0, irac.getCacheMisses());
+  stdAc::state_t prev = state;
+  state.protocol = prev.protocol = decode_type_t::COOLIX;
+  state.turbo = true;
+  ASSERT_TRUE(irac.sendAc(state, &prev));
+  ASSERT_TRUE(irac.sendAc(state, &prev));
+  EXPECT_EQ(1, irac.getCacheHits());
+  state.turbo = prev.turbo = false;
+  ASSERT_TRUE(irac.sendAc(state, &prev));
+  state.turbo = prev.turbo = true;  // No change, so the same message.
+  ASSERT_TRUE(irac.sendAc(state, &prev));
+  EXPECT_EQ(2, irac.getCacheHits());
+  EXPECT_EQ(2, irac.getCacheMisses());
+
+  // States that don't pack exactly aren't cached.
+  state.degrees = 24.3;
+  ASSERT_TRUE(irac.sendAc(state, &prev));
+  ASSERT_TRUE(irac.sendAc(state, &prev));
+  EXPECT_EQ(2, irac.getCacheHits());
+  EXPECT_EQ(4, irac.getCacheMisses());
+
+  // Unsupported protocols aren't cached.
+  state.protocol = decode_type_t::UNKNOWN;
+  EXPECT_FALSE(irac.sendAc(state));
+  EXPECT_FALSE(irac.sendAc(state));
+  EXPECT_EQ(2, irac.getCacheHits());
+}
+#endif  // IRAC_CACHE_SLOTS
+
+TEST(TestIRac, Coalesce) {
+  IRac irac(kGpioUnused);
+  EXPECT_EQ(kIRacCoalesceWindowMs, irac.getCoalesceWindow());
+  irac.setCoalesceWindow(100);
+  stdAc::state_t state;
+  IRac::initState(&state);
+  state.protocol = decode_type_t::COOLIX;
+  state.power = true;
+  state.mode = stdAc::opmode_t::kCool;
+
+  // A burst of updates is merged into the last one.
+  for (state.degrees = 20; state.degrees <= 24; state.degrees++) {
+    irac.updateAc(state);
+    EXPECT_FALSE(irac.pollAc());
+    TimerMs::add(10);
+  }
+  EXPECT_EQ(4, irac.getMergedCount());
+  EXPECT_NE(24, irac.getStatePrev().degrees);
+  TimerMs::add(100);
+  EXPECT_TRUE(irac.pollAc());
+  EXPECT_EQ(24, irac.getStatePrev().degrees);
+  EXPECT_FALSE(irac.pollAc());  // Nothing more to send.
+
+  // A toggle that is changed back within the window isn't sent at all.
+  state.degrees = 24;
+  state.light = true;
+  irac.updateAc(state);
+  state.light = false;
+  irac.updateAc(state);
+  TimerMs::add(100);
+  EXPECT_FALSE(irac.pollAc());
+  EXPECT_EQ(6, irac.getMergedCount());
+
+  // A steady stream of updates is still sent now & then.
+  uint8_t sent = 0;
+  for (uint8_t i = 0; i < 20; i++) {
+    state.degrees = 18 + (i % 3);
+    irac.updateAc(state);
+    TimerMs::add(50);
+    if (irac.pollAc()) sent++;
+  }
+  EXPECT_EQ(2, sent);
+
+  // Sending can be forced.
+  state.degrees = 30;
+  irac.updateAc(state);
+  EXPECT_TRUE(irac.flushAc());
+  EXPECT_EQ(30, irac.getStatePrev().degrees);
+  EXPECT_FALSE(irac.flushAc());
+
+  // No window means no waiting.
+  irac.setCoalesceWindow(0);
+  state.degrees = 28;
+  irac.updateAc(state);
+  EXPECT_EQ(28, irac.getStatePrev().degrees);
+}
+
+TEST(TestIRac, DecoderTable) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(0);
+  stdAc::state_t result;
+  irsend.begin();
+
+  // Not an A/C protocol we understand.
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  ASSERT_EQ(decode_type_t::NEC, irsend.capture.decode_type);
+  EXPECT_EQ("", IRAcUtils::resultAcToString(&irsend.capture));
+  EXPECT_FALSE(IRAcUtils::decodeToState(&irsend.capture, &result));
+  EXPECT_FALSE(IRAcUtils::decodeToState(NULL, &result));
+  EXPECT_FALSE(IRAcUtils::decodeToState(&irsend.capture, NULL));
+
+  // The same entry handles both a description & a common state.
+  IRDaikin64 ac(0);
+  ac.setTemp(23);
+  irsend.reset();
+  irsend.sendDaikin64(ac.getRaw());
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  ASSERT_EQ(decode_type_t::DAIKIN64, irsend.capture.decode_type);
+  EXPECT_EQ(ac.toString(), IRAcUtils::resultAcToString(&irsend.capture));
+  ASSERT_TRUE(IRAcUtils::decodeToState(&irsend.capture, &result));
+  EXPECT_EQ(decode_type_t::DAIKIN64, result.protocol);
+  EXPECT_EQ(23, result.degrees);
+
+  // LG2 messages are from the AKB75215403 model, & LG ones aren't.
+  irsend.reset();
+  irsend.sendLG2(0x8800347);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  ASSERT_EQ(decode_type_t::LG2, irsend.capture.decode_type);
+  EXPECT_EQ(
+      "Model: 2 (AKB75215403), "
+      "Power: On, Mode: 0 (Cool), Temp: 18C, Fan: 4 (High)",
+      IRAcUtils::resultAcToString(&irsend.capture));
+  ASSERT_TRUE(IRAcUtils::decodeToState(&irsend.capture, &result));
+  EXPECT_EQ(decode_type_t::LG, result.protocol);
+  EXPECT_EQ(lg_ac_remote_model_t::AKB75215403, result.model);
+  EXPECT_EQ(18, result.degrees);
+  irsend.reset();
+  irsend.sendLG(0x8800347);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  ASSERT_EQ(decode_type_t::LG, irsend.capture.decode_type);
+  EXPECT_EQ(
+      "Model: 1 (GE6711AR2853M), "
+      "Power: On, Mode: 0 (Cool), Temp: 18C, Fan: 4 (High)",
+      IRAcUtils::resultAcToString(&irsend.capture));
+  ASSERT_TRUE(IRAcUtils::decodeToState(&irsend.capture, &result));
+  EXPECT_EQ(lg_ac_remote_model_t::GE6711AR2853M, result.model);
+
+  // Extended Samsung messages are shrunk to a normal one for both.
+  const uint8_t extended[kSamsungAcExtendedStateLength] = {
+      0x02, 0xA9, 0x0F, 0x00, 0x00, 0x00, 0xC0,
+      0x01, 0xC9, 0x0F, 0x00, 0x00, 0x00, 0x00,
+      0x01, 0xF9, 0xCE, 0x71, 0xE0, 0x41, 0xC0};
+  IRSamsungAc samsung(0);
+  samsung.setRaw(extended, kSamsungAcExtendedStateLength);
+  irsend.reset();
+  irsend.sendSamsungAC(extended, kSamsungAcExtendedStateLength);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  ASSERT_EQ(decode_type_t::SAMSUNG_AC, irsend.capture.decode_type);
+  ASSERT_EQ(kSamsungAcExtendedBits, irsend.capture.bits);
+  EXPECT_EQ(samsung.toString(), IRAcUtils::resultAcToString(&irsend.capture));
+  ASSERT_TRUE(IRAcUtils::decodeToState(&irsend.capture, &result));
+  EXPECT_FALSE(IRac::cmpStates(samsung.toCommon(), result));
+  // Not the first 14 bytes as-is. i.e. Auto at 16C.
+  EXPECT_EQ(stdAc::opmode_t::kHeat, result.mode);
+  EXPECT_EQ(30, result.degrees);
+}
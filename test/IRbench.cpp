@@ -0,0 +1,215 @@
+// Copyright 2020 David Conran
+// Host-side benchmarks for the IR decoding & encoding routines.
+//
+// Usage: make bench
+//   or:  ./IRbench > results.csv
+//
+// Results are written to stdout as CSV, one row per measurement, with columns:
+//   benchmark, protocol, param, rawlen, decoded_as, iterations, ns_per_op,
+//   ops_per_sec, ns_per_pulse
+//
+// Benchmarks:
+//   decode:      IRrecv::decode() of a synthesised capture of each protocol.
+//   max_skip:    decode() of every capture with max_skip values of 0 to 5.
+//   max_skip_scan: As above, but with `IRrecv::setSkipScan(true)`.
+//   best_match:  decode() of every capture with `IRrecv::setBestMatch(true)`.
+//                Only when ENABLE_DECODE_SCORING is set.
+//   noise_floor: decode() of every capture with different noise_floor values.
+//   ac_decode:   IRAcUtils::decodeToState() & resultAcToString() of each
+//                decoded A/C message.
+//   send:        IRsend::send() render time of each protocol.
+//
+// Note: Captures are made by `IRsendTest` from fixed, arbitrary data, so some
+//       protocols with checksums etc. won't decode as themselves. That's still
+//       useful, as the cost of a failed match is a large part of decode() time.
+//       See the `decoded_as` column.
+// Note: Decoding can modify the capture (e.g. `noise_floor`), so it is
+//       restored before each decode. That cost is included in every result.
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "IRac.h"
+#include "IRrecv.h"
+#include "IRremoteESP8266.h"
+#include "IRsend.h"
+#include "IRsend_test.h"
+#include "IRutils.h"
+
+// Roughly how long (in nano-seconds) to spend on each measurement.
+const uint64_t kBenchTargetNs = 20000000;  // 20ms
+const uint32_t kBenchMinIterations = 10;
+const uint64_t kBenchData = 0x123456789ABCDEF0;  // Arbitrary.
+
+/// A synthesised capture of a protocol.
+typedef struct {
+  decode_type_t protocol;
+  std::vector<uint16_t> rawbuf;
+} bench_capture_t;
+
+uint64_t nowNs(void) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Send a message of the given protocol using arbitrary data.
+/// @return true if the protocol is supported by IRsend::send().
+bool sendProtocol(IRsend *irsend, const decode_type_t protocol) {
+  if (hasACState(protocol)) {
+    uint8_t state[kStateSizeMax];
+    const uint16_t nbytes = IRsend::defaultBits(protocol) / 8;
+    if (nbytes == 0 || nbytes > kStateSizeMax) return false;
+    for (uint16_t i = 0; i < nbytes; i++)
+      state[i] = (uint8_t)(kBenchData >> (8 * (i % 8)));
+    return irsend->send(protocol, state, nbytes);
+  }
+  const uint16_t nbits = IRsend::defaultBits(protocol);
+  if (nbits == 0) return false;
+  const uint64_t data = (nbits >= 64) ? kBenchData
+                                      : kBenchData & ((1ULL << nbits) - 1);
+  return irsend->send(protocol, data, nbits);
+}
+
+/// Print a CSV row of results.
+void printRow(const std::string &benchmark, const std::string &protocol,
+              const int32_t param, const uint16_t rawlen,
+              const std::string &decoded_as, const uint32_t iterations,
+              const uint64_t elapsed_ns) {
+  const double ns_per_op = static_cast<double>(elapsed_ns) / iterations;
+  std::cout << benchmark << "," << protocol << "," << param << "," << rawlen
+            << "," << decoded_as << "," << iterations << "," << ns_per_op
+            << "," << (ns_per_op > 0 ? 1e9 / ns_per_op : 0) << ","
+            << (rawlen > 1 ? ns_per_op / (rawlen - 1) : 0) << std::endl;
+}
+
+/// Decode a capture, restoring it first as decoding can change it.
+bool decodeCapture(IRrecv *irrecv, IRsendTest *irsend,
+                   const bench_capture_t &capture, const uint8_t max_skip,
+                   const uint16_t noise_floor) {
+  std::memcpy(irsend->rawbuf, capture.rawbuf.data(),
+              capture.rawbuf.size() * sizeof(uint16_t));
+  irsend->capture.rawbuf = irsend->rawbuf;
+  irsend->capture.rawlen = capture.rawbuf.size();
+  irsend->capture.overflow = false;
+  return irrecv->decode(&irsend->capture, NULL, max_skip, noise_floor);
+}
+
+/// Time decoding all the captures, repeatedly, with the given options.
+void benchAllCaptures(IRrecv *irrecv, IRsendTest *irsend,
+                      const std::vector<bench_capture_t> &captures,
+                      const std::string &benchmark, const uint8_t max_skip,
+                      const uint16_t noise_floor, const int32_t param) {
+  uint32_t iterations = 0;
+  uint64_t pulses = 0;
+  const uint64_t start = nowNs();
+  uint64_t elapsed = 0;
+  while (iterations < kBenchMinIterations || elapsed < kBenchTargetNs) {
+    for (size_t i = 0; i < captures.size(); i++) {
+      decodeCapture(irrecv, irsend, captures[i], max_skip, noise_floor);
+      pulses += captures[i].rawbuf.size() - 1;
+    }
+    iterations++;
+    elapsed = nowNs() - start;
+  }
+  const uint32_t decodes = iterations * captures.size();
+  printRow(benchmark, "ALL", param, (pulses / decodes) + 1, "", decodes,
+           elapsed);
+}
+
+int main(void) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  std::vector<bench_capture_t> captures;
+
+  std::cout << "benchmark,protocol,param,rawlen,decoded_as,iterations,"
+               "ns_per_op,ops_per_sec,ns_per_pulse" << std::endl;
+
+  // Render (send) each protocol, & keep the result for the decode benchmarks.
+  for (int16_t i = 1; i <= kLastDecodeType; i++) {
+    const decode_type_t protocol = (decode_type_t)i;
+    irsend.reset();
+    if (!sendProtocol(&irsend, protocol)) continue;  // Not supported.
+    uint32_t iterations = 0;
+    uint64_t elapsed = 0;
+    while (iterations < kBenchMinIterations || elapsed < kBenchTargetNs) {
+      irsend.reset();  // Not timed. It's expensive in IRsendTest.
+      const uint64_t start = nowNs();
+      sendProtocol(&irsend, protocol);
+      elapsed += nowNs() - start;
+      iterations++;
+    }
+    irsend.makeDecodeResult();
+    bench_capture_t capture;
+    capture.protocol = protocol;
+    capture.rawbuf.assign(irsend.rawbuf,
+                          irsend.rawbuf + irsend.capture.rawlen);
+    captures.push_back(capture);
+    printRow("send", typeToString(protocol).c_str(), 0, capture.rawbuf.size(),
+             "", iterations, elapsed);
+  }
+
+  // Decode throughput per protocol.
+  for (size_t i = 0; i < captures.size(); i++) {
+    uint32_t iterations = 0;
+    const uint64_t start = nowNs();
+    uint64_t elapsed = 0;
+    while (iterations < kBenchMinIterations || elapsed < kBenchTargetNs) {
+      decodeCapture(&irrecv, &irsend, captures[i], 0, 0);
+      iterations++;
+      elapsed = nowNs() - start;
+    }
+    printRow("decode", typeToString(captures[i].protocol).c_str(), 0,
+             captures[i].rawbuf.size(),
+             typeToString(irsend.capture.decode_type,
+                          irsend.capture.repeat).c_str(),
+             iterations, elapsed);
+  }
+
+  // Cost of understanding each decoded A/C message. i.e. Finding its A/C
+  // class, & making a common state & a description with it.
+  for (size_t i = 0; i < captures.size(); i++) {
+    decodeCapture(&irrecv, &irsend, captures[i], 0, 0);
+    stdAc::state_t state;
+    if (!IRAcUtils::decodeToState(&irsend.capture, &state)) continue;
+    uint32_t iterations = 0;
+    const uint64_t start = nowNs();
+    uint64_t elapsed = 0;
+    while (iterations < kBenchMinIterations || elapsed < kBenchTargetNs) {
+      IRAcUtils::decodeToState(&irsend.capture, &state);
+      IRAcUtils::resultAcToString(&irsend.capture);
+      iterations++;
+      elapsed = nowNs() - start;
+    }
+    printRow("ac_decode", typeToString(captures[i].protocol).c_str(), 0,
+             captures[i].rawbuf.size(),
+             typeToString(irsend.capture.decode_type).c_str(), iterations,
+             elapsed);
+  }
+
+  // Cost of max_skip.
+  for (uint8_t max_skip = 0; max_skip <= 5; max_skip++)
+    benchAllCaptures(&irrecv, &irsend, captures, "max_skip", max_skip, 0,
+                     max_skip);
+  irrecv.setSkipScan(true);
+  for (uint8_t max_skip = 0; max_skip <= 5; max_skip++)
+    benchAllCaptures(&irrecv, &irsend, captures, "max_skip_scan", max_skip, 0,
+                     max_skip);
+  irrecv.setSkipScan(false);
+
+#if ENABLE_DECODE_SCORING
+  // Cost of finding the best match, rather than the first.
+  irrecv.setBestMatch(true);
+  benchAllCaptures(&irrecv, &irsend, captures, "best_match", 0, 0, 0);
+  irrecv.setBestMatch(false);
+#endif  // ENABLE_DECODE_SCORING
+
+  // Cost of noise_floor filtering.
+  const uint16_t floors[] = {0, 50, 100, 200};
+  for (uint8_t i = 0; i < sizeof(floors) / sizeof(floors[0]); i++)
+    benchAllCaptures(&irrecv, &irsend, captures, "noise_floor", 0, floors[i],
+                     floors[i]);
+  return 0;
+}
@@ -108,6 +108,278 @@ TEST(TestCopyIrParams, CopyNonEmpty) {
   EXPECT_EQ(0xDEAD, dst.rawbuf[test_size - 1]);
 }
 
+// Tests for the capture ring.
+
+extern thread_local volatile irparams_t irparams;
+
+#if CAPTURE_RING_SLOTS
+// Pretend to be the interrupt handler capturing a message into the ring.
+void ringCapture(const volatile uint16_t *data, const uint16_t len,
+                 const bool overflow = false) {
+  for (uint16_t i = 0; i < len; i++) irparams.rawbuf[i] = data[i];
+  irparams.rawlen = len;
+  irparams.overflow = overflow;
+  IRrecv::_ringPublish();
+}
+
+TEST(TestCaptureRing, DecodeFromRing) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  decode_results results;
+  irsend.begin();
+  irrecv.enableIRIn();
+  EXPECT_FALSE(irrecv.popCapture(&results));
+
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  ringCapture(irsend.capture.rawbuf, irsend.capture.rawlen);
+  irsend.reset();
+  irsend.sendSony(0xF50, kSony12Bits);
+  irsend.makeDecodeResult();
+  ringCapture(irsend.capture.rawbuf, irsend.capture.rawlen);
+
+  ASSERT_TRUE(irrecv.popCapture(&results));
+  EXPECT_EQ(69, results.rawlen);
+  EXPECT_FALSE(results.overflow);
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(NEC, results.decode_type);
+  EXPECT_EQ(0x807F40BF, results.value);
+
+  ASSERT_TRUE(irrecv.popCapture(&results));
+  ASSERT_TRUE(irrecv.decode(&results));
+  EXPECT_EQ(SONY, results.decode_type);
+  EXPECT_EQ(0xF50, results.value);
+
+  EXPECT_FALSE(irrecv.popCapture(&results));
+  EXPECT_EQ(0, irrecv.getDroppedCount());
+}
+
+TEST(TestCaptureRing, FullRing) {
+  IRrecv irrecv(1);
+  decode_results results;
+  volatile uint16_t data[kRawBuf];
+  irrecv.enableIRIn();
+  // A ring can only hold one less message than it has slots.
+  for (uint16_t i = 1; i < CAPTURE_RING_SLOTS; i++) {
+    data[0] = i;
+    ringCapture(data, i, i == 2);
+  }
+  EXPECT_EQ(0, irrecv.getDroppedCount());
+  data[0] = 1000;
+  ringCapture(data, 1);
+  EXPECT_EQ(1, irrecv.getDroppedCount());
+
+  // The slot we have popped is still ours until the next pop or resume().
+  ASSERT_TRUE(irrecv.popCapture(&results));
+  EXPECT_EQ(1, results.rawbuf[0]);
+  EXPECT_EQ(1, results.rawlen);
+  EXPECT_FALSE(results.overflow);
+  ringCapture(data, 1);
+  EXPECT_EQ(2, irrecv.getDroppedCount());
+  EXPECT_EQ(1, results.rawbuf[0]);
+  irrecv.resume();
+  data[0] = 2000;
+  ringCapture(data, 3);
+  EXPECT_EQ(2, irrecv.getDroppedCount());
+
+  // Everything else comes out in the order it was captured.
+  for (uint16_t i = 2; i < CAPTURE_RING_SLOTS; i++) {
+    ASSERT_TRUE(irrecv.popCapture(&results));
+    EXPECT_EQ(i, results.rawbuf[0]);
+    EXPECT_EQ(i, results.rawlen);
+    EXPECT_EQ(i == 2, results.overflow);
+  }
+  ASSERT_TRUE(irrecv.popCapture(&results));
+  EXPECT_EQ(2000, results.rawbuf[0]);
+  EXPECT_EQ(3, results.rawlen);
+  EXPECT_FALSE(irrecv.popCapture(&results));
+
+  // Restarting capture empties the ring & resets the count.
+  ringCapture(data, 1);
+  irrecv.enableIRIn();
+  EXPECT_FALSE(irrecv.popCapture(&results));
+  EXPECT_EQ(0, irrecv.getDroppedCount());
+}
+#endif  // CAPTURE_RING_SLOTS
+
+// Tests for early decoding.
+
+// Pretend to be the interrupt handler part way through capturing a message.
+void partialCapture(const volatile uint16_t *data, const uint16_t len) {
+  for (uint16_t i = 0; i < len; i++) irparams.rawbuf[i] = data[i];
+  irparams.rawlen = len;
+  irparams.overflow = false;
+  irparams.rcvstate = kMarkState;
+}
+
+TEST(TestEarlyDecode, General) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  decode_results results;
+  irsend.begin();
+  irrecv.enableIRIn();
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  // A real capture would have only got as far as the footer mark.
+  const uint16_t rawlen = irsend.capture.rawlen - 1;
+  partialCapture(irsend.capture.rawbuf, rawlen);
+
+  // Off by default.
+  EXPECT_EQ(0, irrecv.getEarlyDecodeGap());
+  EXPECT_FALSE(irrecv._decodeEarly(&results, NULL, 0, 0, 1000000));
+  irrecv.setEarlyDecodeGap(kEarlyDecodeGap);
+  EXPECT_EQ(kEarlyDecodeGap, irrecv.getEarlyDecodeGap());
+  // Not quiet for long enough yet.
+  EXPECT_FALSE(irrecv._decodeEarly(&results, NULL, 0, 0, kEarlyDecodeGap - 1));
+  // Not when filtering noise.
+  EXPECT_FALSE(irrecv._decodeEarly(&results, NULL, 0, 50, kEarlyDecodeGap));
+  EXPECT_EQ(rawlen, irparams.rawlen);
+
+  ASSERT_TRUE(irrecv._decodeEarly(&results, NULL, 0, 0, kEarlyDecodeGap));
+  EXPECT_EQ(NEC, results.decode_type);
+  EXPECT_EQ(0x807F40BF, results.value);
+  EXPECT_EQ(rawlen, results.rawlen);
+#if CAPTURE_RING_SLOTS
+  // The capture was ended, & the interrupt handler has moved on.
+  EXPECT_EQ(0, irparams.rawlen);
+  EXPECT_EQ(kIdleState, irparams.rcvstate);
+  EXPECT_FALSE(irrecv.popCapture(&results));
+  EXPECT_EQ(0, irrecv.getDroppedCount());
+#elif ENABLE_COMPACT_CAPTURE
+  // The capture was ended, & the interrupt handler has moved on, as it only
+  // uses the compact buffer.
+  EXPECT_EQ(0, irparams.rawlen);
+  EXPECT_EQ(kIdleState, irparams.rcvstate);
+#else  // CAPTURE_RING_SLOTS
+  // The capture was ended, & waits for resume() as there is no save buffer.
+  EXPECT_EQ(rawlen, irparams.rawlen);
+  EXPECT_EQ(kStopState, irparams.rcvstate);
+#endif  // CAPTURE_RING_SLOTS
+}
+
+TEST(TestEarlyDecode, IncompleteMessages) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  decode_results results;
+  irsend.begin();
+  irrecv.enableIRIn();
+  irrecv.setEarlyDecodeGap(kEarlyDecodeGap);
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  // A real capture would have only got as far as the footer mark.
+  const uint16_t rawlen = irsend.capture.rawlen - 1;
+
+  // Part of a message doesn't decode, & leaves the capture alone.
+  partialCapture(irsend.capture.rawbuf, 40);
+  EXPECT_FALSE(irrecv._decodeEarly(&results, NULL, 0, 0, kEarlyDecodeGap));
+  EXPECT_EQ(40, irparams.rawlen);
+  EXPECT_EQ(kMarkState, irparams.rcvstate);
+  // Nor does it while we are in the middle of a mark.
+  partialCapture(irsend.capture.rawbuf, rawlen - 1);
+  EXPECT_FALSE(irrecv._decodeEarly(&results, NULL, 0, 0, kEarlyDecodeGap));
+
+  // Unknown messages always wait for the timeout.
+  volatile uint16_t junk[20];
+  for (uint16_t i = 0; i < 20; i++) junk[i] = 5000;
+  partialCapture(junk, 20);
+  EXPECT_FALSE(irrecv._decodeEarly(&results, NULL, 0, 0, kEarlyDecodeGap));
+  EXPECT_EQ(20, irparams.rawlen);
+  EXPECT_EQ(0, irparams.rawbuf[20]);  // The end of the data was marked.
+
+  // A capture length is only attempted once.
+  partialCapture(irsend.capture.rawbuf, rawlen);
+  irparams.rawbuf[3] = 1;  // Corrupt it.
+  EXPECT_FALSE(irrecv._decodeEarly(&results, NULL, 0, 0, kEarlyDecodeGap));
+  irparams.rawbuf[3] = irsend.capture.rawbuf[3];  // Fix it.
+  EXPECT_FALSE(irrecv._decodeEarly(&results, NULL, 0, 0, kEarlyDecodeGap));
+  // It only gets decoded once the capture has changed length.
+  partialCapture(irsend.capture.rawbuf, rawlen - 2);
+  EXPECT_FALSE(irrecv._decodeEarly(&results, NULL, 0, 0, kEarlyDecodeGap));
+  partialCapture(irsend.capture.rawbuf, rawlen);
+  EXPECT_TRUE(irrecv._decodeEarly(&results, NULL, 0, 0, kEarlyDecodeGap));
+  EXPECT_EQ(NEC, results.decode_type);
+}
+
+#if ENABLE_COMPACT_CAPTURE
+// Tests for the compact capture.
+
+// Pretend to be the interrupt handler having captured (part of) a message. It
+// only writes to the compact buffer, never to the capture buffer.
+void compactCapture(const volatile uint16_t *data, const uint16_t len,
+                    const uint8_t state) {
+  irparams.compactlen = irutils::compactRaw(data, len, irparams.compact,
+                                            irparams.compactsize);
+  irparams.rawlen = len;
+  irparams.overflow = false;
+  irparams.rcvstate = state;
+  for (uint16_t i = 0; i < irparams.bufsize; i++) irparams.rawbuf[i] = 0;
+}
+
+TEST(TestCompactCapture, Decode) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  decode_results results;
+  irsend.begin();
+  irrecv.enableIRIn();
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  compactCapture(irsend.capture.rawbuf, irsend.capture.rawlen, kStopState);
+  ASSERT_LT(0, irparams.compactlen);
+  EXPECT_GT(irsend.capture.rawlen * sizeof(uint16_t), irparams.compactlen);
+
+  // Only a save buffer points the results at the capture in a unit test.
+  ASSERT_EQ(kRawBuf, irrecv.getBufSize());
+  uint16_t save_buf[kRawBuf];
+  irparams_t save;
+  save.rawbuf = save_buf;
+  ASSERT_TRUE(irrecv.decode(&results, &save));
+  EXPECT_EQ(NEC, results.decode_type);
+  EXPECT_EQ(0x807F40BF, results.value);
+  EXPECT_EQ(irsend.capture.rawlen, results.rawlen);
+  EXPECT_FALSE(results.overflow);
+  EXPECT_EQ(save_buf, results.rawbuf);
+  // The interrupt handler was free to start on the next one.
+  EXPECT_EQ(kIdleState, irparams.rcvstate);
+  EXPECT_EQ(0, irparams.compactlen);
+}
+
+TEST(TestCompactCapture, EarlyDecode) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  decode_results results;
+  irsend.begin();
+  irrecv.enableIRIn();
+  irrecv.setEarlyDecodeGap(kEarlyDecodeGap);
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  // A real capture would have only got as far as the footer mark.
+  const uint16_t rawlen = irsend.capture.rawlen - 1;
+
+  // Part of a message doesn't decode, & leaves the capture alone.
+  compactCapture(irsend.capture.rawbuf, 40, kMarkState);
+  const uint16_t compactlen = irparams.compactlen;
+  EXPECT_FALSE(irrecv._decodeEarly(&results, NULL, 0, 0, kEarlyDecodeGap));
+  EXPECT_EQ(40, irparams.rawlen);
+  EXPECT_EQ(compactlen, irparams.compactlen);
+  EXPECT_EQ(kMarkState, irparams.rcvstate);
+
+  compactCapture(irsend.capture.rawbuf, rawlen, kMarkState);
+  ASSERT_TRUE(irrecv._decodeEarly(&results, NULL, 0, 0, kEarlyDecodeGap));
+  EXPECT_EQ(NEC, results.decode_type);
+  EXPECT_EQ(0x807F40BF, results.value);
+  EXPECT_EQ(rawlen, results.rawlen);
+  EXPECT_EQ(irparams.rawbuf, results.rawbuf);
+  // No save buffer was needed, so the interrupt handler has carried on.
+  EXPECT_EQ(kIdleState, irparams.rcvstate);
+  EXPECT_EQ(0, irparams.compactlen);
+}
+#endif  // ENABLE_COMPACT_CAPTURE
+
 // Tests for decode().
 
 // Test decode of a NEC message.
@@ -561,6 +833,63 @@ TEST(TestMatchData, ArbitraryEncoded) {
   ASSERT_FALSE(result.success);
 }
 
+// Test matchBytes() gives the same results as matchData() does per byte.
+TEST(TestMatchBytes, SameAsMatchData) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+
+  const uint8_t expected[3] = {0xA5, 0x3C, 0x01};
+  irsend.reset();
+  irsend.sendData(500, 1500, 500, 500, expected[0], 8, true);
+  irsend.sendData(500, 1500, 500, 500, expected[1], 8, true);
+  irsend.sendData(500, 1500, 500, 500, expected[2], 8, true);
+  irsend.mark(500);
+  irsend.makeDecodeResult();
+  uint8_t result[3] = {0, 0, 0};
+
+  // MSBF order.
+  EXPECT_EQ(48, irrecv.matchBytes(irsend.capture.rawbuf + 1, result,
+                                  irsend.capture.rawlen - 1, 3,
+                                  500, 1500, 500, 500));
+  EXPECT_EQ(expected[0], result[0]);
+  EXPECT_EQ(expected[1], result[1]);
+  EXPECT_EQ(expected[2], result[2]);
+  for (uint8_t i = 0; i < 3; i++) {
+    match_result_t data = irrecv.matchData(irsend.capture.rawbuf + 1 + i * 16,
+                                           8, 500, 1500, 500, 500);
+    ASSERT_TRUE(data.success);
+    EXPECT_EQ(data.data, result[i]);
+  }
+  // LSBF order.
+  EXPECT_EQ(48, irrecv.matchBytes(irsend.capture.rawbuf + 1, result,
+                                  irsend.capture.rawlen - 1, 3,
+                                  500, 1500, 500, 500,
+                                  kTolerance, kMarkExcess, false));
+  EXPECT_EQ(0xA5, result[0]);
+  EXPECT_EQ(0x3C, result[1]);
+  EXPECT_EQ(0x80, result[2]);
+  for (uint8_t i = 0; i < 3; i++) {
+    match_result_t data = irrecv.matchData(irsend.capture.rawbuf + 1 + i * 16,
+                                           8, 500, 1500, 500, 500,
+                                           kTolerance, kMarkExcess, false);
+    ASSERT_TRUE(data.success);
+    EXPECT_EQ(data.data, result[i]);
+  }
+
+  // Not enough buffer.
+  EXPECT_EQ(0, irrecv.matchBytes(irsend.capture.rawbuf + 1, result, 47, 3,
+                                 500, 1500, 500, 500));
+  // A bad bit in the last byte fails the lot.
+  irsend.capture.rawbuf[1 + 2 * 16 + 7] = 1000 / kRawTick;
+  EXPECT_EQ(0, irrecv.matchBytes(irsend.capture.rawbuf + 1, result,
+                                 irsend.capture.rawlen - 1, 3,
+                                 500, 1500, 500, 500));
+  EXPECT_EQ(32, irrecv.matchBytes(irsend.capture.rawbuf + 1, result,
+                                  irsend.capture.rawlen - 1, 2,
+                                  500, 1500, 500, 500));
+}
+
 TEST(TestMatchGeneric, NormalWithNoAtleast) {
   IRsendTest irsend(0);
   IRrecv irrecv(1);
@@ -1209,6 +1538,185 @@ TEST(TestMatchGeneric, UsingBytes) {
   ASSERT_EQ(0, entries_used);
 }
 
+TEST(TestMatchGeneric, UsingTimingDescriptor) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+
+  const protocol_timing_t timing = {
+      (decode_type_t)(kLastDecodeType + 1), 20,
+      3000, 1500,  // Header
+      400, 1200,  // One
+      400, 400,  // Zero
+      400, 20000, 0,  // Footer & gap
+      38, 50, false, kNoRepeat, kUseDefTol};
+
+  irsend.reset();
+  irsend.sendGeneric(&timing, 0xA5F0F, timing.bits, kNoRepeat);
+  EXPECT_EQ(
+      "f38000d50"
+      "m3000s1500"
+      "m400s1200m400s1200m400s1200m400s1200m400s400m400s400m400s400m400s400"
+      "m400s1200m400s1200m400s1200m400s1200m400s1200m400s400m400s1200m400s400"
+      "m400s400m400s1200m400s400m400s1200"
+      "m400s20000",
+      irsend.outputStr());
+
+  irsend.reset();
+  irsend.sendGeneric(&timing, 0xA5F0F, timing.bits, kNoRepeat);
+  irsend.makeDecodeResult();
+  uint64_t result_data = 0;
+  EXPECT_EQ(irsend.capture.rawlen - kStartOffset,
+            irrecv.matchGeneric(irsend.capture.rawbuf + kStartOffset,
+                                &result_data,
+                                irsend.capture.rawlen - kStartOffset,
+                                timing.bits, &timing));
+  EXPECT_EQ(0xA5F0F, result_data);
+#if CUSTOM_PROTOCOL_SLOTS
+  // It's an unknown protocol, so decode() shouldn't know it yet.
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_NE(timing.protocol, irsend.capture.decode_type);
+
+  // Add it.
+  ASSERT_TRUE(irrecv.addProtocol(&timing));
+  irsend.reset();
+  irsend.sendGeneric(&timing, 0xA5F0F, timing.bits, kNoRepeat);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(timing.protocol, irsend.capture.decode_type);
+  EXPECT_EQ(timing.bits, irsend.capture.bits);
+  EXPECT_EQ(0xA5F0F, irsend.capture.value);
+#endif  // CUSTOM_PROTOCOL_SLOTS
+  // Wrong size.
+  EXPECT_FALSE(irrecv.decodeGeneric(&irsend.capture, kStartOffset, &timing,
+                                    timing.bits + 1));
+
+  // Bytes.
+  const protocol_timing_t bytes_timing = {
+      (decode_type_t)(kLastDecodeType + 2), 72,
+      3000, 1500, 400, 1200, 400, 400, 400, 20000, 0,
+      38, 50, true, kNoRepeat, kUseDefTol};
+  const uint8_t state[9] = {0x01, 0x23, 0x45, 0x67, 0x89,
+                            0xAB, 0xCD, 0xEF, 0xFE};
+  irsend.reset();
+  irsend.sendGeneric(&bytes_timing, state, sizeof(state), kNoRepeat);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decodeGeneric(&irsend.capture, kStartOffset,
+                                   &bytes_timing, bytes_timing.bits));
+  EXPECT_EQ(bytes_timing.protocol, irsend.capture.decode_type);
+  EXPECT_EQ(72, irsend.capture.bits);
+  EXPECT_STATE_EQ(state, irsend.capture.state, 72);
+
+#if CUSTOM_PROTOCOL_SLOTS
+  // Running out of slots.
+  irrecv.clearProtocols();
+  for (uint8_t i = 0; i < CUSTOM_PROTOCOL_SLOTS; i++)
+    EXPECT_TRUE(irrecv.addProtocol(&bytes_timing));
+  EXPECT_FALSE(irrecv.addProtocol(&timing));
+  EXPECT_FALSE(irrecv.addProtocol(NULL));
+#endif  // CUSTOM_PROTOCOL_SLOTS
+}
+
+#if ENABLE_DECODE_SCORING
+TEST(TestIRrecv, DecodeScoring) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+
+  // A clean NEC message.
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  const uint16_t clean = irsend.capture.score;
+  EXPECT_LT(clean, 150);  // Synthetic captures have no mark excess.
+  EXPECT_EQ(UNKNOWN, irsend.capture.candidates[0].decode_type);
+
+  // The same message, but with every space 8% too long.
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+  for (uint16_t i = 2; i < irsend.capture.rawlen; i += 2)
+    irsend.capture.rawbuf[i] = irsend.capture.rawbuf[i] * 108 / 100;
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x4BB640BF, irsend.capture.value);
+  EXPECT_GT(irsend.capture.score, clean);
+
+  // UNKNOWN messages aren't scored.
+  const uint16_t unknown[] = {5000, 1000, 3000, 2000, 7000, 900, 2500, 1200};
+  irsend.reset();
+  irsend.sendRaw(unknown, sizeof(unknown) / sizeof(unknown[0]), 38);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(UNKNOWN, irsend.capture.decode_type);
+  EXPECT_EQ(kNoScore, irsend.capture.score);
+}
+
+#if CUSTOM_PROTOCOL_SLOTS
+TEST(TestIRrecv, BestMatch) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+
+  // An NEC-like protocol that NEC's decoder will also (poorly) match.
+  const protocol_timing_t timing = {
+      (decode_type_t)(kLastDecodeType + 1), 32,
+      9000, 4500, 650, 1500, 650, 600, 650, 40000, 0,
+      38, 50, true, kNoRepeat, kUseDefTol};
+  ASSERT_TRUE(irrecv.addProtocol(&timing));
+  EXPECT_FALSE(irrecv.getBestMatch());
+
+  // First match wins.
+  irsend.reset();
+  irsend.sendGeneric(&timing, 0x4BB640BF, timing.bits, kNoRepeat);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x4BB640BF, irsend.capture.value);
+  const uint16_t nec_score = irsend.capture.score;
+
+  // Best match wins.
+  irrecv.setBestMatch(true);
+  EXPECT_TRUE(irrecv.getBestMatch());
+  irsend.reset();
+  irsend.sendGeneric(&timing, 0x4BB640BF, timing.bits, kNoRepeat);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(timing.protocol, irsend.capture.decode_type);
+  EXPECT_EQ(0x4BB640BF, irsend.capture.value);
+  EXPECT_FALSE(irsend.capture.repeat);
+  EXPECT_LT(irsend.capture.score, nec_score);
+  // The runners-up, best first.
+  EXPECT_NE(UNKNOWN, irsend.capture.candidates[0].decode_type);
+  bool found_nec = false;
+  for (uint8_t i = 0; i < kDecodeCandidates; i++) {
+    if (irsend.capture.candidates[i].decode_type == UNKNOWN) break;
+    EXPECT_GE(irsend.capture.candidates[i].score, irsend.capture.score);
+    if (i) {
+      EXPECT_GE(irsend.capture.candidates[i].score,
+                irsend.capture.candidates[i - 1].score);
+    }
+    if (irsend.capture.candidates[i].decode_type == NEC) {
+      found_nec = true;
+      EXPECT_EQ(nec_score, irsend.capture.candidates[i].score);
+      EXPECT_EQ(32, irsend.capture.candidates[i].bits);
+    }
+  }
+  EXPECT_TRUE(found_nec);
+
+  // A real NEC message is still NEC.
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x4BB640BF, irsend.capture.value);
+}
+#endif  // CUSTOM_PROTOCOL_SLOTS
+#endif  // ENABLE_DECODE_SCORING
+
 TEST(TestIRrecv, Tolerance) {
   IRsendTest irsend(0);
   IRrecv irrecv(1);
@@ -1246,6 +1754,39 @@ TEST(TestIRrecv, Tolerance) {
   ASSERT_FALSE(result.success);
 }
 
+TEST(TestIRrecv, IntegerTolerance) {
+  IRrecv irrecv(1);
+  // Known values.
+  EXPECT_EQ(750, irrecv.ticksLow(1000, 25));
+  EXPECT_EQ(1251, irrecv.ticksHigh(1000, 25));
+  EXPECT_EQ(650, irrecv.ticksLow(1000, 25, 100));
+  EXPECT_EQ(1351, irrecv.ticksHigh(1000, 25, 100));
+  EXPECT_EQ(0, irrecv.ticksLow(100, 50, 100));  // Can't go below zero.
+  EXPECT_EQ(0, irrecv.ticksLow(1000, 100));
+  EXPECT_EQ(2001, irrecv.ticksHigh(1000, 100));
+  EXPECT_EQ(1000, irrecv.ticksLow(1000, 0));
+  EXPECT_EQ(1001, irrecv.ticksHigh(1000, 0));
+  // Large values don't overflow.
+  EXPECT_EQ(3221225471, irrecv.ticksLow(4294967295, 25));
+  EXPECT_EQ(2147483647, irrecv.ticksHigh(1073741823, 100));
+  // Uses the class tolerance when asked.
+  EXPECT_EQ(irrecv.ticksLow(1000, kTolerance), irrecv.ticksLow(1000));
+  EXPECT_EQ(irrecv.ticksHigh(1000, kTolerance), irrecv.ticksHigh(1000));
+
+  // A precomputed window gives the same answers as match().
+  for (uint8_t tolerance = 0; tolerance <= 100; tolerance += 5) {
+    for (uint32_t desired = 100; desired < 20000; desired += 97) {
+      match_window_t window = irrecv.tickWindow(desired, tolerance, 30);
+      for (uint32_t ticks = window.low - 2; ticks <= window.low + 2; ticks++)
+        EXPECT_EQ(irrecv.match(ticks, desired, tolerance, 30),
+                  irrecv.matchWindow(ticks, window));
+      for (uint32_t ticks = window.high - 2; ticks <= window.high + 2; ticks++)
+        EXPECT_EQ(irrecv.match(ticks, desired, tolerance, 30),
+                  irrecv.matchWindow(ticks, window));
+    }
+  }
+}
+
 TEST(TestDecode, SkippingInDecode) {
   IRsendTest irsend(0);
   IRrecv irrecv(1);
@@ -1358,6 +1899,258 @@ TEST(TestDecode, SkippingInDecode) {
   EXPECT_EQ(0x4BB640BF, irsend.capture.value);
 }
 
+TEST(TestDecodeIndex, PlausibleHeader) {
+  IRrecv irrecv(1);
+  const decode_index_t nec = {decode_type_t::NEC, 8960, 8960, 2240, 4480};
+  const decode_index_t fallback = {decode_type_t::RC5, 0, 0, 0, 0};
+
+  // Nominal values.
+  EXPECT_TRUE(irrecv._plausibleHeader(&nec, 8960, 4480));
+  EXPECT_TRUE(irrecv._plausibleHeader(&nec, 8960, 2240));  // Repeat.
+  // Typical real world variation.
+  EXPECT_TRUE(irrecv._plausibleHeader(&nec, 9100, 4400));
+  EXPECT_TRUE(irrecv._plausibleHeader(&nec, 8850, 4550));
+  // Edges of the window.
+  EXPECT_TRUE(irrecv._plausibleHeader(&nec, 4380, 1020));
+  EXPECT_TRUE(irrecv._plausibleHeader(&nec, 13540, 6820));
+  EXPECT_FALSE(irrecv._plausibleHeader(&nec, 4378, 4480));
+  EXPECT_FALSE(irrecv._plausibleHeader(&nec, 13542, 4480));
+  EXPECT_FALSE(irrecv._plausibleHeader(&nec, 8960, 1018));
+  EXPECT_FALSE(irrecv._plausibleHeader(&nec, 8960, 6822));
+  // Something else entirely. e.g. A Sony header.
+  EXPECT_FALSE(irrecv._plausibleHeader(&nec, 2400, 600));
+  // Ran out of data.
+  EXPECT_FALSE(irrecv._plausibleHeader(&nec, 0, 0));
+
+  // Fallback entries are always attempted.
+  EXPECT_TRUE(irrecv._plausibleHeader(&fallback, 8960, 4480));
+  EXPECT_TRUE(irrecv._plausibleHeader(&fallback, 0, 0));
+}
+
+// The index must not change what decode() finds, or the priority order.
+TEST(TestDecodeIndex, SameResultAsWithoutIndex) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+
+  // Sanyo LC7461 is NEC-like, but needs to be found before NEC.
+  irsend.reset();
+  irsend.sendSanyoLC7461(0x2468DCB56A9);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(SANYO_LC7461, irsend.capture.decode_type);
+  EXPECT_EQ(kSanyoLC7461Bits, irsend.capture.bits);
+  EXPECT_EQ(0x2468DCB56A9, irsend.capture.value);
+  // Bypass the index.
+  irrecv.setTolerance(kDecodeIndexMaxTolerance + 1);
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(SANYO_LC7461, irsend.capture.decode_type);
+  EXPECT_EQ(0x2468DCB56A9, irsend.capture.value);
+  irrecv.setTolerance();
+
+  // A headerless protocol still gets found via the fallback entries, even when
+  // the message is preceded by junk.
+  irsend.reset();
+  irsend.mark(9000);
+  irsend.space(4500);
+  irsend.sendSharpRaw(0x454A);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture, NULL, 0));
+  EXPECT_NE(SHARP, irsend.capture.decode_type);
+  ASSERT_TRUE(irrecv.decode(&irsend.capture, NULL, 1));
+  EXPECT_EQ(SHARP, irsend.capture.decode_type);
+  EXPECT_EQ(kSharpBits, irsend.capture.bits);
+  EXPECT_EQ(0x454A, irsend.capture.value);
+}
+
+TEST(TestDecodeIndex, SkipScan) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  EXPECT_FALSE(irrecv.getSkipScan());
+  irrecv.setSkipScan(true);
+  EXPECT_TRUE(irrecv.getSkipScan());
+
+  // A message with a header is still found after some noise.
+  irsend.reset();
+  irsend.mark(100);
+  irsend.space(300);
+  irsend.mark(60);
+  irsend.space(5000);
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture, NULL, 1));
+  EXPECT_NE(NEC, irsend.capture.decode_type);
+  ASSERT_TRUE(irrecv.decode(&irsend.capture, NULL, 10));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x807F40BF, irsend.capture.value);
+
+  // Headerless protocols are still found when nothing is skipped.
+  irsend.reset();
+  irsend.sendSharpRaw(0x454A);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture, NULL, 10));
+  EXPECT_EQ(SHARP, irsend.capture.decode_type);
+  EXPECT_EQ(0x454A, irsend.capture.value);
+
+#if ENABLE_DECODE_PROFILING
+  // Only the start of the NEC message was worth decoding from.
+  irsend.reset();
+  irsend.mark(100);
+  irsend.space(300);
+  irsend.mark(60);
+  irsend.space(5000);
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  irrecv.setSkipScan(false);
+  irrecv.resetProfile();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture, NULL, 2));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  const uint32_t without_scan = irrecv.getProfile().attempts[MAGIQUEST];
+  irrecv.setSkipScan(true);
+  irrecv.resetProfile();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture, NULL, 2));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(2, without_scan);
+  EXPECT_EQ(1, irrecv.getProfile().attempts[MAGIQUEST]);
+#endif  // ENABLE_DECODE_PROFILING
+}
+
+#if ENABLE_PULSE_CLASSIFICATION && ENABLE_DECODE_PROFILING
+TEST(TestDecodeIndex, PulseClassification) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  const decode_profile_t &profile = irrecv.getProfile();
+
+  // Something unknown, with a long leading mark.
+  irsend.reset();
+  irsend.mark(9000);
+  irsend.space(3000);
+  for (uint8_t i = 0; i < 20; i++) {
+    irsend.mark(560);
+    irsend.space(1200);
+  }
+  irsend.space(kDefaultMessageGap);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  ASSERT_EQ(UNKNOWN, irsend.capture.decode_type);
+  // The decoders without a header that can't start with a mark that long
+  // weren't attempted.
+  EXPECT_EQ(0, profile.attempts[decode_type_t::SHARP]);
+  EXPECT_EQ(0, profile.attempts[decode_type_t::DENON]);
+  EXPECT_EQ(0, profile.attempts[decode_type_t::DAIKIN]);
+  EXPECT_EQ(0, profile.attempts[decode_type_t::RC5]);
+  EXPECT_EQ(0, profile.attempts[decode_type_t::MWM]);
+  EXPECT_EQ(0, profile.attempts[decode_type_t::AIRWELL]);
+  // The ones that can were. e.g. JVC has a 8400us header.
+  EXPECT_EQ(1, profile.attempts[decode_type_t::JVC]);
+  // As were the ones that aren't checked.
+  EXPECT_EQ(1, profile.attempts[decode_type_t::MAGIQUEST]);
+  EXPECT_EQ(1, profile.attempts[decode_type_t::LUTRON]);
+  EXPECT_EQ(1, profile.attempts[decode_type_t::VOLTAS]);
+
+  // Something too short for RC5 to start with.
+  irsend.reset();
+  irsend.mark(100);
+  irsend.space(100);
+  irsend.makeDecodeResult();
+  irrecv.resetProfile();
+  irrecv.decode(&irsend.capture);
+  EXPECT_EQ(0, profile.attempts[decode_type_t::RC5]);
+  // The classes are only used along with the index.
+  irrecv.setTolerance(kDecodeIndexMaxTolerance + 1);
+  irrecv.resetProfile();
+  irrecv.decode(&irsend.capture);
+  EXPECT_EQ(1, profile.attempts[decode_type_t::RC5]);
+  irrecv.setTolerance();
+
+  // Each offset's leading mark is checked. e.g. When skipping a header.
+  irsend.reset();
+  irsend.mark(9000);
+  irsend.space(4500);
+  irsend.sendSharpRaw(0x454A);
+  irsend.makeDecodeResult();
+  irrecv.resetProfile();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture, NULL, 1));
+  EXPECT_EQ(SHARP, irsend.capture.decode_type);
+  EXPECT_EQ(0x454A, irsend.capture.value);
+  EXPECT_EQ(1, profile.attempts[decode_type_t::SHARP]);
+  EXPECT_EQ(1, profile.matches[decode_type_t::SHARP]);
+}
+#endif  // ENABLE_PULSE_CLASSIFICATION && ENABLE_DECODE_PROFILING
+
+#if ENABLE_DECODE_PROFILING
+TEST(TestDecodeProfile, General) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+
+  const decode_profile_t &profile = irrecv.getProfile();
+  EXPECT_EQ(0, profile.captures);
+  EXPECT_EQ(0, profile.attempts[decode_type_t::NEC]);
+
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  ASSERT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(1, profile.captures);
+  EXPECT_EQ(1, profile.attempts[decode_type_t::NEC]);
+  EXPECT_EQ(1, profile.matches[decode_type_t::NEC]);
+  // NEC-like protocols that need to be tried before NEC were attempted.
+  EXPECT_EQ(1, profile.attempts[decode_type_t::SANYO_LC7461]);
+  EXPECT_EQ(0, profile.matches[decode_type_t::SANYO_LC7461]);
+  // Protocols with a very different header weren't.
+  EXPECT_EQ(0, profile.attempts[decode_type_t::SONY]);
+  // Nothing was tried after the match.
+  EXPECT_EQ(0, profile.attempts[decode_type_t::NEC_LIKE]);
+  // Simulated time doesn't move during a decode, so it is in the 1st bucket.
+  EXPECT_EQ(1, profile.latency[0]);
+
+  // A capture nothing can decode.
+  irsend.reset();
+  irsend.mark(100);
+  irsend.space(100);
+  irsend.makeDecodeResult();
+  irrecv.decode(&irsend.capture);
+  EXPECT_EQ(2, profile.captures);
+  EXPECT_EQ(1, profile.attempts[decode_type_t::NEC]);
+  // MagiQuest is after NEC, so it wasn't tried last time, but is a fallback
+  // entry.
+  EXPECT_EQ(1, profile.attempts[decode_type_t::MAGIQUEST]);
+  EXPECT_EQ(2, profile.latency[0]);
+
+  irrecv.resetProfile();
+  EXPECT_EQ(0, profile.captures);
+  EXPECT_EQ(0, profile.attempts[decode_type_t::NEC]);
+  EXPECT_EQ(0, profile.matches[decode_type_t::NEC]);
+  EXPECT_EQ(0, profile.latency[0]);
+}
+
+TEST(TestDecodeProfile, LatencyHistogram) {
+  IRrecv irrecv(1);
+  irrecv._profileCapture(0);
+  irrecv._profileCapture(1);
+  irrecv._profileCapture(2);
+  irrecv._profileCapture(3);
+  irrecv._profileCapture(1000);  // 512 <= 1000 < 1024
+  irrecv._profileCapture(UINT32_MAX);
+  const decode_profile_t &profile = irrecv.getProfile();
+  EXPECT_EQ(6, profile.captures);
+  EXPECT_EQ(2, profile.latency[0]);
+  EXPECT_EQ(2, profile.latency[1]);
+  EXPECT_EQ(1, profile.latency[9]);
+  EXPECT_EQ(1, profile.latency[kDecodeLatencyBuckets - 1]);
+  irrecv._profileAttempt(decode_type_t::SONY, true, 123);
+  irrecv._profileAttempt(decode_type_t::SONY, false, 7);
+  irrecv._profileAttempt(decode_type_t::UNKNOWN, true, 7);  // Ignored.
+  EXPECT_EQ(2, profile.attempts[decode_type_t::SONY]);
+  EXPECT_EQ(1, profile.matches[decode_type_t::SONY]);
+  EXPECT_EQ(130, profile.usecs[decode_type_t::SONY]);
+}
+#endif  // ENABLE_DECODE_PROFILING
+
 TEST(TestCrudeNoiseFilter, General) {
   IRsendTest irsend(0);
   IRrecv irrecv(1);
@@ -1590,6 +2383,131 @@ TEST(TestCrudeNoiseFilter, NoiseAtEndOfSample) {
       resultToSourceCode(&irsend.capture));
 }
 
+TEST(TestCrudeNoiseFilter, Modes) {
+  IRrecv irrecv(1);
+  decode_results results;
+  // Raw (kRawTick) values. i.e. A short pulse at the start, a 60us glitch in a
+  // space, & a 40us glitch in a mark.
+  const uint16_t raw[] = {0, 20, 500, 300, 30, 300, 300, 20, 300, 400, 600};
+  const uint16_t rawlen = sizeof(raw) / sizeof(raw[0]);
+  uint16_t buf[kRawBuf];
+  results.rawbuf = buf;
+
+  EXPECT_EQ(kNoiseFilterMerge, irrecv.getNoiseFilter());
+
+  // Nothing to do.
+  memcpy(buf, raw, sizeof(raw));
+  results.rawlen = rawlen;
+  EXPECT_EQ(0, irrecv.noiseFilter(&results, 0));
+  EXPECT_EQ(rawlen, results.rawlen);
+  EXPECT_EQ(0, irrecv.noiseFilter(&results, 20));
+  EXPECT_EQ(rawlen, results.rawlen);
+
+  // Merge.
+  memcpy(buf, raw, sizeof(raw));
+  buf[rawlen] = 0;
+  results.rawlen = rawlen;
+  EXPECT_EQ(3, irrecv.noiseFilter(&results, 100, kNoiseFilterMerge));
+  const uint16_t merged[] = {0, 630, 620, 400, 600, 0};
+  ASSERT_EQ(5, results.rawlen);
+  EXPECT_EQ(0, memcmp(merged, buf, sizeof(merged)));
+
+  // Drop.
+  memcpy(buf, raw, sizeof(raw));
+  buf[rawlen] = 0;
+  results.rawlen = rawlen;
+  EXPECT_EQ(3, irrecv.noiseFilter(&results, 100, kNoiseFilterDrop));
+  const uint16_t dropped[] = {0, 300, 300, 400, 600, 0};
+  ASSERT_EQ(5, results.rawlen);
+  EXPECT_EQ(0, memcmp(dropped, buf, sizeof(dropped)));
+
+  // Median.
+  memcpy(buf, raw, sizeof(raw));
+  results.rawlen = rawlen;
+  EXPECT_EQ(2, irrecv.noiseFilter(&results, 100, kNoiseFilterMedian));
+  const uint16_t smoothed[] = {0, 20, 500, 300, 300, 300, 300, 300, 300, 400,
+                               600};
+  ASSERT_EQ(rawlen, results.rawlen);
+  EXPECT_EQ(0, memcmp(smoothed, buf, sizeof(smoothed)));
+
+  // decode() uses the selected strategy.
+  IRsendTest irsend(0);
+  irsend.begin();
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+  irsend.capture.rawbuf[21] = 10;  // A 20us glitch in a mark breaks it.
+  irrecv.setNoiseFilter(kNoiseFilterMedian);
+  EXPECT_EQ(kNoiseFilterMedian, irrecv.getNoiseFilter());
+  ASSERT_TRUE(irrecv.decode(&irsend.capture, NULL, 0, 100));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x4BB640BF, irsend.capture.value);
+  EXPECT_EQ(69, irsend.capture.rawlen);
+}
+
+TEST(TestManchesterCode, Engine) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(0);
+  irsend.begin();
+
+  const manchester_timing_t timing = irrecv._manchesterTiming(500, 25, 100);
+  EXPECT_EQ(3, timing.maxwidth);
+  // Quantising pulses into half-periods. Marks get the excess added.
+  EXPECT_EQ(1, irrecv._halfPeriods(600 / kRawTick, kMark, &timing));
+  EXPECT_EQ(2, irrecv._halfPeriods(1100 / kRawTick, kMark, &timing));
+  EXPECT_EQ(3, irrecv._halfPeriods(1600 / kRawTick, kMark, &timing));
+  EXPECT_EQ(0, irrecv._halfPeriods(2400 / kRawTick, kMark, &timing));
+  EXPECT_EQ(0, irrecv._halfPeriods(200 / kRawTick, kMark, &timing));
+  // & removed from spaces.
+  EXPECT_EQ(1, irrecv._halfPeriods(400 / kRawTick, kSpace, &timing));
+  EXPECT_EQ(2, irrecv._halfPeriods(900 / kRawTick, kSpace, &timing));
+  EXPECT_TRUE(irrecv._matchHalfPeriods(900 / kRawTick, 2, kSpace, &timing));
+  EXPECT_FALSE(irrecv._matchHalfPeriods(900 / kRawTick, 1, kSpace, &timing));
+  EXPECT_FALSE(irrecv._matchHalfPeriods(900 / kRawTick, 4, kSpace, &timing));
+  // Never wider than we can store.
+  EXPECT_EQ(kManchesterMaxWidth,
+            irrecv._manchesterTiming(500, 25, 0, 0, 255).maxwidth);
+
+  // Bit values for each convention.
+  EXPECT_EQ(1, irrecv._manchesterBit(kMark, kSpace, true));
+  EXPECT_EQ(0, irrecv._manchesterBit(kSpace, kMark, true));
+  EXPECT_EQ(0, irrecv._manchesterBit(kMark, kSpace, false));
+  EXPECT_EQ(1, irrecv._manchesterBit(kSpace, kMark, false));
+  EXPECT_EQ(-1, irrecv._manchesterBit(kMark, kMark, true));
+  EXPECT_EQ(-1, irrecv._manchesterBit(-1, kSpace, false));
+
+  // Levels, one half-period at a time. Same as getRClevel().
+  irsend.reset();
+  irsend.mark(1000);
+  irsend.space(500);
+  irsend.mark(500);
+  irsend.space(5000);
+  irsend.mark(500);
+  irsend.makeDecodeResult();
+  uint16_t offset = kStartOffset;
+  uint16_t used = 0;
+  const manchester_timing_t rc = irrecv._manchesterTiming(500);
+  EXPECT_EQ(kMark, irrecv._manchesterLevel(&irsend.capture, &offset, &used,
+                                           &rc));
+  EXPECT_EQ(kMark, irrecv._manchesterLevel(&irsend.capture, &offset, &used,
+                                           &rc));
+  EXPECT_EQ(kSpace, irrecv._manchesterLevel(&irsend.capture, &offset, &used,
+                                            &rc));
+  EXPECT_EQ(kMark, irrecv._manchesterLevel(&irsend.capture, &offset, &used,
+                                           &rc));
+  EXPECT_EQ(4, offset);
+  // A space that is too long for the protocol is the end of the message.
+  EXPECT_EQ(kSpace, irrecv._manchesterLevel(&irsend.capture, &offset, &used,
+                                            &rc));
+  EXPECT_EQ(4, offset);
+  offset = kStartOffset;
+  used = 0;
+  EXPECT_EQ(kMark, irrecv.getRClevel(&irsend.capture, &offset, &used, 500));
+  EXPECT_EQ(kMark, irrecv.getRClevel(&irsend.capture, &offset, &used, 500));
+  EXPECT_EQ(kSpace, irrecv.getRClevel(&irsend.capture, &offset, &used, 500));
+  EXPECT_EQ(3, offset);
+}
+
 TEST(TestManchesterCode, matchManchester) {
   IRsendTest irsend(0);
   IRrecv irrecv(0);
@@ -1908,3 +2826,115 @@ TEST(TestMatchManchesterData, SimulateLongFooter) {
   EXPECT_EQ("f38000d50m1000s2000m1000s1000m2000s5000",
             irsend.outputStr());
 }
+
+#if DECODE_MEMO_SLOTS
+TEST(TestDecodeMemo, RepeatsAreRemembered) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  EXPECT_FALSE(irrecv.getDecodeMemo());
+  irrecv.setDecodeMemo(true);
+  EXPECT_TRUE(irrecv.getDecodeMemo());
+
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x4BB640BF, irsend.capture.value);
+  EXPECT_FALSE(irsend.capture.repeat);
+#if ENABLE_DECODE_PROFILING
+  const uint32_t attempts = irrecv.getProfile().attempts[NEC];
+#endif  // ENABLE_DECODE_PROFILING
+
+  // The same message again, with some jitter, is a repeat of it.
+  TimerMs::add(100);
+  irsend.reset();
+  irsend.sendNEC(0x4BB640BF);
+  irsend.makeDecodeResult();
+  for (uint16_t i = 1; i < irsend.capture.rawlen; i++)
+    irsend.capture.rawbuf[i] += (i % 3) ? 10 : -10;  // +/- 20us.
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x4BB640BF, irsend.capture.value);
+  EXPECT_EQ(kNECBits, irsend.capture.bits);
+  EXPECT_TRUE(irsend.capture.repeat);
+  EXPECT_EQ(irsend.rawbuf, irsend.capture.rawbuf);  // Still our capture.
+#if ENABLE_DECODE_PROFILING
+  EXPECT_EQ(attempts, irrecv.getProfile().attempts[NEC]);  // Not decoded.
+#endif  // ENABLE_DECODE_PROFILING
+
+  // A different message isn't.
+  irsend.reset();
+  irsend.sendNEC(0x4BB641BE);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x4BB641BE, irsend.capture.value);
+  EXPECT_FALSE(irsend.capture.repeat);
+
+  // Nor is the same pattern at a very different speed.
+  const protocol_timing_t timing = {
+      (decode_type_t)(kLastDecodeType + 1), 32,
+      4500, 2250, 280, 845, 280, 280, 280, 40000, 0,
+      38, 50, true, kNoRepeat, kUseDefTol};
+  irsend.reset();
+  irsend.sendGeneric(&timing, 0x4BB640BF, timing.bits, kNoRepeat);
+  irsend.makeDecodeResult();
+  irrecv.decode(&irsend.capture);
+  EXPECT_NE(NEC, irsend.capture.decode_type);
+  EXPECT_FALSE(irsend.capture.repeat);
+}
+
+TEST(TestDecodeMemo, Expiry) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  irrecv.setDecodeMemo(true);
+
+  irsend.reset();
+  irsend.sendSony(0x240, kSony12Bits);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(SONY, irsend.capture.decode_type);
+  EXPECT_FALSE(irsend.capture.repeat);
+
+  // Each repeat keeps it fresh.
+  for (uint8_t i = 0; i < 3; i++) {
+    TimerMs::add(kDecodeMemoTimeoutMs - 10);
+    irsend.reset();
+    irsend.sendSony(0x240, kSony12Bits);
+    irsend.makeDecodeResult();
+    ASSERT_TRUE(irrecv.decode(&irsend.capture));
+    EXPECT_EQ(SONY, irsend.capture.decode_type);
+    EXPECT_EQ(0x240, irsend.capture.value);
+    EXPECT_TRUE(irsend.capture.repeat);
+  }
+
+  // But not for ever.
+  TimerMs::add(kDecodeMemoTimeoutMs + 1);
+  irsend.reset();
+  irsend.sendSony(0x240, kSony12Bits);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(SONY, irsend.capture.decode_type);
+  EXPECT_FALSE(irsend.capture.repeat);
+
+  // Changing the settings forgets it.
+  irrecv.setTolerance(kTolerance);
+  irsend.reset();
+  irsend.sendSony(0x240, kSony12Bits);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_FALSE(irsend.capture.repeat);
+
+  // Turning it off.
+  irrecv.setDecodeMemo(false);
+  irsend.reset();
+  irsend.sendSony(0x240, kSony12Bits);
+  irsend.makeDecodeResult();
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(SONY, irsend.capture.decode_type);
+  EXPECT_FALSE(irsend.capture.repeat);
+}
+#endif  // DECODE_MEMO_SLOTS
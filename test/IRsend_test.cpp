@@ -863,3 +863,418 @@ TEST(TestSendManchester, SendOverLargeData) {
       "m300",
       irsend.outputStr());
 }
+
+// Render a message the way IRsendTest::outputStr() shows it.
+std::string renderStr(const render_buffer_t *output) {
+  std::stringstream result;
+  result << "f" << output->frequency << "d"
+         << static_cast<uint16_t>(output->dutycycle);
+  for (uint16_t i = 0; i < output->length; i++)
+    result << ((i & 1) ? "s" : "m")
+           << (output->buffer32 ? output->buffer32[i] : output->buffer16[i]);
+  return result.str();
+}
+
+// Just the marks & spaces of an IRsendTest::outputStr() style string.
+// i.e. Without any frequency or duty cycle changes, or a leading space.
+std::string pulsesStr(const std::string &str) {
+  std::string result;
+  bool skip = false;
+  for (size_t i = 0; i < str.size(); i++) {
+    if (str[i] == 'f' || str[i] == 'd') skip = true;
+    else if (str[i] == 'm' || str[i] == 's') skip = false;
+    if (!skip) result += str[i];
+  }
+  if (result.find("m0s") == 0)  // A leading space.
+    result.erase(0, result.find('m', 1));
+  return result;
+}
+
+TEST(TestRender, Simple) {
+  IRsend irsend(0);
+  uint16_t buffer[kNECBits * 2 + 8];
+  render_buffer_t output = {buffer, NULL, sizeof(buffer) / sizeof(buffer[0]),
+                            0, 0, 0, 0, false};
+  EXPECT_TRUE(irsend.render(&output, NEC, 0x4BB640BF, kNECBits));
+  EXPECT_EQ(
+      "f38000d33"
+      "m8960s4480m560s560m560s1680m560s560m560s560m560s1680m560s560"
+      "m560s1680m560s1680m560s1680m560s560m560s1680m560s1680m560s560"
+      "m560s1680m560s1680m560s560m560s560m560s1680m560s560m560s560"
+      "m560s560m560s560m560s560m560s560m560s1680m560s560m560s1680"
+      "m560s1680m560s1680m560s1680m560s1680m560s1680m560s39200",
+      renderStr(&output));
+  EXPECT_EQ(68, output.length);
+  EXPECT_EQ(108080, output.usecs);  // NEC has a fixed message length.
+  EXPECT_FALSE(output.overflow);
+
+  // Too small a buffer.
+  output.size = 10;
+  EXPECT_FALSE(irsend.render(&output, NEC, 0x4BB640BF, kNECBits));
+  EXPECT_TRUE(output.overflow);
+  EXPECT_EQ(10, output.length);
+  EXPECT_EQ("f38000d33m8960s4480m560s560m560s1680m560s560m560s560",
+            renderStr(&output));
+
+  // Unsupported protocol.
+  output.size = sizeof(buffer) / sizeof(buffer[0]);
+  EXPECT_FALSE(irsend.render(&output, UNKNOWN, (uint64_t)0, 0));
+  EXPECT_EQ(0, output.length);
+
+  // Anything can be rendered via beginRender() & endRender().
+  irsend.beginRender(&output);
+  irsend.sendSony(0x240, kSony12Bits, 0);
+  irsend.space(70000);  // Too long for a uint16_t buffer.
+  const uint16_t raw[3] = {1000, 500, 2000};
+  irsend.sendRaw(raw, 3, 40);
+  EXPECT_TRUE(irsend.endRender());
+  EXPECT_EQ(
+      "f40000d50"
+      "m2400s600m600s600m600s600m1200s600m600s600m600s600m1200s600"
+      "m600s600m600s600m600s600m600s600m600s600m600s65535m1000s500"
+      "m2000",
+      renderStr(&output));
+  // Nothing was rendering, so there is nothing to end.
+  EXPECT_FALSE(irsend.endRender());
+
+  // A NULL output stops rendering. i.e. Same as endRender().
+  irsend.beginRender(&output);
+  irsend.sendSony(0x240, kSony12Bits, 0);
+  irsend.beginRender(NULL);
+  EXPECT_FALSE(irsend.endRender());
+  EXPECT_EQ(
+      "f40000d33"
+      "m2400s600m600s600m600s600m1200s600m600s600m600s600m1200s600"
+      "m600s600m600s600m600s600m600s600m600s600m600s27000",
+      renderStr(&output));
+}
+
+// Rendering must give the same result as sending, for every protocol.
+TEST(TestRender, SameAsSending) {
+  IRsendTest irsend(0);
+  IRsend irrender(0);
+  uint32_t buffer[OUTPUT_BUF];
+  render_buffer_t output = {NULL, buffer, OUTPUT_BUF, 0, 0, 0, 0, false};
+  const uint64_t kData = 0x123456789ABCDEF0;  // Arbitrary.
+  uint8_t state[kStateSizeMax];
+  for (uint16_t i = 0; i < kStateSizeMax; i++) state[i] = kData >> (i % 8);
+  uint16_t rendered = 0;
+  for (int16_t i = 1; i <= kLastDecodeType; i++) {
+    const decode_type_t protocol = (decode_type_t)i;
+    const uint16_t nbits = IRsend::defaultBits(protocol);
+    irsend.reset();
+    bool sent;
+    if (hasACState(protocol)) {
+      sent = irsend.send(protocol, state, nbits / 8);
+      EXPECT_EQ(sent, irrender.render(&output, protocol, state, nbits / 8));
+    } else {
+      const uint64_t data = (nbits >= 64) ? kData
+                                          : kData & ((1ULL << nbits) - 1);
+      sent = irsend.send(protocol, data, nbits);
+      EXPECT_EQ(sent, irrender.render(&output, protocol, data, nbits));
+    }
+    if (!sent) continue;
+    rendered++;
+    EXPECT_EQ(pulsesStr(irsend.outputStr()), pulsesStr(renderStr(&output)))
+        << typeToString(protocol);
+  }
+  EXPECT_LT(50, rendered);
+}
+
+#if SEND_QUEUE_SLOTS
+// Record of the transmit queue's callbacks.
+std::string queue_log;
+
+void queueCallback(const uint32_t tag, const bool sent) {
+  queue_log += std::to_string(tag) + (sent ? "sent," : "unsent,");
+}
+
+TEST(TestSendQueue, NonBlocking) {
+  IRsendTest irsend(0);
+  irsend.begin();
+  queue_log = "";
+  EXPECT_FALSE(irsend.poll());  // Nothing to do.
+
+  EXPECT_TRUE(irsend.queue(NEC, 0x4BB640BF, kNECBits, 1, queueCallback, 1));
+  EXPECT_TRUE(irsend.queue(SONY, 0x240, kSony12Bits, 0, queueCallback, 2));
+  EXPECT_EQ(2, irsend.getQueueDepth());
+  EXPECT_EQ("", irsend.outputStr());  // Nothing is sent until we poll.
+
+  // The first NEC frame is sent, but not its gap.
+  EXPECT_TRUE(irsend.poll());
+  EXPECT_EQ(
+      "f38000d33"
+      "m8960s4480m560s560m560s1680m560s560m560s560m560s1680m560s560"
+      "m560s1680m560s1680m560s1680m560s560m560s1680m560s1680m560s560"
+      "m560s1680m560s1680m560s560m560s560m560s1680m560s560m560s560"
+      "m560s560m560s560m560s560m560s560m560s1680m560s560m560s1680"
+      "m560s1680m560s1680m560s1680m560s1680m560s1680m560",
+      irsend.outputStr());
+  // Nothing more happens until the gap is over.
+  IRtimer::add(39000);
+  EXPECT_TRUE(irsend.poll());
+  EXPECT_EQ("", irsend.outputStr());
+  IRtimer::add(200);
+  EXPECT_TRUE(irsend.poll());
+  EXPECT_EQ("f38000d33m8960s2240m560", irsend.outputStr());  // NEC repeat.
+  EXPECT_EQ("", queue_log);
+  EXPECT_EQ(2, irsend.getQueueDepth());
+
+  // The NEC message finishes, & the Sony one starts straight away.
+  IRtimer::add(kDefaultMessageGap);
+  EXPECT_TRUE(irsend.poll());
+  EXPECT_EQ("1sent,", queue_log);
+  EXPECT_EQ(1, irsend.getQueueDepth());
+  EXPECT_EQ(
+      "f40000d33"
+      "m2400s600m600s600m600s600m1200s600m600s600m600s600m1200s600"
+      "m600s600m600s600m600s600m600s600m600s600m600",
+      irsend.outputStr());
+  // Sony messages are always sent at least 3 times.
+  IRtimer::add(kDefaultMessageGap);
+  EXPECT_TRUE(irsend.poll());
+  IRtimer::add(kDefaultMessageGap);
+  EXPECT_TRUE(irsend.poll());
+  EXPECT_EQ("1sent,", queue_log);
+  irsend.reset();
+  IRtimer::add(kDefaultMessageGap);
+  EXPECT_FALSE(irsend.poll());
+  EXPECT_EQ("1sent,2sent,", queue_log);
+  EXPECT_EQ(0, irsend.getQueueDepth());
+  EXPECT_EQ("", irsend.outputStr());
+}
+
+TEST(TestSendQueue, Limits) {
+  IRsendTest irsend(0);
+  IRsend irrender(0);
+  irsend.begin();
+  queue_log = "";
+
+  // Unsupported protocols aren't queued.
+  EXPECT_FALSE(irsend.queue(UNKNOWN, (uint64_t)0, 0, 0, queueCallback, 0));
+  EXPECT_EQ(0, irsend.getQueueDepth());
+
+  // Already rendered messages can be queued.
+  uint16_t buffer[100];
+  render_buffer_t message = {buffer, NULL, 100, 0, 0, 0, 0, false};
+  ASSERT_TRUE(irrender.render(&message, SONY, 0x240, kSony12Bits));
+  for (uint8_t i = 1; i <= SEND_QUEUE_SLOTS; i++)
+    EXPECT_TRUE(irsend.queue(&message, queueCallback, i));
+  EXPECT_EQ(SEND_QUEUE_SLOTS, irsend.getQueueDepth());
+  // But only as many as there are slots.
+  EXPECT_FALSE(irsend.queue(&message, queueCallback, 99));
+  EXPECT_FALSE(irsend.queue(SONY, 0x240, kSony12Bits));
+  EXPECT_EQ(SEND_QUEUE_SLOTS, irsend.getQueueDepth());
+
+  // Start sending, then throw the rest away.
+  EXPECT_TRUE(irsend.poll());
+  EXPECT_NE("", irsend.outputStr());
+  irsend.clearQueue();
+  EXPECT_EQ(0, irsend.getQueueDepth());
+  EXPECT_EQ("1unsent,2unsent,3unsent,4unsent,", queue_log);
+  EXPECT_FALSE(irsend.poll());
+  EXPECT_EQ("", irsend.outputStr());
+
+  // Now there is room again.
+  queue_log = "";
+  EXPECT_TRUE(irsend.queue(&message, queueCallback, 5));
+  while (irsend.poll()) IRtimer::add(1000);
+  EXPECT_EQ("5sent,", queue_log);
+}
+
+// Queueing a message while another is part way through being sent must not
+// change the modulation of the rest of the one being sent.
+TEST(TestSendQueue, ModulationAfterQueueing) {
+  IRsendTest irsend(0);
+  irsend.begin();
+  queue_log = "";
+
+  EXPECT_TRUE(irsend.queue(NEC, 0x4BB640BF, kNECBits, 1, queueCallback, 1));
+  EXPECT_TRUE(irsend.poll());  // The first frame, then wait for its gap.
+  // Render a Sony (40kHz) message during the gap.
+  EXPECT_TRUE(irsend.queue(SONY, 0x240, kSony12Bits, 0, queueCallback, 2));
+  irsend.reset();
+  IRtimer::add(kDefaultMessageGap + 39200);
+  EXPECT_TRUE(irsend.poll());
+  // The NEC repeat is still sent at 38kHz.
+  EXPECT_EQ("f38000d33m8960s2240m560", irsend.outputStr());
+}
+#endif  // SEND_QUEUE_SLOTS
+
+#if SEND_MULTI_PINS
+// Records which of the setPins() GPIOs each mark is sent on.
+class IRsendMultiTest : public IRsend {
+ public:
+  std::string log;
+
+  explicit IRsendMultiTest(uint16_t x) : IRsend(x) {}
+
+  uint16_t mark(uint16_t usec) {
+    log += "m" + std::to_string(usec) + "[" + std::to_string(_active) + "]";
+    return 0;
+  }
+
+  void space(uint32_t time) { log += "s" + std::to_string(time); }
+
+  uint64_t gpioAll(void) { return _gpio_all; }
+  uint64_t gpioActive(void) { return _gpio_active; }
+  void setActive(const uint16_t active) { _setActive(active); }
+};
+
+TEST(TestSendMultiPins, SameMessage) {
+  IRsendMultiTest irsend(0);
+  const uint16_t pins[SEND_MULTI_PINS + 1] = {4, 5, 12, 13, 14};
+  EXPECT_EQ(0, irsend.getPinCount());
+  EXPECT_FALSE(irsend.setPins(pins, SEND_MULTI_PINS + 1));  // Too many.
+  EXPECT_EQ(0, irsend.getPinCount());
+  const uint16_t bad_pins[2] = {4, kSendMultiMaxGpio + 1};
+  EXPECT_FALSE(irsend.setPins(bad_pins, 2));  // Not in the GPIO registers.
+  EXPECT_EQ(0, irsend.getPinCount());
+  EXPECT_TRUE(irsend.setPins(pins, 3));
+  EXPECT_EQ(3, irsend.getPinCount());
+  // The GPIO register masks are worked out in advance.
+  EXPECT_EQ((1ULL << 4) | (1ULL << 5) | (1ULL << 12), irsend.gpioAll());
+  EXPECT_EQ(irsend.gpioAll(), irsend.gpioActive());
+  irsend.setActive(0b101);
+  EXPECT_EQ((1ULL << 4) | (1ULL << 12), irsend.gpioActive());
+  irsend.setActive(0b111);
+  irsend.sendSony(0x240, kSony12Bits, 0);
+  EXPECT_EQ(
+      "m2400[7]s600m600[7]s600m600[7]s600m1200[7]s600m600[7]s600m600[7]s600"
+      "m1200[7]s600m600[7]s600m600[7]s600m600[7]s600m600[7]s600m600[7]s600"
+      "m600[7]s600s45000",
+      irsend.log);
+  // Back to a single GPIO.
+  EXPECT_TRUE(irsend.setPins(NULL, 0));
+  EXPECT_EQ(0, irsend.getPinCount());
+}
+
+TEST(TestSendMultiPins, Merged) {
+  IRsendMultiTest irsend(0);
+  const uint16_t pins[3] = {4, 5, 12};
+  const render_buffer_t *streams[3];
+  uint16_t a[4] = {100, 200, 300, 400};
+  uint32_t b[3] = {150, 50, 500};
+  uint16_t c[2] = {1000, 5000};
+  render_buffer_t stream_a = {a, NULL, 4, 4, 1000, 38000, 50, false};
+  render_buffer_t stream_b = {NULL, b, 3, 3, 700, 38000, 50, false};
+  render_buffer_t stream_c = {c, NULL, 2, 2, 6000, 38000, 50, false};
+  streams[0] = &stream_a;
+  streams[1] = &stream_b;
+  streams[2] = &stream_c;
+  EXPECT_FALSE(irsend.sendMerged(streams, 2));  // No pins set.
+  ASSERT_TRUE(irsend.setPins(pins, 2));
+  EXPECT_FALSE(irsend.sendMerged(streams, 3));  // More streams than pins.
+  EXPECT_EQ("", irsend.log);
+
+  //      0    100  150  200  300  600  700  1000
+  //  a:  m100 s200           m300 s400
+  //  b:  m150      s50  m500
+  EXPECT_TRUE(irsend.sendMerged(streams, 2));
+  EXPECT_EQ("m100[3]m50[2]s50m100[2]m300[3]m100[2]s300", irsend.log);
+  irsend.log = "";
+
+  //  c:  m1000 s5000
+  ASSERT_TRUE(irsend.setPins(pins, 3));
+  EXPECT_TRUE(irsend.sendMerged(streams, 3));
+  EXPECT_EQ("m100[7]m50[6]m50[4]m100[6]m300[7]m100[6]m300[4]s5000",
+            irsend.log);
+}
+#endif  // SEND_MULTI_PINS
+
+TEST(TestSendSequence, RenderAndSend) {
+  IRsendTest irsend(0);
+  IRsendSequence sequence(&irsend);
+  const uint8_t state[kSequenceStateSize + 1] = {0};
+  irsend.begin();
+  EXPECT_EQ(0, sequence.length());
+  EXPECT_TRUE(sequence.add(NEC, 0x4BB640BF, kNECBits, kNoRepeat, 500000));
+  EXPECT_TRUE(sequence.add(SONY, 0x240, kSony12Bits, 0));
+  EXPECT_FALSE(sequence.add(KELVINATOR, state, kSequenceStateSize + 1));
+  EXPECT_EQ(2, sequence.length());
+  EXPECT_EQ(NULL, sequence.getEntry(2));
+  EXPECT_FALSE(sequence.set(2, NEC, 0x4BB640BF, kNECBits));
+
+  const render_buffer_t *rendered = sequence.render();
+  ASSERT_NE(nullptr, rendered);
+  const sequence_entry_t *nec = sequence.getEntry(0);
+  const sequence_entry_t *sony = sequence.getEntry(1);
+  EXPECT_EQ(0, nec->start);
+  EXPECT_EQ(68, nec->length);
+  EXPECT_EQ(38000, nec->frequency);
+  // NEC's own gap is replaced by the longer one asked for.
+  EXPECT_EQ(500000, rendered->buffer32[nec->length - 1]);
+  EXPECT_EQ(68, sony->start);
+  EXPECT_EQ(rendered->length - 68, sony->length);
+  EXPECT_EQ(40000, sony->frequency);
+  // Sony's own gap is kept, as it is longer than none. send() uses its
+  // minimum nr. of repeats.
+  EXPECT_EQ(108080 - 39200 + 500000 + 45000 * 3, rendered->usecs);
+
+  // Sending it is the same as sending each message, with the gap in between.
+  IRsendTest expected(0);
+  expected.begin();
+  expected.sendNEC(0x4BB640BF);
+  expected.space(500000 - 39200);
+  expected.send(SONY, 0x240, kSony12Bits, 0);
+  EXPECT_TRUE(sequence.send());
+  EXPECT_EQ(pulsesStr(expected.outputStr()), pulsesStr(irsend.outputStr()));
+
+  // Unsupported messages fail the whole sequence.
+  EXPECT_TRUE(sequence.add(UNKNOWN, (uint64_t)0, 0));
+  EXPECT_EQ(nullptr, sequence.render());
+  EXPECT_FALSE(sequence.send());
+  sequence.clear();
+  EXPECT_EQ(0, sequence.length());
+  ASSERT_NE(nullptr, sequence.render());
+  EXPECT_EQ(0, sequence.render()->length);
+}
+
+TEST(TestSendSequence, OnlyRerenderWhenChanged) {
+  IRsend irsend(0);
+  IRsendSequence sequence(&irsend);
+  uint8_t state[kKelvinatorStateLength] = {
+      0x19, 0x0B, 0x80, 0x50, 0x00, 0x00, 0x00, 0xE0,
+      0x19, 0x0B, 0x80, 0x70, 0x00, 0x00, 0x10, 0xF0};
+  EXPECT_TRUE(sequence.add(KELVINATOR, state, kKelvinatorStateLength));
+  EXPECT_TRUE(sequence.add(NEC, 0x4BB640BF, kNECBits));
+  ASSERT_NE(nullptr, sequence.render());
+  EXPECT_FALSE(sequence._dirty);
+  // Mark the rendered result, so we can tell if it is rendered again.
+  sequence._rendered.buffer32[0] = 1;
+
+  // No changes.
+  EXPECT_TRUE(sequence.set(0, KELVINATOR, state, kKelvinatorStateLength));
+  EXPECT_TRUE(sequence.set(1, NEC, 0x4BB640BF, kNECBits));
+  EXPECT_FALSE(sequence._dirty);
+  EXPECT_EQ(1, sequence.render()->buffer32[0]);
+
+  // A change to a state[] after it was added isn't one to the sequence.
+  state[1] = 0xFF;
+  EXPECT_EQ(1, sequence.render()->buffer32[0]);
+  // Until it is set.
+  EXPECT_TRUE(sequence.set(0, KELVINATOR, state, kKelvinatorStateLength));
+  EXPECT_TRUE(sequence._dirty);
+  EXPECT_NE(1, sequence.render()->buffer32[0]);
+  EXPECT_FALSE(sequence._dirty);
+
+  sequence._rendered.buffer32[0] = 1;
+  EXPECT_TRUE(sequence.set(1, NEC, 0x4BB640BF, kNECBits, kNoRepeat, 200000));
+  EXPECT_NE(1, sequence.render()->buffer32[0]);
+  EXPECT_EQ(200000,
+            sequence.render()->buffer32[sequence.render()->length - 1]);
+}
+
+TEST(TestSendSequence, NoBuffer) {
+  IRsendTest irsend(0);
+  IRsendSequence sequence(&irsend);
+  irsend.begin();
+  // Pretend the buffer couldn't be allocated.
+  delete[] sequence._rendered.buffer32;
+  sequence._rendered.buffer32 = NULL;
+  sequence._rendered.size = 0;
+  EXPECT_TRUE(sequence.add(NEC, 0x4BB640BF, kNECBits));
+  EXPECT_EQ(nullptr, sequence.render());
+  EXPECT_FALSE(sequence.send());
+  EXPECT_EQ("", irsend.outputStr());
+}
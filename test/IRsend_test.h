@@ -17,7 +17,7 @@
 
 #ifdef UNIT_TEST
 // Used to help simulate elapsed time in unit tests.
-extern uint32_t _IRtimer_unittest_now;
+extern thread_local uint32_t _IRtimer_unittest_now;
 #endif  // UNIT_TEST
 
 class IRsendTest : public IRsend {
@@ -102,6 +102,7 @@ class IRsendTest : public IRsend {
   void addGap(uint32_t usecs) { space(usecs); }
 
   uint16_t mark(uint16_t usec) {
+    if (_render != NULL) return IRsend::mark(usec);  // Not sending.
     IRtimer::add(usec);
     if (last >= OUTPUT_BUF) return 0;
     if (last & 1)  // Is odd? (i.e. last call was a space())
@@ -114,6 +115,7 @@ class IRsendTest : public IRsend {
   }
 
   void space(uint32_t time) {
+    if (_render != NULL) return IRsend::space(time);  // Not sending.
     IRtimer::add(time);
     if (last >= OUTPUT_BUF) return;
     if (last & 1) {  // Is odd? (i.e. last call was a space())
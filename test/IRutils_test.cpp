@@ -777,6 +777,68 @@ TEST(TestUtils, InvertedBytePairs) {
   EXPECT_STATE_EQ(correct, wrong, 6 * 8);
 }
 
+TEST(TestUtils, CompactRaw) {
+  const uint16_t raw[] = {1, 2, 280, 281, 282, 1017, 1018, 4500, 65535};
+  const uint16_t expected[] = {0, 4, 280, 280, 284, 1016, 1018, 4500, 65535};
+  const uint16_t rawlen = sizeof(raw) / sizeof(raw[0]);
+  uint8_t compact[64];
+  uint16_t result[rawlen + 1];
+
+  // Most entries only take a byte, large ones take 3.
+  const uint16_t size = irutils::compactRaw(raw, rawlen, compact, 64);
+  EXPECT_EQ(6 + 3 * 3, size);
+  EXPECT_EQ(kCompactEscape, compact[6]);
+  EXPECT_EQ(rawlen, irutils::expandRaw(compact, size, result, rawlen + 1));
+  EXPECT_EQ(0, memcmp(expected, result, sizeof(expected)));
+
+  // Doesn't fit.
+  EXPECT_EQ(0, irutils::compactRaw(raw, rawlen, compact, size - 1));
+  EXPECT_EQ(6, irutils::compactRaw(raw, 6, compact, 6));
+  // Limits on expanding.
+  EXPECT_EQ(3, irutils::expandRaw(compact, size, result, 3));
+  EXPECT_EQ(6, irutils::expandRaw(compact, 8, result, rawlen));
+  EXPECT_EQ(0, irutils::expandRaw(compact, 0, result, rawlen));
+}
+
+// Compacting a real capture must not change what it decodes as.
+TEST(TestUtils, CompactRawDecodes) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1, 1024);
+  irsend.begin();
+  uint8_t compact[1024];
+
+  irsend.reset();
+  irsend.sendNEC(0x807F40BF);
+  irsend.makeDecodeResult();
+  uint16_t size = irutils::compactRaw(irsend.capture.rawbuf,
+                                      irsend.capture.rawlen, compact, 1024);
+  ASSERT_NE(0, size);
+  EXPECT_GT(irsend.capture.rawlen + 10, size);
+  EXPECT_EQ(irsend.capture.rawlen,
+            irutils::expandRaw(compact, size, irsend.capture.rawbuf,
+                               irsend.capture.rawlen));
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(NEC, irsend.capture.decode_type);
+  EXPECT_EQ(0x807F40BF, irsend.capture.value);
+
+  const uint8_t state[kDaikinStateLength] = {
+      0x11, 0xDA, 0x27, 0x00, 0xC5, 0x00, 0x00, 0xD7, 0x11, 0xDA, 0x27, 0x00,
+      0x42, 0xE3, 0x0B, 0x42, 0x11, 0xDA, 0x27, 0x00, 0x00, 0x68, 0x32, 0x00,
+      0x30, 0x00, 0x00, 0x06, 0x60, 0x00, 0x00, 0xC1, 0x00, 0x00, 0x03};
+  irsend.reset();
+  irsend.sendDaikin(state);
+  irsend.makeDecodeResult();
+  const uint16_t rawlen = irsend.capture.rawlen;
+  size = irutils::compactRaw(irsend.capture.rawbuf, rawlen, compact, 1024);
+  ASSERT_NE(0, size);
+  EXPECT_GT(rawlen + 30, size);  // vs. 2 bytes per entry.
+  EXPECT_EQ(rawlen, irutils::expandRaw(compact, size, irsend.capture.rawbuf,
+                                       rawlen));
+  ASSERT_TRUE(irrecv.decode(&irsend.capture));
+  EXPECT_EQ(DAIKIN, irsend.capture.decode_type);
+  EXPECT_STATE_EQ(state, irsend.capture.state, kDaikinBits);
+}
+
 TEST(TestUtils, lowLevelSanityCheck) {
   ASSERT_EQ(0, irutils::lowLevelSanityCheck());
 }
@@ -0,0 +1,385 @@
+// Multi-threaded tool to (re)decode a large corpus of captured IR messages.
+// Copyright 2020 David Conran
+//
+// Reads captures in Raw, GlobalCache (GC), ProntoHex or LIRC mode2 format from
+// a file (or stdin), decodes them on a pool of worker threads, and writes one
+// JSON object per capture to stdout, in input order.
+// e.g.
+//   {"line":1,"protocol":"NEC","bits":32,"repeat":false,"value":"0x20DF10EF",
+//    "address":"0x4","command":"0x8","rawlen":68,"decode_ns":5120}
+//   {"line":2,"protocol":"DAIKIN","bits":280,"repeat":false,
+//    "state":"0x11DA2700...","rawlen":584,"decode_ns":31877}
+// A summary of the run (throughput & per-protocol counts) goes to stderr.
+//
+// Input formats:
+//   -raw:       One capture per line. Comma separated mark/space uSeconds.
+//   -gc:        One capture per line. A GlobalCache code. (Default)
+//   -prontohex: One capture per line. Space separated Pronto hex words.
+//   -mode2:     LIRC `mode2` output. i.e. "pulse N" & "space N" lines.
+//               Captures are split at spaces longer than kMode2Gap uSeconds.
+// Blank lines, and lines starting with '#', are ignored in all formats.
+//
+// Usage example:
+//   ./batch_decode -raw -threads 8 captures.txt > decoded.jsonl
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+#include "IRrecv.h"
+#include "IRsend.h"
+#include "IRsend_test.h"
+#include "IRutils.h"
+
+const uint16_t kMaxGcCodeLength = 10000;
+const uint32_t kMode2Gap = 20000;  // uSeconds.
+const uint16_t kRawFreq = 38;  // kHz.
+const size_t kJobsPerThread = 64;  // Nr. of queued captures per worker.
+
+/// A capture waiting to be decoded.
+typedef struct {
+  uint64_t index;  // Nr. of captures before this one.
+  uint64_t line;  // Line number in the input where the capture starts.
+  std::string text;  // The capture, as read from the input.
+} batch_job_t;
+
+/// State shared between the reader, the workers, & the writer.
+typedef struct {
+  std::mutex lock;
+  std::condition_variable not_empty;
+  std::condition_variable not_full;
+  std::deque<batch_job_t> jobs;
+  size_t max_jobs;
+  bool finished;  // No more jobs will be added.
+  // Output lines waiting for their turn to be written. Keyed by job index.
+  std::map<uint64_t, std::string> pending;
+  uint64_t next_output;
+  // Totals.
+  std::map<std::string, uint64_t> protocols;
+  uint64_t captures;
+  uint64_t errors;
+  uint64_t decode_ns;
+} batch_state_t;
+
+/// The supported input formats.
+enum batch_format_t { kFormatGc, kFormatRaw, kFormatPronto, kFormatMode2 };
+
+/// The options to decode with.
+typedef struct {
+  batch_format_t input_type;
+  uint16_t repeats;
+} batch_options_t;
+
+bool str_to_uint16(const char *str, uint16_t *res, uint8_t base) {
+  char *end;
+  errno = 0;
+  intmax_t val = strtoimax(str, &end, base);
+  if (errno == ERANGE || val < 0 || val > UINT16_MAX || end == str ||
+      *end != '\0')
+    return false;
+  *res = (uint16_t)val;
+  return true;
+}
+
+void usage_error(char *name) {
+  std::cerr << "Usage: " << name
+            << " [-gc|-raw|-prontohex|-mode2] [-repeats num] [-threads num]"
+               " [file]" << std::endl;
+}
+
+uint64_t nowNs(void) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Simulate sending a capture so we have something to decode.
+/// @param[in,out] irsend The IRsendTest object to "send" it with.
+/// @param[in] options How to interpret the capture.
+/// @param[in] text The capture, in the format given by `options`.
+/// @return true, if it could be parsed, otherwise false.
+bool sendCapture(IRsendTest *irsend, const batch_options_t &options,
+                 const std::string &text) {
+  irsend->reset();
+  if (options.input_type == kFormatMode2) {  // mode2
+    std::istringstream lines(text);
+    std::string line, type;
+    uint32_t duration;
+    while (getline(lines, line)) {
+      std::istringstream iss(line);
+      if (!(iss >> type >> duration)) return false;
+      // Clamp duration to uint16_t
+      if (duration > 0xFFFF) duration = 0xFFFF;
+      if (type == "pulse")
+        irsend->mark(duration);
+      else if (type == "space")
+        irsend->space(duration);
+      else
+        return false;
+    }
+    return true;
+  }
+  std::vector<uint16_t> code;
+  const char *sep = (options.input_type == kFormatPronto) ? " \t" : ", \t";
+  const uint8_t base = (options.input_type == kFormatPronto) ? 16 : 10;
+  std::vector<char> buf(text.begin(), text.end());
+  buf.push_back('\0');
+  char *saveptr;
+  for (char *pch = strtok_r(buf.data(), sep, &saveptr);
+       pch != NULL && code.size() < kMaxGcCodeLength;
+       pch = strtok_r(NULL, sep, &saveptr)) {
+    uint16_t value;
+    if (!str_to_uint16(pch, &value, base)) return false;
+    code.push_back(value);
+  }
+  if (code.empty()) return false;
+  switch (options.input_type) {
+    case kFormatGc:
+      irsend->sendGC(code.data(), code.size());
+      break;
+    case kFormatPronto:
+      irsend->sendPronto(code.data(), code.size(), options.repeats);
+      break;
+    case kFormatRaw:
+      irsend->sendRaw(code.data(), code.size(), kRawFreq);
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+/// Describe the result of a decode as a JSON object.
+std::string resultToJson(const batch_job_t &job, const decode_results &result,
+                         const uint64_t decode_ns) {
+  std::ostringstream json;
+  json << "{\"line\":" << job.line << ",\"protocol\":\""
+       << typeToString(result.decode_type) << "\",\"bits\":" << result.bits
+       << ",\"repeat\":" << (result.repeat ? "true" : "false");
+  if (hasACState(result.decode_type)) {
+    json << ",\"state\":\"" << resultToHexidecimal(&result) << "\"";
+  } else {
+    json << ",\"value\":\"" << resultToHexidecimal(&result)
+         << "\",\"address\":\"0x" << uint64ToString(result.address, 16)
+         << "\",\"command\":\"0x" << uint64ToString(result.command, 16) << "\"";
+  }
+  json << ",\"rawlen\":" << result.rawlen << ",\"decode_ns\":" << decode_ns
+       << "}";
+  return json.str();
+}
+
+/// Write out any results that are next in line. Must hold `state->lock`.
+void flushOutput(batch_state_t *state) {
+  std::map<uint64_t, std::string>::iterator it = state->pending.begin();
+  while (it != state->pending.end() && it->first == state->next_output) {
+    std::cout << it->second << '\n';
+    state->next_output++;
+    it = state->pending.erase(it);
+  }
+}
+
+/// A worker thread. Decodes captures until there are no more.
+/// @note The worker makes its own IRrecv. `decode()` keeps per-object state
+///   (e.g. scores, memos & profiling), & in host builds the capture buffer
+///   (`irparams`) is per-thread, so it must be made on the thread using it.
+void worker(batch_state_t *state, const batch_options_t *options) {
+  IRrecv irrecv(0);
+  IRsendTest irsend(0);
+  irsend.begin();
+  std::map<std::string, uint64_t> protocols;
+  uint64_t captures = 0;
+  uint64_t errors = 0;
+  uint64_t total_ns = 0;
+  while (true) {
+    batch_job_t job;
+    {
+      std::unique_lock<std::mutex> lock(state->lock);
+      while (state->jobs.empty() && !state->finished)
+        state->not_empty.wait(lock);
+      if (state->jobs.empty()) break;  // Finished, & nothing left to do.
+      job = state->jobs.front();
+      state->jobs.pop_front();
+    }
+    state->not_full.notify_one();
+
+    std::string output;
+    if (sendCapture(&irsend, *options, job.text)) {
+      irsend.makeDecodeResult();
+      const uint64_t start = nowNs();
+      irrecv.decode(&irsend.capture);
+      const uint64_t elapsed = nowNs() - start;
+      total_ns += elapsed;
+      captures++;
+      protocols[typeToString(irsend.capture.decode_type)]++;
+      output = resultToJson(job, irsend.capture, elapsed);
+    } else {
+      errors++;
+      output = "{\"line\":" + uint64ToString(job.line) +
+          ",\"error\":\"Unable to parse the capture.\"}";
+    }
+
+    std::lock_guard<std::mutex> lock(state->lock);
+    state->pending[job.index] = output;
+    flushOutput(state);
+  }
+
+  // Add our totals to the overall ones.
+  std::lock_guard<std::mutex> lock(state->lock);
+  for (std::map<std::string, uint64_t>::iterator it = protocols.begin();
+       it != protocols.end(); it++)
+    state->protocols[it->first] += it->second;
+  state->captures += captures;
+  state->errors += errors;
+  state->decode_ns += total_ns;
+}
+
+/// Queue a capture for decoding, waiting for room if needed.
+void addJob(batch_state_t *state, const uint64_t line,
+            const std::string &text) {
+  static uint64_t index = 0;
+  batch_job_t job;
+  job.index = index++;
+  job.line = line;
+  job.text = text;
+  {
+    std::unique_lock<std::mutex> lock(state->lock);
+    while (state->jobs.size() >= state->max_jobs) state->not_full.wait(lock);
+    state->jobs.push_back(job);
+  }
+  state->not_empty.notify_one();
+}
+
+/// Split the input into captures, & queue them for the workers.
+void readCaptures(std::istream *input, batch_state_t *state,
+                  const batch_options_t &options) {
+  std::string line;
+  uint64_t line_nr = 0;
+  if (options.input_type != kFormatMode2) {
+    while (getline(*input, line)) {
+      line_nr++;
+      if (line.empty() || line[0] == '#' ||
+          line.find_first_not_of(" \t\r") == std::string::npos) continue;
+      addJob(state, line_nr, line);
+    }
+    return;
+  }
+  // mode2
+  std::string capture;
+  uint64_t start = 0;
+  uint16_t entries = 0;
+  while (getline(*input, line)) {
+    line_nr++;
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream iss(line);
+    std::string type;
+    uint32_t duration = 0;
+    iss >> type >> duration;
+    // Skip long spaces at beginning
+    if (entries == 0 && duration > kMode2Gap) continue;
+    if (entries == 0) start = line_nr;
+    capture += line + '\n';
+    entries++;
+    if (duration > kMode2Gap || entries >= kMaxGcCodeLength) {
+      addJob(state, start, capture);
+      capture.clear();
+      entries = 0;
+    }
+  }
+  if (entries) addJob(state, start, capture);
+}
+
+int main(int argc, char *argv[]) {
+  batch_options_t options;
+  options.input_type = kFormatGc;
+  options.repeats = 0;
+  uint16_t threads = std::thread::hardware_concurrency();
+  char *filename = NULL;
+
+  // Check the invocation/calling usage.
+  for (int i = 1; i < argc; i++) {
+    if (strcmp("-gc", argv[i]) == 0) {
+      options.input_type = kFormatGc;
+    } else if (strcmp("-raw", argv[i]) == 0) {
+      options.input_type = kFormatRaw;
+    } else if (strcmp("-prontohex", argv[i]) == 0) {
+      options.input_type = kFormatPronto;
+    } else if (strcmp("-mode2", argv[i]) == 0) {
+      options.input_type = kFormatMode2;
+    } else if (strcmp("-repeats", argv[i]) == 0 && i + 1 < argc) {
+      if (!str_to_uint16(argv[++i], &options.repeats, 10)) {
+        usage_error(argv[0]);
+        return 1;
+      }
+    } else if (strcmp("-threads", argv[i]) == 0 && i + 1 < argc) {
+      if (!str_to_uint16(argv[++i], &threads, 10) || threads == 0) {
+        usage_error(argv[0]);
+        return 1;
+      }
+    } else if (argv[i][0] != '-' && filename == NULL) {
+      filename = argv[i];
+    } else {
+      usage_error(argv[0]);
+      return 1;
+    }
+  }
+  if (threads == 0) threads = 1;  // hardware_concurrency() may not know.
+
+  std::ifstream file;
+  if (filename != NULL) {
+    file.open(filename);
+    if (!file) {
+      std::cerr << "Unable to open " << filename << std::endl;
+      return 1;
+    }
+  }
+  std::istream *input = (filename != NULL) ? &file : &std::cin;
+
+  batch_state_t state;
+  state.max_jobs = threads * kJobsPerThread;
+  state.finished = false;
+  state.next_output = 0;
+  state.captures = 0;
+  state.errors = 0;
+  state.decode_ns = 0;
+
+  const uint64_t start = nowNs();
+  std::vector<std::thread> workers;
+  for (uint16_t i = 0; i < threads; i++)
+    workers.push_back(std::thread(worker, &state, &options));
+  readCaptures(input, &state, options);
+  {
+    std::lock_guard<std::mutex> lock(state.lock);
+    state.finished = true;
+  }
+  state.not_empty.notify_all();
+  for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+  std::cout.flush();
+  const double elapsed = (nowNs() - start) / 1e9;
+
+  // Summary.
+  std::cerr << "Threads:          " << threads << std::endl
+            << "Captures:         " << state.captures << std::endl
+            << "Parse errors:     " << state.errors << std::endl
+            << "Elapsed:          " << elapsed << " s" << std::endl
+            << "Throughput:       "
+            << (elapsed > 0 ? state.captures / elapsed : 0)
+            << " captures/s" << std::endl
+            << "Avg. decode time: "
+            << (state.captures ? state.decode_ns / state.captures : 0)
+            << " ns" << std::endl
+            << "Protocols:" << std::endl;
+  for (std::map<std::string, uint64_t>::iterator it = state.protocols.begin();
+       it != state.protocols.end(); it++)
+    std::cerr << "  " << it->first << ": " << it->second << std::endl;
+  return 0;
+}